@@ -155,11 +155,15 @@ int Benchmark<T>::init()
     switch (fec_type) {
     case EC_TYPE_RS_GF2N_V:
         fec = new quadiron::fec::RsGf2n<T>(
-            word_size, k, m, quadiron::fec::RsMatrixType::VANDERMONDE);
+            word_size,
+            k,
+            m,
+            quadiron::fec::RsMatrixType::VANDERMONDE,
+            pkt_size);
         break;
     case EC_TYPE_RS_GF2N_C:
         fec = new quadiron::fec::RsGf2n<T>(
-            word_size, k, m, quadiron::fec::RsMatrixType::CAUCHY);
+            word_size, k, m, quadiron::fec::RsMatrixType::CAUCHY, pkt_size);
         break;
     case EC_TYPE_RS_GF2N_FFT:
         fec = new quadiron::fec::RsGf2nFft<T>(word_size, k, m);
@@ -795,9 +799,11 @@ int main(int argc, char** argv)
         }
     }
 
-    // Currently support operating on packet:RS_FNT
+    // Currently support operating on packet: RS_FNT, RS_NF4 and RS_GF2N
     if (params->fec_type != EC_TYPE_RS_FNT
         && params->fec_type != EC_TYPE_RS_FNT_SYS
+        && params->fec_type != EC_TYPE_RS_GF2N_V
+        && params->fec_type != EC_TYPE_RS_GF2N_C
         && params->fec_type != EC_TYPE_RS_NF4) {
         params->operation_on_packet = false;
     }
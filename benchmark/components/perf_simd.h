@@ -55,6 +55,9 @@ constexpr size_t ITERATIONS_NB = 10'000;
 template <typename T>
 class PerfSimd : public PerfBase<T> {
   public:
+    // number of elements in a register
+    static constexpr size_t vec_size = sizeof(simd::VecType) / sizeof(T);
+
     size_t n;
     size_t size;
     std::unique_ptr<vec::Buffers<T>> workload = nullptr;
@@ -72,7 +75,7 @@ class PerfSimd : public PerfBase<T> {
         }
 
         n = 2;
-        size = simd::countof<T>() * MAX_BUF_LEN;
+        size = vec_size * MAX_BUF_LEN;
         workload = std::make_unique<vec::Buffers<T>>(n, size);
         this->randomize_data(*workload);
     }
@@ -106,7 +109,7 @@ class PerfSimd : public PerfBase<T> {
         st.counters.insert({{"(1) Vector len", vec_len},
                             {"(2) Packet size",
                              benchmark::Counter(
-                                 simd::countof<T>() * vec_len,
+                                 vec_size * vec_len,
                                  benchmark::Counter::kDefaults,
                                  benchmark::Counter::OneK::kIs1024)},
                             {"(3) Elapsed time (ns)", elapsed},
@@ -148,7 +151,7 @@ class PerfSimd : public PerfBase<T> {
                 std::chrono::duration<double, std::nano>>(end - start);
         }
 
-        const size_t pkt_size = vec_len * simd::countof<T>();
+        const size_t pkt_size = vec_len * vec_size;
         const size_t bytes = pkt_size * this->word_size;
         const double elapsed = elapsed_ns.count() / st.iterations();
         st.counters.insert(
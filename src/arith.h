@@ -33,6 +33,7 @@
 
 #include <cassert>
 #include <cstdlib>
+#include <type_traits>
 #include <vector>
 
 #include "big_int.h"
@@ -50,6 +51,15 @@ using SignedDoubleSizeVal = typename SignedDoubleSize<T>::T;
 /** Base/core arithmetical functions of QuadIron. */
 namespace arith {
 
+/** Tell if modular multiplications without division support `T`
+ *
+ * `arith::mul_barrett` and `arith::mul_shoup` shift and divide values of
+ * `DoubleSizeVal<T>`, which `UInt256` does not support.
+ */
+template <typename T>
+using HasFastModMul =
+    std::integral_constant<bool, sizeof(T) <= sizeof(uint64_t)>;
+
 template <typename T>
 T sqrt(T n);
 template <typename T>
@@ -57,6 +67,16 @@ T exp(T base, T exponent);
 template <typename T>
 T exp_mod(T base, T exponent, T modulus);
 template <typename T>
+unsigned barrett_len(T q);
+template <typename T>
+T barrett_factor(T q);
+template <typename T>
+T mul_barrett(T a, T b, T q, T factor, unsigned len);
+template <typename T>
+T shoup_companion(T w, T q);
+template <typename T>
+T mul_shoup(T a, T w, T w_shoup, T q);
+template <typename T>
 bool is_power_of_2(int x);
 template <typename T>
 T ceil2(int x);
@@ -192,6 +212,115 @@ T exp_mod(T base, T exponent, T modulus)
     return result;
 }
 
+/** Get the length of the Barrett reduction modulo `q`.
+ *
+ * @param[in] q a modulus
+ * @return the bit length `L` of `q` if `arith::mul_barrett` supports it,
+ * i.e. if \f$L \le b - 2\f$ where `b` is the number of bits of `T`,
+ * otherwise 0
+ *
+ * @pre `q` must be greater than 1.
+ */
+template <typename T>
+unsigned barrett_len(T q)
+{
+    unsigned len = 0;
+    for (T x = q; x > 0; x >>= 1) {
+        ++len;
+    }
+    return len + 2 <= 8 * sizeof(T) ? len : 0;
+}
+
+/** Get the factor of the Barrett reduction modulo `q`.
+ *
+ * @param[in] q a modulus such that `arith::barrett_len(q)` is not 0
+ * @return \f$\lfloor 4^L / q \rfloor\f$ where `L` is the bit length of `q`
+ */
+template <typename T>
+T barrett_factor(T q)
+{
+    const unsigned len = barrett_len(q);
+    assert(len > 0);
+
+    return static_cast<T>((DoubleSizeVal<T>(1) << (2 * len)) / q);
+}
+
+/** Compute a modular product by Barrett reduction.
+ *
+ * The quotient of \f$x = a b\f$ by `q` is estimated as
+ * \f$\lfloor \lfloor x / 2^{L-1} \rfloor m / 2^{L+1} \rfloor\f$ where
+ * `m` is the Barrett factor of `q`: it is lower than the exact quotient by
+ * at most 2, hence at most two subtractions correct the remainder. It
+ * replaces a division by two multiplications.
+ *
+ * @param[in] a a value lower than `q`
+ * @param[in] b a value lower than `q`
+ * @param[in] q the modulus
+ * @param[in] factor the result of `arith::barrett_factor(q)`
+ * @param[in] len the result of `arith::barrett_len(q)`
+ * @return the value of \f$a b \mod q\f$
+ */
+template <typename T>
+inline T mul_barrett(T a, T b, T q, T factor, unsigned len)
+{
+    assert(a < q && b < q);
+
+    const DoubleSizeVal<T> x = DoubleSizeVal<T>(a) * b;
+    const T quotient = static_cast<T>(
+        (DoubleSizeVal<T>(static_cast<T>(x >> (len - 1))) * factor)
+        >> (len + 1));
+    // the remainder is lower than 3q < 2^b
+    T r = static_cast<T>(x - DoubleSizeVal<T>(quotient) * q);
+    if (r >= q) {
+        r -= q;
+    }
+    if (r >= q) {
+        r -= q;
+    }
+    return r;
+}
+
+/** Precompute the Shoup companion of a constant factor.
+ *
+ * @param[in] w a value lower than `q`
+ * @param[in] q a modulus lower than \f$2^{b-1}\f$ where `b` is the number of
+ * bits of `T`
+ * @return the value of \f$\lfloor w 2^b / q \rfloor\f$
+ */
+template <typename T>
+T shoup_companion(T w, T q)
+{
+    assert(w < q);
+    assert((q >> (8 * sizeof(T) - 1)) == 0);
+
+    return static_cast<T>((DoubleSizeVal<T>(w) << (8 * sizeof(T))) / q);
+}
+
+/** Compute a modular product by a constant by Shoup's reduction.
+ *
+ * The high half of \f$a w'\f$, where `w'` is the companion of `w`, is the
+ * quotient of \f$a w\f$ by `q` or is lower by one: the remainder is
+ * computed modulo \f$2^b\f$ and corrected by at most one subtraction. It
+ * is cheaper than a Barrett reduction when `w` is used many times, e.g. for
+ * the twiddle factors of a FFT.
+ *
+ * @param[in] a a value lower than \f$2^b\f$
+ * @param[in] w a value lower than `q`
+ * @param[in] w_shoup the result of `arith::shoup_companion(w, q)`
+ * @param[in] q the modulus
+ * @return the value of \f$a w \mod q\f$
+ */
+template <typename T>
+inline T mul_shoup(T a, T w, T w_shoup, T q)
+{
+    const T quotient = static_cast<T>(
+        (DoubleSizeVal<T>(a) * w_shoup) >> (8 * sizeof(T)));
+    // only low halves are needed: the remainder is lower than 2q < 2^b
+    const T r = static_cast<T>(
+        DoubleSizeVal<T>(a) * w - DoubleSizeVal<T>(quotient) * q);
+    return r >= q ? r - q : r;
+}
+
 /** Test if `n` is a power of two.
  *
  * @param[in] n a number
@@ -34,11 +34,15 @@
 #include <algorithm>
 #include <cassert>
 #include <cstdint>
+#include <functional>
 #include <memory>
+#include <thread>
 #include <vector>
 #include <sys/time.h>
 
 #include "fec_context.h"
+#include "fec_context_cache.h"
+#include "fec_workspace.h"
 #include "fft_base.h"
 #include "gf_base.h"
 #include "misc.h"
@@ -88,7 +92,17 @@ enum class FecType {
     NON_SYSTEMATIC
 };
 
-/** Base class for Forward Error Correction (FEC) codes. */
+/** Base class for Forward Error Correction (FEC) codes.
+ *
+ * Once built, a code only holds read-only precomputations (field, FFTs,
+ * powers of roots). The scratch memory and statistics of an encoding or a
+ * decoding live in a `Workspace`, so that several threads can share a code
+ * as long as each one calls `encode_blocks_vertical` and
+ * `decode_blocks_vertical` with its own workspace.
+ *
+ * @note Codes based on a decoding matrix (`RsGf2n`) build it in place when
+ * decoding, they can be shared for encoding only.
+ */
 template <typename T>
 class FecCode {
   public:
@@ -105,6 +119,7 @@ class FecCode {
     // FIXME: move n to protected
     T n;
 
+    // statistics of the last call made without a workspace
     uint64_t total_encode_cycles = 0;
     uint64_t n_encode_ops = 0;
     uint64_t total_decode_cycles = 0;
@@ -140,6 +155,57 @@ class FecCode {
         std::vector<Properties>&,
         off_t,
         vec::Buffers<T>&){};
+
+    /**
+     * Encode buffers using the scratch memory of a workspace
+     *
+     * Codecs whose encoding modifies their own state must override it so that
+     * concurrent calls with different workspaces are safe.
+     *
+     * @param output encoded buffers
+     * @param props properties bound to output
+     * @param offset offset in the data fragments
+     * @param words buffers to encode
+     * @param ws workspace allocated by `make_workspace`
+     */
+    virtual void encode_ws(
+        vec::Buffers<T>& output,
+        std::vector<Properties>& props,
+        off_t offset,
+        vec::Buffers<T>& words,
+        Workspace<T>& /* ws */)
+    {
+        encode(output, props, offset, words);
+    }
+
+    /**
+     * Check if blocks are encoded by `encode_unpacked_ws`
+     *
+     * Codecs may then compute on the symbols as read from blocks, without
+     * packing them into elements of type T.
+     */
+    virtual bool encodes_unpacked() const
+    {
+        return false;
+    }
+
+    /**
+     * Encode buffers of unpacked symbols, see `encodes_unpacked`
+     *
+     * @param output encoded buffers of `buf_size` bytes
+     * @param props properties bound to output
+     * @param offset offset in the data fragments
+     * @param words buffers of `buf_size` bytes to encode, they may be modified
+     * @param ws workspace allocated by `make_workspace`
+     */
+    virtual void encode_unpacked_ws(
+        vec::Buffers<uint8_t>& /* output */,
+        std::vector<Properties>& /* props */,
+        off_t /* offset */,
+        vec::Buffers<uint8_t>& /* words */,
+        Workspace<T>& /* ws */)
+    {
+    }
     virtual void
     encode_post_process(vec::Buffers<T>&, std::vector<Properties>&, off_t){};
     virtual void decode_add_data(int /* fragment_index */, int /* row */){};
@@ -204,6 +270,8 @@ class FecCode {
         std::vector<Properties>& input_parities_props,
         std::vector<std::ostream*>& output_data_bufs);
 
+    std::unique_ptr<Workspace<T>> make_workspace();
+
     void encode_blocks_vertical(
         std::vector<uint8_t*>& data_bufs,
         std::vector<uint8_t*>& parities_bufs,
@@ -211,6 +279,14 @@ class FecCode {
         std::vector<bool>& wanted_idxs,
         size_t block_size_bytes);
 
+    void encode_blocks_vertical(
+        std::vector<uint8_t*>& data_bufs,
+        std::vector<uint8_t*>& parities_bufs,
+        std::vector<Properties>& parities_props,
+        std::vector<bool>& wanted_idxs,
+        size_t block_size_bytes,
+        Workspace<T>& ws);
+
     bool decode_blocks_vertical(
         std::vector<uint8_t*>& data_bufs,
         std::vector<uint8_t*>& parities_bufs,
@@ -219,11 +295,49 @@ class FecCode {
         std::vector<bool>& wanted_idxs,
         size_t block_size_bytes);
 
+    bool decode_blocks_vertical(
+        std::vector<uint8_t*>& data_bufs,
+        std::vector<uint8_t*>& parities_bufs,
+        std::vector<Properties>& parities_props,
+        std::vector<int>& missing_idxs,
+        std::vector<bool>& wanted_idxs,
+        size_t block_size_bytes,
+        Workspace<T>& ws);
+
     const gf::Field<T>& get_gf()
     {
         return *gf;
     }
 
+    /** Set the number of threads used to encode a block
+     *
+     * Packets of a block are split into `nb_threads` contiguous ranges that
+     * are encoded concurrently.
+     *
+     * @param nb_threads number of threads, 1 disables multi-threading
+     */
+    void set_nb_threads(unsigned nb_threads)
+    {
+        if (nb_threads == 0) {
+            throw InvalidArgument("number of threads must be positive");
+        }
+        this->nb_threads = nb_threads;
+    }
+
+    unsigned get_nb_threads() const
+    {
+        return nb_threads;
+    }
+
+    /** Get the cache of decoding contexts
+     *
+     * It allows to set its capacity and to read its hit/miss counters.
+     */
+    ContextCache<T>& get_context_cache()
+    {
+        return context_cache;
+    }
+
     void reset_stats_enc()
     {
         total_encode_cycles = 0;
@@ -248,8 +362,10 @@ class FecCode {
     std::unique_ptr<vec::Vector<T>> inv_r_powers = nullptr;
     // This vector MUST be initialized by derived Class using multiplicative FFT
     std::unique_ptr<vec::Vector<T>> r_powers = nullptr;
-    // buffers for intermediate symbols used for systematic FNT
-    std::unique_ptr<vec::Buffers<T>> dec_inter_codeword;
+    // number of threads used to encode a block
+    unsigned nb_threads = 1;
+    // decoding contexts of the last erasure patterns
+    ContextCache<T> context_cache{DEFAULT_CONTEXT_CACHE_SIZE};
 
     // pure abstract methods that will be defined in derived class
     virtual void check_params() = 0;
@@ -257,6 +373,36 @@ class FecCode {
     virtual void init_fft() = 0;
     virtual void init_others() = 0;
 
+    /** Allocate codec specific scratch memory of a workspace
+     *
+     * Codecs attach it to `ws.ext`, see `WorkspaceExt`.
+     *
+     * @param ws workspace being built by `make_workspace`
+     */
+    virtual void init_workspace(Workspace<T>& /* ws */) {}
+
+    /** Prepare a workspace to compute the wanted outputs only
+     *
+     * It is called when `ws.enc_wanted` changes. Unwanted outputs of
+     * `encode_ws` may then be left with any value.
+     *
+     * @param ws workspace whose `enc_wanted` is set
+     */
+    virtual void init_pruning(Workspace<T>& /* ws */) {}
+
+    CachedContext<T>* acquire_context(
+        vec::Vector<T>& fragments_ids,
+        std::vector<Properties>& input_props);
+
+    void encode_packets(
+        std::vector<uint8_t*>& data_bufs,
+        std::vector<uint8_t*>& parities_bufs,
+        std::vector<Properties>& parities_props,
+        std::vector<bool>& wanted_idxs,
+        size_t from,
+        size_t to,
+        Workspace<T>& ws);
+
     // This function will called in constructor of every derived class
     void fec_init()
     {
@@ -477,17 +623,19 @@ void FecCode<T>::encode_streams_vertical(
     bool cont = true;
     off_t offset = 0;
 
+    std::unique_ptr<Workspace<T>> ws = make_workspace();
+
     // vector of buffers storing data read from chunk
     vec::Buffers<char> words_char(n_data, buf_size);
     const std::vector<char*> words_mem_char = words_char.get_mem();
     // vector of buffers storing data that are performed in encoding, i.e. FFT
-    vec::Buffers<T> words(n_data, pkt_size);
+    vec::Buffers<T>& words = ws->words;
     const std::vector<T*> words_mem_T = words.get_mem();
 
     int output_len = get_n_outputs();
 
     // vector of buffers storing data that are performed in encoding, i.e. FFT
-    vec::Buffers<T> output(output_len, pkt_size);
+    vec::Buffers<T>& output = ws->enc_output;
     const std::vector<T*> output_mem_T = output.get_mem();
     // vector of buffers storing data in output chunk
     vec::Buffers<char> output_char(output_len, buf_size);
@@ -522,7 +670,7 @@ void FecCode<T>::encode_streams_vertical(
 
         timeval t1 = tick();
         uint64_t start = hw_timer();
-        encode(output, output_parities_props, offset, words);
+        encode_ws(output, output_parities_props, offset, words, *ws);
         uint64_t end = hw_timer();
         uint64_t t2 = hrtime_usec(t1);
 
@@ -789,7 +937,36 @@ std::unique_ptr<DecodeContext<T>> FecCode<T>::init_context_dec(
         n,
         -1,
         size,
-        output);
+        output,
+        r_powers.get());
+}
+
+/** Get a decoding context of buffers from the cache or build it
+ *
+ * @param fragments_ids sorted ids of received fragments
+ * @param input_props properties bound to received fragments
+ *
+ * @return a context marked as used, to be given back to `context_cache`
+ */
+template <typename T>
+CachedContext<T>* FecCode<T>::acquire_context(
+    vec::Vector<T>& fragments_ids,
+    std::vector<Properties>& input_props)
+{
+    CachedContext<T>* entry = context_cache.acquire(fragments_ids);
+    if (entry != nullptr) {
+        if (entry->context != nullptr) {
+            entry->context->reset(input_props);
+        }
+        return entry;
+    }
+
+    std::unique_ptr<CachedContext<T>> new_entry =
+        std::make_unique<CachedContext<T>>(
+            *gf, fragments_ids, n_data, pkt_size);
+    new_entry->context = init_context_dec(
+        new_entry->fragments_ids, input_props, pkt_size, &new_entry->output);
+    return context_cache.insert(std::move(new_entry));
 }
 
 /* Prepare for decoding
@@ -966,16 +1143,17 @@ bool FecCode<T>::decode_streams_vertical(
 
     int output_len = n_data;
 
+    typename ContextCache<T>::Handle cached(
+        context_cache, acquire_context(fragments_ids, input_parities_props));
+    DecodeContext<T>* context = cached->context.get();
+
     // vector of buffers storing data that are performed in decoding, i.e. FFT
-    vec::Buffers<T> output(output_len, pkt_size);
+    vec::Buffers<T>& output = cached->output;
     const std::vector<T*> output_mem_T = output.get_mem();
     // vector of buffers storing data in output chunk
     vec::Buffers<char> output_char(output_len, buf_size);
     const std::vector<char*> output_mem_char = output_char.get_mem();
 
-    std::unique_ptr<DecodeContext<T>> context = init_context_dec(
-        fragments_ids, input_parities_props, pkt_size, &output);
-
     reset_stats_dec();
 
     // Number of bytes would be read from each input stream
@@ -1047,6 +1225,20 @@ bool FecCode<T>::decode_streams_vertical(
     return true;
 }
 
+/** Allocate a workspace to encode and decode blocks with this code
+ *
+ * @return the workspace, to be passed to `encode_blocks_vertical` and
+ * `decode_blocks_vertical`
+ */
+template <typename T>
+std::unique_ptr<Workspace<T>> FecCode<T>::make_workspace()
+{
+    std::unique_ptr<Workspace<T>> ws = std::make_unique<Workspace<T>>(
+        *gf, n_data, get_n_outputs(), pkt_size, buf_size);
+    init_workspace(*ws);
+    return ws;
+}
+
 /** Encode blocks
  *
  * @param data_bufs vector size must be exactly n_data
@@ -1069,6 +1261,39 @@ void FecCode<T>::encode_blocks_vertical(
     std::vector<Properties>& parities_props,
     std::vector<bool>& wanted_idxs,
     size_t block_size_bytes)
+{
+    std::unique_ptr<Workspace<T>> ws = make_workspace();
+    encode_blocks_vertical(
+        data_bufs,
+        parities_bufs,
+        parities_props,
+        wanted_idxs,
+        block_size_bytes,
+        *ws);
+
+    total_encode_cycles = ws->total_encode_cycles;
+    n_encode_ops = ws->n_encode_ops;
+    total_enc_usec = ws->total_enc_usec;
+}
+
+/** Encode blocks using preallocated scratch memory
+ *
+ * If several threads are set (see `set_nb_threads`), packets are split into
+ * contiguous ranges, each one being encoded by a thread with its own
+ * workspace and properties. Properties are then merged in offset order.
+ *
+ * @see encode_blocks_vertical
+ *
+ * @param ws workspace allocated by `make_workspace`
+ */
+template <typename T>
+void FecCode<T>::encode_blocks_vertical(
+    std::vector<uint8_t*>& data_bufs,
+    std::vector<uint8_t*>& parities_bufs,
+    std::vector<Properties>& parities_props,
+    std::vector<bool>& wanted_idxs,
+    size_t block_size_bytes,
+    Workspace<T>& ws)
 {
     assert(data_bufs.size() == n_data);
     assert(parities_bufs.size() == n_outputs);
@@ -1079,29 +1304,124 @@ void FecCode<T>::encode_blocks_vertical(
         props.clear();
     }
 
-    size_t offset = 0;
-    size_t block_size = block_size_bytes / word_size;
+    const size_t block_size = block_size_bytes / word_size;
+    const size_t n_packets = (block_size + pkt_size - 1) / pkt_size;
+    const unsigned n_workers =
+        static_cast<unsigned>(std::min<size_t>(nb_threads, n_packets));
+
+    if (n_workers <= 1) {
+        encode_packets(
+            data_bufs,
+            parities_bufs,
+            parities_props,
+            wanted_idxs,
+            0,
+            block_size,
+            ws);
+    } else {
+        // the calling thread encodes the first range with `ws`
+        while (ws.workers.size() < n_workers - 1) {
+            ws.workers.push_back(make_workspace());
+        }
+        ws.workers_props.resize(n_workers - 1);
+
+        std::vector<std::thread> threads;
+        threads.reserve(n_workers - 1);
+        for (unsigned t = 1; t < n_workers; ++t) {
+            std::vector<Properties>& props = ws.workers_props[t - 1];
+            props.resize(n_outputs);
+            for (auto& prop : props) {
+                prop.clear();
+            }
+            const size_t begin = (t * n_packets / n_workers) * pkt_size;
+            const size_t end = std::min(
+                block_size, ((t + 1) * n_packets / n_workers) * pkt_size);
+            threads.emplace_back(
+                &FecCode<T>::encode_packets,
+                this,
+                std::ref(data_bufs),
+                std::ref(parities_bufs),
+                std::ref(props),
+                std::ref(wanted_idxs),
+                begin,
+                end,
+                std::ref(*ws.workers[t - 1]));
+        }
+        encode_packets(
+            data_bufs,
+            parities_bufs,
+            parities_props,
+            wanted_idxs,
+            0,
+            (n_packets / n_workers) * pkt_size,
+            ws);
+        for (auto& thread : threads) {
+            thread.join();
+        }
+
+        // ranges are in ascending order of offsets, and as threads run
+        // concurrently the elapsed time is the one of the slowest thread
+        for (unsigned t = 1; t < n_workers; ++t) {
+            const Workspace<T>& worker = *ws.workers[t - 1];
+            for (unsigned i = 0; i < n_outputs; ++i) {
+                parities_props[i].append(ws.workers_props[t - 1][i]);
+            }
+            ws.total_enc_usec =
+                std::max(ws.total_enc_usec, worker.total_enc_usec);
+            ws.total_encode_cycles += worker.total_encode_cycles;
+            ws.n_encode_ops += worker.n_encode_ops;
+        }
+    }
+}
+
+/** Encode packets of blocks located in a range of offsets
+ *
+ * @param data_bufs see `encode_blocks_vertical`
+ * @param parities_bufs see `encode_blocks_vertical`
+ * @param parities_props properties to which the ones of the range are added
+ * @param wanted_idxs see `encode_blocks_vertical`
+ * @param from first offset, in words, it must be a multiple of `pkt_size`
+ * @param to offset following the range, in words
+ * @param ws workspace used for this range, its statistics are reset
+ */
+template <typename T>
+void FecCode<T>::encode_packets(
+    std::vector<uint8_t*>& data_bufs,
+    std::vector<uint8_t*>& parities_bufs,
+    std::vector<Properties>& parities_props,
+    std::vector<bool>& wanted_idxs,
+    size_t from,
+    size_t to,
+    Workspace<T>& ws)
+{
+    size_t offset = from;
 
     // vector of buffers storing data read from chunk
-    vec::Buffers<uint8_t> words_char(n_data, buf_size);
-    const std::vector<uint8_t*> words_mem_char = words_char.get_mem();
+    const std::vector<uint8_t*>& words_mem_char = ws.words_char.get_mem();
     // vector of buffers storing data that are performed in encoding, i.e. FFT
-    vec::Buffers<T> words(n_data, pkt_size);
-    const std::vector<T*> words_mem_T = words.get_mem();
+    vec::Buffers<T>& words = ws.words;
+    const std::vector<T*>& words_mem_T = words.get_mem();
 
     int output_len = get_n_outputs();
 
     // vector of buffers storing data that are performed in encoding, i.e. FFT
-    vec::Buffers<T> output(output_len, pkt_size);
-    const std::vector<T*> output_mem_T = output.get_mem();
+    vec::Buffers<T>& output = ws.enc_output;
+    const std::vector<T*>& output_mem_T = output.get_mem();
     // vector of buffers storing data in output chunk
-    vec::Buffers<uint8_t> output_char(output_len, buf_size);
-    const std::vector<uint8_t*> output_mem_char = output_char.get_mem();
+    const std::vector<uint8_t*>& output_mem_char = ws.enc_output_char.get_mem();
 
-    reset_stats_enc();
+    // symbols are packed, unless the codec computes on them as they are
+    const bool unpacked = encodes_unpacked();
 
-    while (offset < block_size) {
-        size_t remain_size = block_size - offset;
+    ws.reset_stats_enc();
+
+    if (ws.enc_wanted != wanted_idxs) {
+        ws.enc_wanted = wanted_idxs;
+        init_pruning(ws);
+    }
+
+    while (offset < to) {
+        size_t remain_size = to - offset;
         size_t copy_size = std::min(pkt_size, remain_size);
         for (unsigned i = 0; i < n_data; i++) {
             memcpy(
@@ -1122,21 +1442,30 @@ void FecCode<T>::encode_blocks_vertical(
             }
         }
 
-        vec::pack<uint8_t, T>(
-            words_mem_char, words_mem_T, n_data, pkt_size, word_size);
+        if (!unpacked) {
+            vec::pack<uint8_t, T>(
+                words_mem_char, words_mem_T, n_data, pkt_size, word_size);
+        }
 
         timeval t1 = tick();
         uint64_t start = hw_timer();
-        encode(output, parities_props, offset, words);
+        if (unpacked) {
+            encode_unpacked_ws(
+                ws.enc_output_char, parities_props, offset, ws.words_char, ws);
+        } else {
+            encode_ws(output, parities_props, offset, words, ws);
+        }
         uint64_t end = hw_timer();
         uint64_t t2 = hrtime_usec(t1);
 
-        total_enc_usec += t2;
-        total_encode_cycles += (end - start) / (copy_size * word_size);
-        n_encode_ops++;
+        ws.total_enc_usec += t2;
+        ws.total_encode_cycles += (end - start) / (copy_size * word_size);
+        ws.n_encode_ops++;
 
-        vec::unpack<T, uint8_t>(
-            output_mem_T, output_mem_char, output_len, pkt_size, word_size);
+        if (!unpacked) {
+            vec::unpack<T, uint8_t>(
+                output_mem_T, output_mem_char, output_len, pkt_size, word_size);
+        }
 
         for (unsigned i = 0; i < n_outputs; i++) {
             if (wanted_idxs[i]) {
@@ -1181,6 +1510,39 @@ bool FecCode<T>::decode_blocks_vertical(
     std::vector<int>& missing_idxs,
     std::vector<bool>& wanted_idxs,
     size_t block_size_bytes)
+{
+    std::unique_ptr<Workspace<T>> ws = make_workspace();
+    const bool res = decode_blocks_vertical(
+        data_bufs,
+        parities_bufs,
+        parities_props,
+        missing_idxs,
+        wanted_idxs,
+        block_size_bytes,
+        *ws);
+
+    total_decode_cycles = ws->total_decode_cycles;
+    n_decode_ops = ws->n_decode_ops;
+    total_dec_usec = ws->total_dec_usec;
+
+    return res;
+}
+
+/** Decode blocks using preallocated scratch memory
+ *
+ * @see decode_blocks_vertical
+ *
+ * @param ws workspace allocated by `make_workspace`
+ */
+template <typename T>
+bool FecCode<T>::decode_blocks_vertical(
+    std::vector<uint8_t*>& data_bufs,
+    std::vector<uint8_t*>& parities_bufs,
+    std::vector<Properties>& parities_props,
+    std::vector<int>& missing_idxs,
+    std::vector<bool>& wanted_idxs,
+    size_t block_size_bytes,
+    Workspace<T>& ws)
 {
     size_t offset = 0;
     size_t block_size = block_size_bytes / word_size;
@@ -1196,7 +1558,7 @@ bool FecCode<T>::decode_blocks_vertical(
     assert(parities_props.size() == n_outputs);
 
     // ids of received fragments, from 0 to codelen-1
-    vec::Vector<T> fragments_ids(*(this->gf), n_data);
+    vec::Vector<T>& fragments_ids = ws.fragments_ids;
 
     if (type == FecType::SYSTEMATIC) {
         for (unsigned i = 0; i < n_data; i++) {
@@ -1212,7 +1574,7 @@ bool FecCode<T>::decode_blocks_vertical(
         }
     }
 
-    vec::Vector<T> avail_parity_ids(*(this->gf), n_data - avail_data_nb);
+    vec::Vector<T>& avail_parity_ids = ws.avail_parity_ids;
 
     if (fragment_index < n_data) {
         // finish with parities available
@@ -1238,25 +1600,24 @@ bool FecCode<T>::decode_blocks_vertical(
     decode_build();
 
     // vector of buffers storing data read from chunk
-    vec::Buffers<uint8_t> words_char(n_data, buf_size);
-    const std::vector<uint8_t*> words_mem_char = words_char.get_mem();
+    const std::vector<uint8_t*>& words_mem_char = ws.words_char.get_mem();
     // vector of buffers storing data that are performed in encoding, i.e. FFT
-    vec::Buffers<T> words(n_data, pkt_size);
-    const std::vector<T*> words_mem_T = words.get_mem();
+    vec::Buffers<T>& words = ws.words;
+    const std::vector<T*>& words_mem_T = words.get_mem();
 
     int output_len = n_data;
 
+    typename ContextCache<T>::Handle cached(
+        context_cache, acquire_context(fragments_ids, parities_props));
+    DecodeContext<T>* context = cached->context.get();
+
     // vector of buffers storing data that are performed in decoding, i.e. FFT
-    vec::Buffers<T> output(output_len, pkt_size);
-    const std::vector<T*> output_mem_T = output.get_mem();
+    vec::Buffers<T>& output = cached->output;
+    const std::vector<T*>& output_mem_T = output.get_mem();
     // vector of buffers storing data in output chunk
-    vec::Buffers<uint8_t> output_char(output_len, buf_size);
-    const std::vector<uint8_t*> output_mem_char = output_char.get_mem();
-
-    std::unique_ptr<DecodeContext<T>> context =
-        init_context_dec(fragments_ids, parities_props, pkt_size, &output);
+    const std::vector<uint8_t*>& output_mem_char = ws.dec_output_char.get_mem();
 
-    reset_stats_dec();
+    ws.reset_stats_dec();
 
     while (offset < block_size) {
         size_t remain_size = block_size - offset;
@@ -1299,9 +1660,9 @@ bool FecCode<T>::decode_blocks_vertical(
         uint64_t end = hw_timer();
         uint64_t t2 = hrtime_usec(t1);
 
-        total_dec_usec += t2;
-        total_decode_cycles += (end - start) / word_size;
-        n_decode_ops++;
+        ws.total_dec_usec += t2;
+        ws.total_decode_cycles += (end - start) / word_size;
+        ws.n_decode_ops++;
 
         vec::unpack<T, uint8_t>(
             output_mem_T, output_mem_char, output_len, pkt_size, word_size);
@@ -1347,9 +1708,10 @@ void FecCode<T>::decode(
     decode_apply(context, output, words);
 
     if (type == FecType::SYSTEMATIC) {
-        this->fft->fft(*dec_inter_codeword, output);
+        vec::Buffers<T>& codeword = context.get_codeword();
+        this->fft->fft_ws(codeword, output, context.get_fft_scratch());
         for (unsigned i = 0; i < this->n_data; i++) {
-            output.copy(i, dec_inter_codeword->get(i));
+            output.copy(i, codeword.get(i));
         }
     }
 }
@@ -1433,15 +1795,20 @@ void FecCode<T>::decode_apply(
     // where n_i=v_i/A'_i(x_i)
     this->gf->mul_vec_to_vecp(inv_A_i, words, buf1_k);
 
-    // compute buf2_n
-    this->fft->fft_inv(buf2_n, buf1_n);
+    // compute buf2_n, `buf1_n` being zero but at received fragments
+    this->fft->fft_inv_sparse_ws(
+        buf2_n,
+        buf1_n,
+        context.get_nonzero_mask(),
+        context.get_fft_scratch());
 
-    this->fft_2k->fft(buf1_2k, output);
+    fft::Scratch<T>& scratch_2k = context.get_fft_2k_scratch();
+    this->fft_2k->fft_ws(buf1_2k, output, scratch_2k);
 
     // multiply FFT(A) and buf2_2k
     this->gf->mul_vec_to_vecp(A_fft_2k, buf1_2k, buf1_2k);
 
-    this->fft_2k->ifft(buf2_2k, buf1_2k);
+    this->fft_2k->ifft_ws(buf2_2k, buf1_2k, scratch_2k);
 
     // negatize output
     this->gf->neg(output);
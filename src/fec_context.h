@@ -38,6 +38,7 @@
 #include <vector>
 #include <sys/time.h>
 
+#include "arith.h"
 #include "fft_base.h"
 #include "gf_base.h"
 #include "gf_nf4.h"
@@ -74,8 +75,8 @@ class DecodeContext {
         const int n,
         int vx_zero = -1,
         const size_t size = 0,
-        vec::Buffers<T>* output = nullptr)
-        : props_indices(input_props.size(), 0)
+        vec::Buffers<T>* output = nullptr,
+        const vec::Vector<T>* roots = nullptr)
     {
         this->k = k;
         this->n = n;
@@ -89,12 +90,9 @@ class DecodeContext {
         this->max_n_2k = (this->n > this->len_2k) ? this->n : this->len_2k;
 
         this->fragments_ids = &fragments_ids;
+        this->roots = roots;
 
-        for (auto& props : input_props) {
-            // Sort properties on the basis of location of pairs in ascending
-            // order.
-            props.sort();
-        }
+        reset(input_props);
 
         A = std::make_unique<vec::Poly<T>>(gf, n);
         A_fft_2k = std::make_unique<vec::Vector<T>>(gf, len_2k);
@@ -143,6 +141,23 @@ class DecodeContext {
 
     ~DecodeContext() = default;
 
+    /** Prepare the context for a new set of input properties
+     *
+     * It allows to reuse a context to decode fragments that have the same ids
+     * as the ones the context was built for.
+     *
+     * @param input_props properties bound to received fragments
+     */
+    void reset(std::vector<Properties>& input_props)
+    {
+        props_indices.assign(input_props.size(), 0);
+        for (auto& props : input_props) {
+            // Sort properties on the basis of location of pairs in ascending
+            // order.
+            props.sort();
+        }
+    }
+
     unsigned get_len_2k() const
     {
         return len_2k;
@@ -153,6 +168,19 @@ class DecodeContext {
         return *fragments_ids;
     }
 
+    /** Get the mask of non-zero elements of the `N1` buffer
+     *
+     * The mask is rebuilt at each call as FFTs use it as scratch memory.
+     */
+    std::vector<bool>& get_nonzero_mask()
+    {
+        nonzero_mask.assign(n, false);
+        for (int i = 0; i < fragments_ids->get_n(); ++i) {
+            nonzero_mask[fragments_ids->get(i)] = true;
+        }
+        return nonzero_mask;
+    }
+
     vec::Vector<T>& get_vector(CtxVec type) const
     {
         switch (type) {
@@ -205,6 +233,63 @@ class DecodeContext {
         }
     }
 
+    /** Get an `n`-length buffer used to re-encode decoded symbols
+     *
+     * It is needed by systematic codes only and is allocated at first use.
+     */
+    vec::Buffers<T>& get_codeword()
+    {
+        if (codeword == nullptr) {
+            codeword = std::make_unique<vec::Buffers<T>>(n, size);
+        }
+        return *codeword;
+    }
+
+    /** Get the scratch memory of the Buffers transforms of `fft`
+     *
+     * Contexts are used by a decoding at a time, hence decodings sharing the
+     * FFTs of a code compute with the scratch memory of their context. It is
+     * allocated at first use.
+     */
+    fft::Scratch<T>& get_fft_scratch()
+    {
+        if (fft_scratch == nullptr) {
+            fft_scratch = fft->make_scratch();
+        }
+        return *fft_scratch;
+    }
+
+    /** Get the scratch memory of the Buffers transforms of `fft_2k`
+     *
+     * @see get_fft_scratch
+     */
+    fft::Scratch<T>& get_fft_2k_scratch()
+    {
+        if (fft_2k_scratch == nullptr) {
+            fft_2k_scratch = fft_2k->make_scratch();
+        }
+        return *fft_2k_scratch;
+    }
+
+    /** Get \f$-FFT(A) / len_2k\f$
+     *
+     * Decoding multiplies \f$FFT(A)\f$ by a transform of length `len_2k`,
+     * then negates the inverse transform of the product: the normalization
+     * of the inverse transform and the negation are folded into this vector,
+     * which is computed at first use.
+     */
+    vec::Vector<T>& get_neg_A_fft_2k()
+    {
+        if (neg_A_fft_2k == nullptr) {
+            const T coef = gf->sub(0, gf->get_inv_n_mod_p(len_2k));
+            neg_A_fft_2k = std::make_unique<vec::Vector<T>>(*gf, len_2k);
+            for (unsigned i = 0; i < len_2k; ++i) {
+                neg_A_fft_2k->set(i, gf->mul(A_fft_2k->get(i), coef));
+            }
+        }
+        return *neg_A_fft_2k;
+    }
+
     void find_vx_zero(vec::Vector<T>* betas)
     {
         vx_zero = -1;
@@ -232,15 +317,7 @@ class DecodeContext {
     void init(const vec::Vector<T>& vx)
     {
         // compute A(x) = prod_j(x-x_j)
-        if (gf->isNF4) {
-            A->set(0, this->gf->replicate(1));
-        } else {
-            A->set(0, 1);
-        }
-
-        for (unsigned i = 0; i < k; ++i) {
-            A->mul_to_x_plus_coef(this->gf->sub(0, vx.get(i)));
-        }
+        compute_A(vx);
 
         // compute A'(x) since A_i(x_i) = A'_i(x_i)
         vec::Poly<T> _A(*A);
@@ -273,6 +350,140 @@ class DecodeContext {
         }
     }
 
+    /** Compute \f$A(x) = \prod_{i=0}^{k-1}(x - x_i)\f$
+     *
+     * Multiplying the \f$k\f$ factors one by one costs \f$O(k^2)\f$, so:
+     * - if the evaluation points of the code are the \f$n\f$-th roots of
+     *   unity and few fragments are missing, \f$A(x) = (x^n - 1) / B(x)\f$
+     *   where \f$B(x)\f$ is the product over the \f$n - k\f$ missing points,
+     * - otherwise \f$A(x)\f$ is computed by a subproduct tree whose large
+     *   products are done through `fft_2k`.
+     *
+     * The cheapest method is chosen from rough operation counts.
+     */
+    void compute_A(const vec::Vector<T>& vx)
+    {
+        // products of more factors than this are multiplied through `fft_2k`,
+        // i.e. when a schoolbook product costs more than three FFTs
+        unsigned fft_threshold = k;
+        if (fft_2k != nullptr) {
+            fft_threshold = arith::sqrt<unsigned>(
+                3 * len_2k * arith::log2<unsigned>(len_2k));
+        }
+
+        const unsigned nb_missing = n - k;
+        const unsigned long tree_cost =
+            (k <= fft_threshold) ? static_cast<unsigned long>(k) * k / 2
+                                 : 2UL * k * fft_threshold;
+        const unsigned long complement_cost =
+            static_cast<unsigned long>(nb_missing) * n;
+
+        if (roots != nullptr && !gf->isNF4 && complement_cost < tree_cost) {
+            compute_A_complement();
+        } else if (k <= fft_threshold) {
+            subproduct(*A, vx, 0, k, fft_threshold, nullptr, nullptr);
+        } else {
+            vec::Vector<T> tmp1(*gf, len_2k);
+            vec::Vector<T> tmp2(*gf, len_2k);
+            subproduct(*A, vx, 0, k, fft_threshold, &tmp1, &tmp2);
+        }
+    }
+
+    /** Compute \f$\prod_{i=first}^{last-1}(x - x_i)\f$
+     *
+     * The product of each half of the factors is computed recursively, then
+     * both are multiplied by FFT.
+     *
+     * @param out zero-filled polynomial of length at least `last - first + 1`
+     * @param vx evaluation points
+     * @param first index of the first factor
+     * @param last index after the last factor
+     * @param fft_threshold number of factors above which FFT is used
+     * @param tmp1 temporary vector of length `len_2k`
+     * @param tmp2 temporary vector of length `len_2k`
+     */
+    void subproduct(
+        vec::Poly<T>& out,
+        const vec::Vector<T>& vx,
+        unsigned first,
+        unsigned last,
+        unsigned fft_threshold,
+        vec::Vector<T>* tmp1,
+        vec::Vector<T>* tmp2)
+    {
+        const unsigned len = last - first;
+
+        if (len <= fft_threshold) {
+            out.set(0, gf->isNF4 ? gf->replicate(1) : 1);
+            for (unsigned i = first; i < last; ++i) {
+                out.mul_to_x_plus_coef(gf->sub(0, vx.get(i)));
+            }
+            return;
+        }
+
+        const unsigned middle = first + len / 2;
+        vec::Poly<T> left(*gf, middle - first + 1);
+        vec::Poly<T> right(*gf, last - middle + 1);
+        left.zero_fill();
+        right.zero_fill();
+        subproduct(left, vx, first, middle, fft_threshold, tmp1, tmp2);
+        subproduct(right, vx, middle, last, fft_threshold, tmp1, tmp2);
+
+        // the product has a degree lower than `len_2k`
+        vec::ZeroExtended<T> left_2k(left, len_2k);
+        vec::ZeroExtended<T> right_2k(right, len_2k);
+        fft_2k->fft(*tmp1, left_2k);
+        fft_2k->fft(*tmp2, right_2k);
+        tmp1->hadamard_mul(tmp2);
+        fft_2k->ifft(*tmp2, *tmp1);
+
+        for (unsigned i = 0; i <= len; ++i) {
+            out.set(i, tmp2->get(i));
+        }
+    }
+
+    /** Compute \f$A(x) = (x^n - 1) / B(x)\f$
+     *
+     * \f$B(x)\f$ is the product of \f$(x - r^j)\f$ for the \f$m = n - k\f$
+     * missing fragments \f$j\f$. As \f$B(x)\f$ is monic and \f$x^n - 1\f$
+     * has only two terms, coefficients of the quotient are given by:
+     * \f{eqnarray*}{
+     *   a_k &= 1 \\
+     *   a_t &= - \sum_{j=0}^{m-1} b_j a_{t+m-j}, \quad a_{t'} = 0
+     *   \text{ for } t' > k
+     * \f}
+     * It costs \f$O(m \cdot n)\f$ operations.
+     */
+    void compute_A_complement()
+    {
+        const unsigned m = n - k;
+
+        std::vector<bool> received(n, false);
+        for (unsigned i = 0; i < k; ++i) {
+            received[fragments_ids->get(i)] = true;
+        }
+
+        vec::Poly<T> B(*gf, m + 1);
+        B.zero_fill();
+        B.set(0, 1);
+        for (unsigned j = 0; j < n; ++j) {
+            if (!received[j]) {
+                B.mul_to_x_plus_coef(gf->sub(0, roots->get(j)));
+            }
+        }
+
+        A->set(k, 1);
+        for (int t = k - 1; t >= 0; --t) {
+            T val = 0;
+            const unsigned max_j = std::min(m, k - t);
+            for (unsigned j = 1; j <= max_j; ++j) {
+                // coefficient a_{t+j} is multiplied by b_{m-j}
+                val = gf->add(val, gf->mul(B.get(m - j), A->get(t + j)));
+            }
+            A->set(t, gf->sub(0, val));
+        }
+    }
+
   public:
     int vx_zero;
     std::vector<size_t> props_indices;
@@ -288,9 +499,15 @@ class DecodeContext {
     fft::FourierTransform<T>* fft_2k;
 
     const vec::Vector<T>* fragments_ids;
+    // see `get_nonzero_mask`
+    std::vector<bool> nonzero_mask;
+    // all evaluation points of the code, when they are the n-th roots of unity
+    const vec::Vector<T>* roots;
 
     std::unique_ptr<vec::Poly<T>> A = nullptr;
     std::unique_ptr<vec::Vector<T>> A_fft_2k = nullptr;
+    // see `get_neg_A_fft_2k`
+    std::unique_ptr<vec::Vector<T>> neg_A_fft_2k = nullptr;
     std::unique_ptr<vec::Vector<T>> inv_A_i = nullptr;
     std::unique_ptr<vec::Poly<T>> S = nullptr;
 
@@ -316,6 +533,11 @@ class DecodeContext {
     std::unique_ptr<vec::Buffers<T>> buf2_n = nullptr;
     // An `len_2k`-length buffer sliced from `buf_max_n_2k`
     std::unique_ptr<vec::Buffers<T>> buf2_2k = nullptr;
+    // An `n`-length buffer fully allocated at first use
+    std::unique_ptr<vec::Buffers<T>> codeword = nullptr;
+    // see `get_fft_scratch` and `get_fft_2k_scratch`
+    std::unique_ptr<fft::Scratch<T>> fft_scratch = nullptr;
+    std::unique_ptr<fft::Scratch<T>> fft_2k_scratch = nullptr;
 };
 
 } // namespace fec
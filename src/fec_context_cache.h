@@ -0,0 +1,245 @@
+/* -*- mode: c++ -*- */
+/*
+ * Copyright 2017-2018 Scality
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its contributors
+ *    may be used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+#ifndef __QUAD_FEC_CONTEXT_CACHE_H__
+#define __QUAD_FEC_CONTEXT_CACHE_H__
+
+#include <cstdint>
+#include <list>
+#include <memory>
+#include <mutex>
+
+#include "fec_context.h"
+#include "gf_base.h"
+#include "vec_buffers.h"
+#include "vec_vector.h"
+
+namespace quadiron {
+namespace fec {
+
+/// Default number of decoding contexts kept by a code
+static constexpr size_t DEFAULT_CONTEXT_CACHE_SIZE = 16;
+
+/** A decoding context along with the data it is bound to
+ *
+ * A `DecodeContext` keeps pointers to the ids of received fragments and to
+ * the buffers receiving decoded symbols, so they are stored together.
+ */
+template <typename T>
+struct CachedContext {
+    CachedContext(
+        const gf::Field<T>& gf,
+        vec::Vector<T>& ids,
+        unsigned n_outputs,
+        size_t size)
+        : fragments_ids(gf, ids.get_n()), output(n_outputs, size)
+    {
+        fragments_ids.copy(&ids);
+    }
+
+    // ids of received fragments, from 0 to codelen-1
+    vec::Vector<T> fragments_ids;
+    // decoded symbols
+    vec::Buffers<T> output;
+    // context built for `fragments_ids`, it may be nullptr for codes that do
+    // not need one
+    std::unique_ptr<DecodeContext<T>> context = nullptr;
+    // barycentric weights of the received fragments used to repair a single
+    // fragment, computed at first use
+    std::unique_ptr<vec::Vector<T>> repair_weights = nullptr;
+    // true while a decoding uses the context
+    bool in_use = false;
+};
+
+/** Bounded cache of decoding contexts
+ *
+ * Contexts are keyed by the ids of received fragments. As these ids are
+ * always sorted by the decoding functions, an erasure pattern is keyed by its
+ * sorted set of fragment ids. The least recently used contexts are evicted
+ * first.
+ *
+ * A context is used by one decoding at a time: it is acquired through a
+ * `Handle` and is given back when the handle is destroyed. Looking up and
+ * giving back a context do not allocate memory.
+ *
+ * The cache is thread-safe.
+ */
+template <typename T>
+class ContextCache {
+  public:
+    /** Exclusive access to a cached context */
+    class Handle {
+      public:
+        Handle(ContextCache<T>& cache, CachedContext<T>* entry)
+            : cache(cache), entry(entry)
+        {
+        }
+        Handle(const Handle&) = delete;
+        Handle& operator=(const Handle&) = delete;
+        ~Handle()
+        {
+            cache.release(entry);
+        }
+
+        CachedContext<T>* operator->() const
+        {
+            return entry;
+        }
+
+        CachedContext<T>& operator*() const
+        {
+            return *entry;
+        }
+
+      private:
+        ContextCache<T>& cache;
+        CachedContext<T>* entry;
+    };
+
+    explicit ContextCache(size_t capacity) : capacity(capacity) {}
+    ContextCache(const ContextCache&) = delete;
+    ContextCache& operator=(const ContextCache&) = delete;
+
+    /** Look up an unused context built for given fragments
+     *
+     * @param fragments_ids sorted ids of received fragments
+     *
+     * @return the context marked as used, or nullptr if there is none
+     */
+    CachedContext<T>* acquire(const vec::Vector<T>& fragments_ids)
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+
+        for (auto it = entries.begin(); it != entries.end(); ++it) {
+            CachedContext<T>& entry = **it;
+            if (!entry.in_use && entry.fragments_ids == fragments_ids) {
+                entry.in_use = true;
+                // most recently used entries are at the front
+                entries.splice(entries.begin(), entries, it);
+                hits++;
+                return &entry;
+            }
+        }
+        misses++;
+        return nullptr;
+    }
+
+    /** Add a new context to the cache
+     *
+     * @param entry the context, it is marked as used
+     *
+     * @return the context
+     */
+    CachedContext<T>* insert(std::unique_ptr<CachedContext<T>> entry)
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+
+        entry->in_use = true;
+        entries.push_front(std::move(entry));
+        return entries.front().get();
+    }
+
+    /** Give back a context acquired or inserted before
+     *
+     * Least recently used contexts are evicted if the cache is full.
+     */
+    void release(CachedContext<T>* entry)
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+
+        entry->in_use = false;
+        evict();
+    }
+
+    /** Set the maximal number of contexts kept, 0 disables the cache */
+    void set_capacity(size_t capacity)
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+
+        this->capacity = capacity;
+        evict();
+    }
+
+    size_t get_capacity() const
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        return capacity;
+    }
+
+    size_t size() const
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        return entries.size();
+    }
+
+    uint64_t get_hits() const
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        return hits;
+    }
+
+    uint64_t get_misses() const
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        return misses;
+    }
+
+    void reset_stats()
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        hits = 0;
+        misses = 0;
+    }
+
+  private:
+    // evict unused entries, starting from the least recently used one, until
+    // the capacity is respected
+    void evict()
+    {
+        auto it = entries.end();
+        while (entries.size() > capacity && it != entries.begin()) {
+            --it;
+            if (!(*it)->in_use) {
+                it = entries.erase(it);
+            }
+        }
+    }
+
+    mutable std::mutex mutex;
+    size_t capacity;
+    std::list<std::unique_ptr<CachedContext<T>>> entries;
+    uint64_t hits = 0;
+    uint64_t misses = 0;
+};
+
+} // namespace fec
+} // namespace quadiron
+
+#endif
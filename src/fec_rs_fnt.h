@@ -31,6 +31,9 @@
 #ifndef __QUAD_FEC_RS_FNT_H__
 #define __QUAD_FEC_RS_FNT_H__
 
+#include <algorithm>
+#include <cstring>
+
 #include "arith.h"
 #include "fec_base.h"
 #include "fft_2n.h"
@@ -51,20 +54,45 @@ namespace fec {
 template <typename T>
 class RsFnt : public FecCode<T> {
   private:
-    // buffers for intermediate symbols used for systematic FNT
-    std::unique_ptr<vec::Buffers<T>> inter_words;
-    // buffers for suffix symbols of codewords used for systematic FNT
-    std::unique_ptr<vec::Buffers<T>> suffix_words;
     // received fragments id for encoding of systematic FNT
     std::unique_ptr<vec::Vector<T>> enc_frag_ids;
-    // decoding context used in encoding of systematic FNT
-    std::unique_ptr<DecodeContext<T>> enc_context;
+    // codeword computed by the vector `encode` when its output is shorter
+    // than `n`, scratch memory of calls made without a workspace
+    std::unique_ptr<vec::Vector<T>> vec_codeword;
 
     // Indices used for accelerated functions
     size_t simd_vec_len;
     size_t simd_trailing_len;
     size_t simd_offset;
 
+    /// Scratch memory of `encode_ws`, attached to workspaces
+    class FntWorkspace : public WorkspaceExt {
+      public:
+        std::unique_ptr<vec::Buffers<T>> inter_words = nullptr;
+        std::unique_ptr<vec::Buffers<T>> data_words = nullptr;
+        std::unique_ptr<vec::Buffers<T>> suffix_words = nullptr;
+        std::unique_ptr<vec::Buffers<T>> codeword = nullptr;
+        std::unique_ptr<DecodeContext<T>> context = nullptr;
+        std::unique_ptr<OorMarks> marks = nullptr;
+        // scratch memory of `encode_unpacked_ws`: views of `words_char` as
+        // 16-bit symbols, codeword and intermediate symbols of the FFT and
+        // their marks
+        std::unique_ptr<vec::Buffers<uint16_t>> narrow_words = nullptr;
+        std::unique_ptr<vec::Buffers<uint16_t>> narrow_inter = nullptr;
+        std::unique_ptr<vec::Buffers<uint16_t>> narrow_suffix = nullptr;
+        std::unique_ptr<vec::Buffers<uint16_t>> narrow_codeword = nullptr;
+        std::unique_ptr<OorMarks> narrow_marks = nullptr;
+        std::unique_ptr<OorMarks> inter_marks = nullptr;
+        // symbols of codewords needed by the wanted outputs, see
+        // `init_pruning`
+        std::vector<bool> pruning;
+    };
+
+    static FntWorkspace& get_fnt_ws(Workspace<T>& ws)
+    {
+        return static_cast<FntWorkspace&>(*ws.ext);
+    }
+
   public:
     RsFnt(
         FecType type,
@@ -77,7 +105,7 @@ class RsFnt : public FecCode<T> {
         this->fec_init();
 
         // Indices used for accelerated functions
-        const unsigned ratio = simd::countof<T>();
+        const unsigned ratio = simd::vec_countof<T>();
         simd_vec_len = this->pkt_size / ratio;
         simd_trailing_len = this->pkt_size - simd_vec_len * ratio;
         simd_offset = simd_vec_len * ratio;
@@ -110,9 +138,10 @@ class RsFnt : public FecCode<T> {
         // compute root of order n-1 such as r^(n-1) mod q == 1
         this->r = this->gf->get_nth_root(this->n);
 
+        // the FFT is truncated to the `code_len` symbols of codewords
         int m = arith::ceil2<int>(this->n_data);
         this->fft = std::make_unique<fft::Radix2<T>>(
-            *(this->gf), this->n, m, this->pkt_size);
+            *(this->gf), this->n, m, this->pkt_size, this->code_len);
 
         // FIXME Issue #286: current decoding algorithm use FFT of length `2*k`
         // that should be less than `q`
@@ -138,6 +167,8 @@ class RsFnt : public FecCode<T> {
             this->r_powers->set(i, this->gf->exp(this->r, i));
         }
 
+        vec_codeword = std::make_unique<vec::Vector<T>>(*(this->gf), this->n);
+
         if (this->type == FecType::SYSTEMATIC) {
             // for encoding
             enc_frag_ids =
@@ -146,34 +177,128 @@ class RsFnt : public FecCode<T> {
             for (unsigned i = 0; i < this->n_data; i++) {
                 enc_frag_ids->set(i, i);
             }
+        }
+    }
 
-            inter_words =
+    inline void init_workspace(Workspace<T>& ws) override
+    {
+        ws.ext = std::make_unique<FntWorkspace>();
+        FntWorkspace& fws = get_fnt_ws(ws);
+
+        // buffers for suffix symbols of codewords, i.e. the symbols beyond
+        // `code_len` that the FFT needs as scratch memory
+        fws.suffix_words = std::make_unique<vec::Buffers<T>>(
+            this->n - this->code_len, this->pkt_size);
+        // codeword: data words if systematic and output, bound at each
+        // encoding, and suffix words
+        vec::Buffers<T> prefix(
+            this->code_len, this->pkt_size, std::vector<T*>(this->code_len));
+        fws.codeword =
+            std::make_unique<vec::Buffers<T>>(prefix, *fws.suffix_words);
+        // marks of out-of-range outputs, set by the last layer of the FFT
+        fws.marks = std::make_unique<OorMarks>(
+            first_output(), this->code_len, this->pkt_size, sizeof(T));
+
+        if (this->type == FecType::SYSTEMATIC) {
+            // buffers for intermediate symbols
+            fws.inter_words =
+                std::make_unique<vec::Buffers<T>>(this->n_data, this->pkt_size);
+            // buffers for data symbols computed by a pruned FFT
+            fws.data_words =
                 std::make_unique<vec::Buffers<T>>(this->n_data, this->pkt_size);
-            suffix_words = std::make_unique<vec::Buffers<T>>(
-                this->n - this->n_data - this->n_outputs, this->pkt_size);
 
+            // decoding context computing intermediate symbols
             std::vector<Properties> dummy_props;
-            enc_context = this->init_context_dec(
-                *enc_frag_ids, dummy_props, this->pkt_size, inter_words.get());
+            fws.context = this->init_context_dec(
+                *enc_frag_ids,
+                dummy_props,
+                this->pkt_size,
+                fws.inter_words.get());
+        }
+
+        if (encodes_unpacked()) {
+            init_narrow_workspace(ws);
+        }
+    }
+
+    /**
+     * Allocate the scratch memory of `encode_unpacked_ws`
+     *
+     * The FFT reads and writes 16-bit symbols in the buffers of unpacked data
+     * and outputs, which are bound at each encoding.
+     */
+    void init_narrow_workspace(Workspace<T>& ws)
+    {
+        FntWorkspace& fws = get_fnt_ws(ws);
+        const std::vector<uint8_t*>& words_mem = ws.words_char.get_mem();
+        std::vector<uint16_t*> mem(this->n_data);
+        for (unsigned i = 0; i < this->n_data; ++i) {
+            mem[i] = reinterpret_cast<uint16_t*>(words_mem[i]);
+        }
+        fws.narrow_words = std::make_unique<vec::Buffers<uint16_t>>(
+            this->n_data, this->pkt_size, mem);
+        fws.narrow_suffix = std::make_unique<vec::Buffers<uint16_t>>(
+            this->n - this->code_len, this->pkt_size);
+        vec::Buffers<uint16_t> prefix(
+            this->code_len,
+            this->pkt_size,
+            std::vector<uint16_t*>(this->code_len));
+        fws.narrow_codeword = std::make_unique<vec::Buffers<uint16_t>>(
+            prefix, *fws.narrow_suffix);
+        // all symbols of the codeword are marked, as the FFT computes them
+        fws.narrow_marks = std::make_unique<OorMarks>(
+            0, this->n, this->pkt_size, sizeof(uint16_t));
+
+        if (this->type == FecType::SYSTEMATIC) {
+            fws.narrow_inter = std::make_unique<vec::Buffers<uint16_t>>(
+                this->n_data, this->pkt_size);
+            fws.inter_marks = std::make_unique<OorMarks>(
+                0, this->n_data, this->pkt_size, sizeof(uint16_t));
+        }
+    }
+
+    /**
+     * Flag the symbols of codewords needed by the wanted outputs
+     *
+     * Data symbols of systematic codewords are never needed. The FFT is
+     * pruned unless all symbols of a non-systematic codeword are wanted.
+     */
+    inline void init_pruning(Workspace<T>& ws) override
+    {
+        const unsigned n = this->n;
+        const unsigned first =
+            (this->type == FecType::SYSTEMATIC) ? this->n_data : 0;
 
-            // for decoding
-            this->dec_inter_codeword =
-                std::make_unique<vec::Buffers<T>>(this->n, this->pkt_size);
+        std::vector<bool>& pruning = get_fnt_ws(ws).pruning;
+        pruning.assign(2 * n, false);
+        bool all = (first == 0);
+        for (unsigned i = 0; i < this->n_outputs; ++i) {
+            pruning[n + first + i] = ws.enc_wanted[i];
+            all = all && ws.enc_wanted[i];
+        }
+        if (all) {
+            pruning.clear();
+        } else {
+            static_cast<fft::Radix2<T>*>(this->fft.get())
+                ->init_pruning(pruning);
         }
     }
 
     int get_n_outputs() override
     {
-        return (this->type == FecType::SYSTEMATIC) ? this->n_parities : this->n;
+        return this->n_outputs;
     }
 
     /**
      * Encode vector
      *
-     * @param output must be n
-     * @param props must be exactly n
+     * @param output must be at least n_outputs
+     * @param props must be exactly n_outputs
      * @param offset used to locate special values
      * @param words must be n_data
+     *
+     * @note Outputs shorter than `n` are computed in scratch memory of the
+     * code, concurrent calls must use the Buffers `encode_ws` instead.
      */
     void encode(
         vec::Vector<T>& output,
@@ -181,7 +306,14 @@ class RsFnt : public FecCode<T> {
         off_t offset,
         vec::Vector<T>& words) override
     {
-        this->fft->fft(output, words);
+        if (output.get_n() < static_cast<int>(this->n)) {
+            // the FFT needs `n` elements, the truncated transform only
+            // computes the first `code_len` of them
+            this->fft->fft(*vec_codeword, words);
+            output.copy(vec_codeword.get(), output.get_n());
+        } else {
+            this->fft->fft(output, words);
+        }
         encode_post_process(output, props, offset);
     }
 
@@ -201,53 +333,266 @@ class RsFnt : public FecCode<T> {
         }
     }
 
+    /**
+     * Perform the Lagrange interpolation of `decode_apply` on buffers
+     *
+     * The products by `inv_A_i` and by \f$-FFT(A) / len_2k\f$ are computed
+     * while the inverse FFTs copy their inputs, which saves the passes over
+     * the buffers of the products, of the normalization of the inverse FFT
+     * and of the negation.
+     *
+     * @param context decoding context whose output is `output`
+     * @param output must be exactly n_data
+     * @param words must be exactly n_data
+     */
     void decode_data(
         DecodeContext<T>& context,
         vec::Buffers<T>& output,
         vec::Buffers<T>& words)
     {
         vec::Vector<T>& inv_A_i = context.get_vector(CtxVec::INV_A_I);
-        vec::Vector<T>& A_fft_2k = context.get_vector(CtxVec::A_FFT_2K);
+        vec::Vector<T>& neg_A_fft_2k = context.get_neg_A_fft_2k();
 
-        vec::Buffers<T>& buf1_k = context.get_buffer(CtxBuf::K1);
         vec::Buffers<T>& buf2_n = context.get_buffer(CtxBuf::N2);
         vec::Buffers<T>& buf1_2k = context.get_buffer(CtxBuf::B2K1);
         vec::Buffers<T>& buf2_2k = context.get_buffer(CtxBuf::B2K2);
 
+        auto radix2 = static_cast<fft::Radix2<T>*>(this->fft.get());
+        auto radix2_2k = static_cast<fft::Radix2<T>*>(this->fft_2k.get());
+
         // compute N'(x) = sum_i{n_i * x^z_i}
         // where n_i=v_i/A'_i(x_i)
-        this->gf->mul_vec_to_vecp(inv_A_i, words, buf1_k);
-
-        // compute buf2_n
-        // Input `buf1_k` contains first `k` received symbols from 0 .. k-1
-        this->fft->fft_inv(buf2_n, buf1_k);
-
-        this->fft_2k->fft(buf1_2k, output);
-
-        // multiply FFT(A) and buf2_2k
-        this->gf->mul_vec_to_vecp(A_fft_2k, buf1_2k, buf1_2k);
+        radix2->fft_inv_scaled(buf2_n, words, inv_A_i);
 
-        this->fft_2k->ifft(buf2_2k, buf1_2k);
+        radix2_2k->fft(buf1_2k, output);
 
-        // negatize output
-        this->gf->neg(output);
+        // multiply FFT(A) and buf1_2k, the product being divided by `len_2k`
+        // and negated
+        radix2_2k->fft_inv_scaled(buf2_2k, buf1_2k, neg_A_fft_2k);
     }
 
+    /**
+     * Encode buffers
+     *
+     * @note The encoding needs scratch memory which is allocated at each call,
+     * prefer `encode_ws`.
+     */
     void encode(
         vec::Buffers<T>& output,
         std::vector<Properties>& props,
         off_t offset,
         vec::Buffers<T>& words) override
     {
+        std::unique_ptr<Workspace<T>> ws = this->make_workspace();
+        encode_ws(output, props, offset, words, *ws);
+    }
+
+    void encode_ws(
+        vec::Buffers<T>& output,
+        std::vector<Properties>& props,
+        off_t offset,
+        vec::Buffers<T>& words,
+        Workspace<T>& ws) override
+    {
+        FntWorkspace& fws = get_fnt_ws(ws);
+        const std::vector<bool>& pruning = fws.pruning;
+        OorMarks& marks = *fws.marks;
+        marks.clear();
         if (this->type == FecType::SYSTEMATIC) {
-            decode_data(*enc_context, *inter_words, words);
-            vec::Buffers<T> _tmp(words, output);
-            vec::Buffers<T> _output(_tmp, *suffix_words);
-            this->fft->fft(_output, *inter_words);
+            encode_systematic(
+                output,
+                words,
+                *fws.inter_words,
+                *fws.codeword,
+                *fws.context,
+                pruning,
+                *fws.data_words,
+                marks);
         } else {
-            this->fft->fft(output, words);
+            vec::Buffers<T>& codeword = *fws.codeword;
+            for (unsigned i = 0; i < this->n_outputs; ++i) {
+                codeword.set(i, output.get(i));
+            }
+            fft_marked(codeword, words, pruning, marks);
+        }
+        // out-of-range outputs have been marked by the FFT
+        const unsigned first = first_output();
+        for (unsigned i = 0; i < this->n_outputs; ++i) {
+            if (pruning.empty() || ws.enc_wanted[i]) {
+                marks.get_props(first + i, props[i], offset);
+            } else {
+                // unwanted outputs are left with intermediate values
+                memset(output.get(i), 0, this->pkt_size * sizeof(T));
+            }
+        }
+    }
+
+    /**
+     * Encode symbols of 2 bytes on 16-bit lanes
+     *
+     * The only symbol of GF(65537) that does not fit in 16 bits, 65536, is
+     * rare: it is stored as 0 and marked, see `fft::Radix2::fft_narrow`, so
+     * that vectorized butterfly operations process twice as many symbols per
+     * register as on packed 32-bit symbols. Intermediate symbols of the
+     * systematic FNT are still decoded from packed symbols.
+     *
+     * It needs SIMD operations, other builds encode packed symbols.
+     */
+    bool encodes_unpacked() const override
+    {
+#ifdef QUADIRON_USE_SIMD
+        return sizeof(T) == sizeof(uint32_t) && this->word_size == 2;
+#else
+        return false;
+#endif
+    }
+
+    /**
+     * Encode unpacked symbols, see `encodes_unpacked`
+     *
+     * @param output must be n_outputs
+     * @param props must be exactly n_outputs
+     * @param offset used to locate special values
+     * @param words must be `ws.words_char`, viewed by the narrow words of `ws`
+     * @param ws workspace allocated by `make_workspace`
+     */
+    void encode_unpacked_ws(
+        vec::Buffers<uint8_t>& output,
+        std::vector<Properties>& props,
+        off_t offset,
+        vec::Buffers<uint8_t>& words,
+        Workspace<T>& ws) override
+    {
+        FntWorkspace& fws = get_fnt_ws(ws);
+        const std::vector<bool>& pruning = fws.pruning;
+        vec::Buffers<uint16_t>& codeword = *fws.narrow_codeword;
+        OorMarks& marks = *fws.narrow_marks;
+        auto radix2 = static_cast<fft::Radix2<T>*>(this->fft.get());
+
+        assert(words.get_mem() == ws.words_char.get_mem());
+
+        const unsigned first = first_output();
+        for (unsigned i = 0; i < this->n_outputs; ++i) {
+            codeword.set(first + i, reinterpret_cast<uint16_t*>(output.get(i)));
+        }
+        if (this->type == FecType::SYSTEMATIC) {
+            vec::pack<uint8_t, T>(
+                words.get_mem(),
+                ws.words.get_mem(),
+                this->n_data,
+                this->pkt_size,
+                this->word_size);
+            decode_data(*fws.context, *fws.inter_words, ws.words);
+            narrow(*fws.inter_words, *fws.narrow_inter, *fws.inter_marks);
+            // data symbols have been packed, their buffers are scratch memory
+            for (unsigned i = 0; i < this->n_data; ++i) {
+                codeword.set(i, fws.narrow_words->get(i));
+            }
+            radix2->fft_narrow(
+                codeword,
+                *fws.narrow_inter,
+                pruning,
+                marks,
+                fws.inter_marks.get());
+        } else {
+            radix2->fft_narrow(codeword, *fws.narrow_words, pruning, marks);
+        }
+        for (unsigned i = 0; i < this->n_outputs; ++i) {
+            if (pruning.empty() || ws.enc_wanted[i]) {
+                marks.get_props(first + i, props[i], offset);
+            } else {
+                // unwanted outputs are left with intermediate values
+                memset(output.get(i), 0, this->buf_size);
+            }
+        }
+    }
+
+    /**
+     * Store data symbols on 16 bits, marking the ones equal to `card - 1`
+     *
+     * @param src n_data buffers of symbols
+     * @param dest buffers of 16-bit symbols
+     * @param marks marks of `dest`
+     */
+    void narrow(
+        vec::Buffers<T>& src,
+        vec::Buffers<uint16_t>& dest,
+        OorMarks& marks)
+    {
+        const T thres = this->gf->card_minus_one();
+        for (unsigned i = 0; i < this->n_data; ++i) {
+            const T* s = src.get(i);
+            uint16_t* d = dest.get(i);
+            for (size_t j = 0; j < this->pkt_size; ++j) {
+                d[j] = narrow_cast<uint16_t>(s[j]);
+            }
+            marks.clear(i);
+            marks.detect(i, s, 0, this->pkt_size, thres);
+        }
+    }
+
+    /**
+     * Encode buffers with the systematic FNT
+     *
+     * @param output must be n_outputs
+     * @param words must be n_data
+     * @param inter intermediate symbols, decoded from words
+     * @param codeword n buffers whose first code_len are rebound to words and
+     * output
+     * @param context decoding context whose output is `inter`
+     * @param pruning flags of the needed codeword symbols, see
+     * `init_pruning`, or empty if all are needed
+     * @param scratch n_data buffers bound in place of words if the FFT is
+     * pruned, as it leaves data symbols with intermediate values
+     * @param marks marks of the out-of-range parities
+     */
+    void encode_systematic(
+        vec::Buffers<T>& output,
+        vec::Buffers<T>& words,
+        vec::Buffers<T>& inter,
+        vec::Buffers<T>& codeword,
+        DecodeContext<T>& context,
+        const std::vector<bool>& pruning,
+        vec::Buffers<T>& scratch,
+        OorMarks& marks)
+    {
+        decode_data(context, inter, words);
+        vec::Buffers<T>& data = pruning.empty() ? words : scratch;
+        for (unsigned i = 0; i < this->n_data; ++i) {
+            codeword.set(i, data.get(i));
+        }
+        for (unsigned i = 0; i < this->n_outputs; ++i) {
+            codeword.set(this->n_data + i, output.get(i));
+        }
+        fft_marked(codeword, inter, pruning, marks);
+    }
+
+    /** Compute the codeword by the FFT, marking out-of-range outputs
+     *
+     * @param codeword n buffers
+     * @param words input of the FFT
+     * @param pruning flags of the needed codeword symbols or empty if all
+     * are needed
+     * @param marks marks of the outputs
+     */
+    void fft_marked(
+        vec::Buffers<T>& codeword,
+        vec::Buffers<T>& words,
+        const std::vector<bool>& pruning,
+        OorMarks& marks)
+    {
+        auto radix2 = static_cast<fft::Radix2<T>*>(this->fft.get());
+        if (pruning.empty()) {
+            radix2->fft_marked(codeword, words, &marks);
+        } else {
+            radix2->fft_pruned(codeword, words, pruning, &marks);
         }
-        encode_post_process(output, props, offset);
+    }
+
+    // index of the first output in codewords
+    unsigned first_output() const
+    {
+        return (this->type == FecType::SYSTEMATIC) ? this->n_data : 0;
     }
 
     void encode_post_process(
@@ -267,6 +612,201 @@ class RsFnt : public FecCode<T> {
             }
         }
     }
+
+    /** Rebuild a single fragment from `n_data` available ones
+     *
+     * A fragment is the evaluation of a polynomial of degree lower than
+     * `n_data` at \f$x_d = r^d\f$, hence a linear combination of any
+     * `n_data` other fragments \f$x_i\f$, whose Lagrange coefficients are:
+     * \f[
+     *   \lambda_i = w_i \prod_{j \neq i} (x_d - x_j), \quad
+     *   w_i = \frac{1}{\prod_{j \neq i} (x_i - x_j)}
+     * \f]
+     * The weights \f$w_i\f$ only depend on the erasure pattern, they are
+     * kept in the context cache. The fragment is then computed packet by
+     * packet by a multiply-accumulate per available fragment, instead of
+     * decoding all data and encoding them again.
+     *
+     * @param data_bufs vector size must be exactly n_data, only used by
+     * systematic codes (set entries to nullptr when missing)
+     * @param parities_bufs vector size must be exactly n_outputs
+     * (set entries to nullptr when missing)
+     * @param parities_props vector size must be exactly n_outputs, the
+     * properties of a rebuilt parity are set
+     * @param missing_idxs array of missing indexes of vector size code_len
+     * indicating presence (value 0) or absence of fragments (value 1)
+     * @param destination_idx index of the fragment to rebuild, from 0 to
+     * code_len-1, its block MUST BE allocated by caller
+     * @param block_size_bytes the block size in bytes
+     * @param ws workspace allocated by `make_workspace`
+     *
+     * @return true if repair succeeded, false if fewer than n_data fragments
+     * are available
+     */
+    bool repair_blocks_vertical(
+        std::vector<uint8_t*>& data_bufs,
+        std::vector<uint8_t*>& parities_bufs,
+        std::vector<Properties>& parities_props,
+        std::vector<int>& missing_idxs,
+        unsigned destination_idx,
+        size_t block_size_bytes,
+        Workspace<T>& ws)
+    {
+        assert(destination_idx < this->code_len);
+        assert(parities_bufs.size() == this->n_outputs);
+        assert(parities_props.size() == this->n_outputs);
+
+        const unsigned n_data = this->n_data;
+        const bool systematic = (this->type == FecType::SYSTEMATIC);
+
+        // ids of used fragments, from 0 to codelen-1, data first
+        vec::Vector<T>& fragments_ids = ws.fragments_ids;
+        unsigned fragment_index = 0;
+        for (unsigned i = 0; i < this->code_len && fragment_index < n_data;
+             ++i) {
+            if (i != destination_idx && !missing_idxs[i]) {
+                fragments_ids.set(fragment_index, i);
+                fragment_index++;
+            }
+        }
+        // unable to repair
+        if (fragment_index < n_data) {
+            return false;
+        }
+
+        // blocks and properties of fragments, data of systematic codes have
+        // no properties
+        const auto block = [&](unsigned id) -> uint8_t* {
+            if (!systematic) {
+                return parities_bufs[id];
+            }
+            return (id < n_data) ? data_bufs[id] : parities_bufs[id - n_data];
+        };
+        Properties* output_props = nullptr;
+        if (!systematic) {
+            output_props = &parities_props[destination_idx];
+        } else if (destination_idx >= n_data) {
+            output_props = &parities_props[destination_idx - n_data];
+        }
+        if (output_props != nullptr) {
+            output_props->clear();
+        }
+
+        typename ContextCache<T>::Handle cached(
+            this->context_cache,
+            this->acquire_context(fragments_ids, parities_props));
+        vec::Vector<T>& coefs = ws.repair_coefs;
+        compute_repair_coefs(*cached, destination_idx, coefs);
+
+        const size_t pkt_size = this->pkt_size;
+        const size_t word_size = this->word_size;
+        const size_t block_size = block_size_bytes / word_size;
+        const T thres = this->gf->card() - 1;
+
+        const std::vector<uint8_t*>& words_mem_char = ws.words_char.get_mem();
+        vec::Buffers<T>& words = ws.words;
+        const std::vector<T*>& words_mem_T = words.get_mem();
+        // the first output buffer receives the rebuilt symbols
+        T* output = ws.enc_output.get(0);
+        const std::vector<T*>& output_mem_T = ws.enc_output.get_mem();
+        const std::vector<uint8_t*>& output_mem_char =
+            ws.enc_output_char.get_mem();
+        uint8_t* output_block = block(destination_idx);
+
+        for (size_t offset = 0; offset < block_size; offset += pkt_size) {
+            const size_t copy_size = std::min(pkt_size, block_size - offset);
+            for (unsigned i = 0; i < n_data; ++i) {
+                memcpy(
+                    words_mem_char[i],
+                    block(fragments_ids.get(i)) + offset * word_size,
+                    copy_size * word_size);
+            }
+
+            // Zero-out trailing part of data
+            if (copy_size < pkt_size) {
+                const size_t copy_bytes = copy_size * word_size;
+                const size_t trailing_bytes = this->buf_size - copy_bytes;
+                for (unsigned i = 0; i < n_data; i++) {
+                    memset(words_mem_char[i] + copy_bytes, 0, trailing_bytes);
+                }
+            }
+
+            vec::pack<uint8_t, T>(
+                words_mem_char, words_mem_T, n_data, pkt_size, word_size);
+
+            // restore out of range symbols
+            this->decode_prepare(
+                *cached->context, parities_props, offset, words);
+
+            std::fill_n(output, pkt_size, 0);
+            for (unsigned i = 0; i < n_data; ++i) {
+                this->gf->mul_coef_add_to_buf(
+                    coefs.get(i), words.get(i), output, pkt_size);
+            }
+
+            // check for out of range value in output
+            if (output_props != nullptr) {
+                for (size_t j = 0; j < copy_size; ++j) {
+                    if (output[j] & thres) {
+                        output_props->add(offset + j, OOR_MARK);
+                    }
+                }
+            }
+
+            vec::unpack<T, uint8_t>(
+                output_mem_T, output_mem_char, 1, pkt_size, word_size);
+            memcpy(
+                output_block + offset * word_size,
+                output_mem_char[0],
+                copy_size * word_size);
+        }
+
+        return true;
+    }
+
+  private:
+    /** Compute Lagrange coefficients of the fragments of a cached context
+     *
+     * @param entry cached context of used fragments, its weights are
+     * computed at first use
+     * @param destination_idx index of the fragment to rebuild
+     * @param coefs coefficients of the `n_data` used fragments
+     */
+    void compute_repair_coefs(
+        CachedContext<T>& entry,
+        unsigned destination_idx,
+        vec::Vector<T>& coefs)
+    {
+        const gf::Field<T>& gf = *(this->gf);
+        const vec::Vector<T>& ids = entry.fragments_ids;
+        const vec::Vector<T>& x = *(this->r_powers);
+        const unsigned k = this->n_data;
+
+        if (entry.repair_weights == nullptr) {
+            entry.repair_weights = std::make_unique<vec::Vector<T>>(gf, k);
+            for (unsigned i = 0; i < k; ++i) {
+                const T x_i = x.get(ids.get(i));
+                T prod = 1;
+                for (unsigned j = 0; j < k; ++j) {
+                    if (j != i) {
+                        prod = gf.mul(prod, gf.sub(x_i, x.get(ids.get(j))));
+                    }
+                }
+                entry.repair_weights->set(i, gf.inv(prod));
+            }
+        }
+
+        // A(x_d) = prod_j(x_d - x_j)
+        const T x_d = x.get(destination_idx);
+        T prod = 1;
+        for (unsigned j = 0; j < k; ++j) {
+            prod = gf.mul(prod, gf.sub(x_d, x.get(ids.get(j))));
+        }
+        for (unsigned i = 0; i < k; ++i) {
+            const T w_i = gf.mul(entry.repair_weights->get(i), prod);
+            coefs.set(i, gf.div(w_i, gf.sub(x_d, x.get(ids.get(i)))));
+        }
+    }
 };
 
 #ifdef QUADIRON_USE_SIMD
@@ -56,8 +56,14 @@ class RsGf2n : public FecCode<T> {
         unsigned word_size,
         unsigned n_data,
         unsigned n_parities,
-        RsMatrixType type)
-        : FecCode<T>(FecType::SYSTEMATIC, word_size, n_data, n_parities)
+        RsMatrixType type,
+        size_t pkt_size = 8)
+        : FecCode<T>(
+              FecType::SYSTEMATIC,
+              word_size,
+              n_data,
+              n_parities,
+              pkt_size)
     {
         mat_type = type;
         this->fec_init();
@@ -110,6 +116,15 @@ class RsGf2n : public FecCode<T> {
         mat->mul(&output, &words);
     }
 
+    void encode(
+        vec::Buffers<T>& output,
+        std::vector<Properties>&,
+        off_t,
+        vec::Buffers<T>& words) override
+    {
+        mat->mul(&output, &words);
+    }
+
     void decode_add_data(int fragment_index, int row) override
     {
         // for each data available generate the corresponding identity
@@ -144,6 +159,16 @@ class RsGf2n : public FecCode<T> {
         decode_mat->mul(&output, &words);
     }
 
+    void decode(
+        DecodeContext<T>&,
+        vec::Buffers<T>& output,
+        const std::vector<Properties>&,
+        off_t,
+        vec::Buffers<T>& words) override
+    {
+        decode_mat->mul(&output, &words);
+    }
+
     std::unique_ptr<DecodeContext<T>> init_context_dec(
         vec::Vector<T>&,
         std::vector<Properties>&,
@@ -32,15 +32,20 @@
 #define __QUAD_FEC_RS_GF2N_FFT_H__
 
 #include "fec_base.h"
-#include "fft_ct.h"
+#include "fft_planner.h"
 #include "gf_bin_ext.h"
+#include "vec_buffers.h"
 #include "vec_vector.h"
 #include "vec_zero_ext.h"
 
 namespace quadiron {
 namespace fec {
 
-/** Reed-Solomon (RS) Erasure code over GF(2<sup>n</sup>)using FFT. */
+/** Reed-Solomon (RS) Erasure code over GF(2<sup>n</sup>)using FFT.
+ *
+ * Buffers are encoded and decoded packet-wise by the Buffers transforms of
+ * the FFTs, which are chosen by `fft::Planner`.
+ */
 template <typename T>
 class RsGf2nFft : public FecCode<T> {
   public:
@@ -48,8 +53,17 @@ class RsGf2nFft : public FecCode<T> {
     using FecCode<T>::encode;
 
     // NOTE: only NON_SYSTEMATIC is supported now
-    RsGf2nFft(unsigned word_size, unsigned n_data, unsigned n_parities)
-        : FecCode<T>(FecType::NON_SYSTEMATIC, word_size, n_data, n_parities)
+    RsGf2nFft(
+        unsigned word_size,
+        unsigned n_data,
+        unsigned n_parities,
+        size_t pkt_size = 8)
+        : FecCode<T>(
+              FecType::NON_SYSTEMATIC,
+              word_size,
+              n_data,
+              n_parities,
+              pkt_size)
     {
         this->fec_init();
     }
@@ -76,12 +90,11 @@ class RsGf2nFft : public FecCode<T> {
         // compute root of order n such as r^n == 1
         this->r = this->gf->get_nth_root(this->n);
 
-        this->fft = std::unique_ptr<fft::CooleyTukey<T>>(
-            new fft::CooleyTukey<T>(*(this->gf), this->n));
+        fft::Planner<T>& planner = fft::Planner<T>::get();
+        this->fft = planner.plan(*(this->gf), this->n, this->pkt_size);
 
         unsigned len_2k = this->gf->get_code_len_high_compo(2 * this->n_data);
-        this->fft_2k = std::unique_ptr<fft::CooleyTukey<T>>(
-            new fft::CooleyTukey<T>(*(this->gf), len_2k));
+        this->fft_2k = planner.plan(*(this->gf), len_2k, this->pkt_size);
     }
 
     inline void init_others() override
@@ -101,6 +114,11 @@ class RsGf2nFft : public FecCode<T> {
         }
     }
 
+    inline void init_workspace(Workspace<T>& ws) override
+    {
+        ws.ext = std::make_unique<FftWorkspace<T>>(this->fft->make_scratch());
+    }
+
     int get_n_outputs() override
     {
         return this->n;
@@ -121,6 +139,30 @@ class RsGf2nFft : public FecCode<T> {
         this->fft->fft(output, vwords);
     }
 
+    /** Encode buffers.
+     *
+     * @param output must be n
+     * @param words must be n_data
+     */
+    void encode(
+        vec::Buffers<T>& output,
+        std::vector<Properties>&,
+        off_t,
+        vec::Buffers<T>& words) override
+    {
+        this->fft->fft(output, words);
+    }
+
+    void encode_ws(
+        vec::Buffers<T>& output,
+        std::vector<Properties>&,
+        off_t,
+        vec::Buffers<T>& words,
+        Workspace<T>& ws) override
+    {
+        this->fft->fft_ws(output, words, FftWorkspace<T>::get(ws));
+    }
+
     void decode_add_data(int, int) override
     {
         // not applicable
@@ -135,6 +177,15 @@ class RsGf2nFft : public FecCode<T> {
     {
         // nothing to do
     }
+
+    void decode_prepare(
+        DecodeContext<T>&,
+        const std::vector<Properties>&,
+        off_t,
+        vec::Buffers<T>&) override
+    {
+        // nothing to do
+    }
 };
 
 } // namespace fec
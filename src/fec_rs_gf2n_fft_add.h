@@ -31,17 +31,25 @@
 #ifndef __QUAD_FEC_RS_GF2N_FFT_ADD_H__
 #define __QUAD_FEC_RS_GF2N_FFT_ADD_H__
 
+#include <algorithm>
+#include <vector>
+
 #include "arith.h"
 #include "fec_base.h"
 #include "fft_add.h"
 #include "gf_bin_ext.h"
+#include "vec_buffers.h"
 #include "vec_vector.h"
 #include "vec_zero_ext.h"
 
 namespace quadiron {
 namespace fec {
 
-/** Reed-Solomon (RS) Erasure code over GF(2<sup>n</sup>) using additive FFT. */
+/** Reed-Solomon (RS) Erasure code over GF(2<sup>n</sup>) using additive FFT.
+ *
+ * Buffers are encoded by the Buffers transform of `fft::Additive` and
+ * decoded by products of whole packets.
+ */
 template <typename T>
 class RsGf2nFftAdd : public FecCode<T> {
   public:
@@ -50,8 +58,17 @@ class RsGf2nFftAdd : public FecCode<T> {
     using FecCode<T>::encode;
 
     // NOTE: only NON_SYSTEMATIC is supported now
-    RsGf2nFftAdd(unsigned word_size, unsigned n_data, unsigned n_parities)
-        : FecCode<T>(FecType::NON_SYSTEMATIC, word_size, n_data, n_parities)
+    RsGf2nFftAdd(
+        unsigned word_size,
+        unsigned n_data,
+        unsigned n_parities,
+        size_t pkt_size = 8)
+        : FecCode<T>(
+              FecType::NON_SYSTEMATIC,
+              word_size,
+              n_data,
+              n_parities,
+              pkt_size)
     {
         this->fec_init();
     }
@@ -76,8 +93,8 @@ class RsGf2nFftAdd : public FecCode<T> {
 
         T m = arith::log2<T>(this->n);
 
-        this->fft = std::unique_ptr<fft::Additive<T>>(
-            new fft::Additive<T>(*(this->gf), m));
+        this->fft = std::unique_ptr<fft::Additive<T>>(new fft::Additive<T>(
+            *(this->gf), m, nullptr, this->pkt_size));
     }
 
     inline void init_others() override
@@ -88,6 +105,11 @@ class RsGf2nFftAdd : public FecCode<T> {
         this->fft->compute_B(*betas);
     }
 
+    inline void init_workspace(Workspace<T>& ws) override
+    {
+        ws.ext = std::make_unique<FftWorkspace<T>>(this->fft->make_scratch());
+    }
+
     int get_n_outputs() override
     {
         return this->n;
@@ -108,6 +130,30 @@ class RsGf2nFftAdd : public FecCode<T> {
         this->fft->fft(output, vwords);
     }
 
+    /** Encode buffers.
+     *
+     * @param output must be n
+     * @param words must be n_data
+     */
+    void encode(
+        vec::Buffers<T>& output,
+        std::vector<Properties>&,
+        off_t,
+        vec::Buffers<T>& words) override
+    {
+        this->fft->fft(output, words);
+    }
+
+    void encode_ws(
+        vec::Buffers<T>& output,
+        std::vector<Properties>&,
+        off_t,
+        vec::Buffers<T>& words,
+        Workspace<T>& ws) override
+    {
+        this->fft->fft_ws(output, words, FftWorkspace<T>::get(ws));
+    }
+
     void decode_add_data(int, int) override
     {
         // not applicable
@@ -121,8 +167,8 @@ class RsGf2nFftAdd : public FecCode<T> {
     std::unique_ptr<DecodeContext<T>> init_context_dec(
         vec::Vector<T>& fragments_ids,
         std::vector<Properties>& input_props,
-        size_t,
-        vec::Buffers<T>*) override
+        size_t size,
+        vec::Buffers<T>* output) override
     {
         if (this->betas == nullptr) {
             throw LogicError("FEC FFT ADD: vector 'betas' must be initialized");
@@ -154,7 +200,9 @@ class RsGf2nFftAdd : public FecCode<T> {
                 vx,
                 this->n_data,
                 this->n,
-                vx_zero));
+                vx_zero,
+                size,
+                output));
 
         return context;
     }
@@ -168,6 +216,15 @@ class RsGf2nFftAdd : public FecCode<T> {
         // nothing to do
     }
 
+    void decode_prepare(
+        DecodeContext<T>&,
+        const std::vector<Properties>&,
+        off_t,
+        vec::Buffers<T>&) override
+    {
+        // nothing to do
+    }
+
     void decode_apply(
         DecodeContext<T>& context,
         vec::Vector<T>& output,
@@ -232,6 +289,74 @@ class RsGf2nFftAdd : public FecCode<T> {
             output.set(i, S.get(i));
     }
 
+    /**
+     * Perform the interpolation of `decode_apply` on buffers
+     *
+     * Coefficients are computed once per call, the products and sums being
+     * done on whole packets.
+     */
+    void decode_apply(
+        DecodeContext<T>& context,
+        vec::Buffers<T>& output,
+        vec::Buffers<T>& words) override
+    {
+        const vec::Vector<T>& fragments_ids = context.get_fragments_id();
+        vec::Poly<T>& A = context.get_poly(CtxPoly::A);
+        vec::Vector<T>& inv_A_i = context.get_vector(CtxVec::INV_A_I);
+        vec::Buffers<T>& buf1_k = context.get_buffer(CtxBuf::K1);
+        vec::Buffers<T>& buf1_2k = context.get_buffer(CtxBuf::B2K1);
+        const std::vector<T*>& n_mem = buf1_k.get_mem();
+        const std::vector<T*>& o_mem = output.get_mem();
+        const size_t size = output.get_size();
+
+        int k = this->n_data; // number of fragments received
+        int vx_zero = context.vx_zero;
+
+        // compute N'(x) = sum_i{n_i * x^z_i}
+        // where n_i=v_i/A'_i(x_i)
+        this->gf->mul_vec_to_vecp(inv_A_i, words, buf1_k);
+
+        // S_j = sum_{i != vx_zero}(n_i * x_i^(-j)) as in the vector version,
+        // stored in the buffers following `buf1_k`
+        vec::Buffers<T> S(buf1_2k, k, 2 * k);
+        const std::vector<T*>& s_mem = S.get_mem();
+        S.zero_fill();
+        // inverses of x_i and their powers
+        std::vector<T> inv_x(k, 0);
+        std::vector<T> coefs(k, 1);
+        for (int i = 0; i < k; ++i) {
+            if (i != vx_zero) {
+                inv_x[i] = this->gf->inv(betas->get(fragments_ids.get(i)));
+            }
+        }
+        for (int j = 0; j < k; j++) {
+            for (int i = 0; i < k; ++i) {
+                if (i == vx_zero)
+                    continue;
+                this->gf->mul_coef_add_to_buf(
+                    coefs[i], n_mem[i], s_mem[j], size);
+                coefs[i] = this->gf->mul(coefs[i], inv_x[i]);
+            }
+        }
+
+        // output = A(x)*S(x) mod x^k
+        for (int t = 0; t < k; t++) {
+            std::fill_n(o_mem[t], size, 0);
+            for (int j = 0; j <= t; j++) {
+                this->gf->mul_coef_add_to_buf(
+                    A.get(t - j), s_mem[j], o_mem[t], size);
+            }
+        }
+        if (vx_zero > -1) {
+            // P(x) = A(x)*S(x) + _n[vx_zero] * A(x) / x
+            const int deg = std::min(A.get_deg(), k);
+            for (int i = 1; i <= deg; ++i) {
+                this->gf->mul_coef_add_to_buf(
+                    A.get(i), n_mem[vx_zero], o_mem[i - 1], size);
+            }
+        }
+    }
+
   private:
     // this overwrite multiplicative FFT
     std::unique_ptr<fft::Additive<T>> fft = nullptr;
@@ -33,10 +33,10 @@
 
 #include "arith.h"
 #include "fec_base.h"
-#include "fft_2n.h"
 #include "fft_base.h"
-#include "fft_ct.h"
+#include "fft_planner.h"
 #include "gf_prime.h"
+#include "vec_buffers.h"
 #include "vec_vector.h"
 #include "vec_zero_ext.h"
 
@@ -69,6 +69,9 @@ namespace fec {
  *    Y[i] = Y<sub>p</sub>[i] + 2<sup>8*word_size</sup>
  *
  * Because p < 2 * 2<sup>8*word_size</sup>, a single bool is enough as flag.
+ *
+ * Buffers are encoded and decoded packet-wise by the Buffers transforms of
+ * the FFTs, which are chosen by `fft::Planner`.
  */
 template <typename T>
 class RsGfpFft : public FecCode<T> {
@@ -77,8 +80,17 @@ class RsGfpFft : public FecCode<T> {
     using FecCode<T>::encode_post_process;
     using FecCode<T>::encode;
 
-    RsGfpFft(unsigned word_size, unsigned n_data, unsigned n_parities)
-        : FecCode<T>(FecType::NON_SYSTEMATIC, word_size, n_data, n_parities)
+    RsGfpFft(
+        unsigned word_size,
+        unsigned n_data,
+        unsigned n_parities,
+        size_t pkt_size = 8)
+        : FecCode<T>(
+              FecType::NON_SYSTEMATIC,
+              word_size,
+              n_data,
+              n_parities,
+              pkt_size)
     {
         this->fec_init();
     }
@@ -121,22 +133,11 @@ class RsGfpFft : public FecCode<T> {
         // compute root of order n-1 such as r^(n-1) mod q == 1
         this->r = this->gf->get_nth_root(this->n);
 
-        if (arith::is_power_of_2<T>(this->n)) {
-            this->fft = std::unique_ptr<fft::Radix2<T>>(
-                new fft::Radix2<T>(*(this->gf), this->n));
-        } else {
-            this->fft = std::unique_ptr<fft::CooleyTukey<T>>(
-                new fft::CooleyTukey<T>(*(this->gf), this->n));
-        }
+        fft::Planner<T>& planner = fft::Planner<T>::get();
+        this->fft = planner.plan(*(this->gf), this->n, this->pkt_size);
 
         unsigned len_2k = this->gf->get_code_len_high_compo(2 * this->n_data);
-        if (arith::is_power_of_2<T>(len_2k)) {
-            this->fft_2k = std::unique_ptr<fft::Radix2<T>>(
-                new fft::Radix2<T>(*(this->gf), len_2k, len_2k));
-        } else {
-            this->fft_2k = std::unique_ptr<fft::CooleyTukey<T>>(
-                new fft::CooleyTukey<T>(*(this->gf), len_2k, len_2k));
-        }
+        this->fft_2k = planner.plan(*(this->gf), len_2k, this->pkt_size);
     }
 
     inline void init_others() override
@@ -156,6 +157,11 @@ class RsGfpFft : public FecCode<T> {
         }
     }
 
+    inline void init_workspace(Workspace<T>& ws) override
+    {
+        ws.ext = std::make_unique<FftWorkspace<T>>(this->fft->make_scratch());
+    }
+
     int get_n_outputs() override
     {
         return this->n;
@@ -194,6 +200,53 @@ class RsGfpFft : public FecCode<T> {
         }
     }
 
+    /**
+     * Encode buffers
+     *
+     * @param output must be n
+     * @param props must be exactly n
+     * @param offset used to locate special values
+     * @param words must be n_data
+     */
+    void encode(
+        vec::Buffers<T>& output,
+        std::vector<Properties>& props,
+        off_t offset,
+        vec::Buffers<T>& words) override
+    {
+        this->fft->fft(output, words);
+        encode_post_process(output, props, offset);
+    }
+
+    void encode_ws(
+        vec::Buffers<T>& output,
+        std::vector<Properties>& props,
+        off_t offset,
+        vec::Buffers<T>& words,
+        Workspace<T>& ws) override
+    {
+        this->fft->fft_ws(output, words, FftWorkspace<T>::get(ws));
+        encode_post_process(output, props, offset);
+    }
+
+    void encode_post_process(
+        vec::Buffers<T>& output,
+        std::vector<Properties>& props,
+        off_t offset) override
+    {
+        // check for out of range value in output
+        const size_t size = output.get_size();
+        for (unsigned i = 0; i < this->code_len; i++) {
+            T* chunk = output.get(i);
+            for (size_t j = 0; j < size; j++) {
+                if (chunk[j] >= this->limit_value) {
+                    props[i].add(offset + j, OOR_MARK);
+                    chunk[j] %= this->limit_value;
+                }
+            }
+        }
+    }
+
     void decode_add_data(int, int) override
     {
         // not applicable
@@ -229,6 +282,29 @@ class RsGfpFft : public FecCode<T> {
             }
         }
     }
+
+    void decode_prepare(
+        DecodeContext<T>& context,
+        const std::vector<Properties>& props,
+        off_t offset,
+        vec::Buffers<T>& words) override
+    {
+        const vec::Vector<T>& fragments_ids = context.get_fragments_id();
+        const off_t offset_max = offset + this->pkt_size;
+        for (unsigned i = 0; i < this->n_data; ++i) {
+            const unsigned j = fragments_ids.get(i);
+            T* chunk = words.get(i);
+            // restore the marked symbols of the packet
+            while (props[j].in_range(
+                context.props_indices.at(j), offset, offset_max)) {
+                const size_t loc = props[j].location(context.props_indices[j]);
+                if (props[j].marker(context.props_indices[j]) == OOR_MARK) {
+                    chunk[loc - offset] += limit_value;
+                }
+                context.props_indices.at(j)++;
+            }
+        }
+    }
 };
 
 } // namespace fec
@@ -43,29 +43,52 @@
 namespace quadiron {
 namespace fec {
 
+namespace {
+
+/** Add the out-of-range symbols of packets to their properties
+ *
+ * The vectorized kernel only marks the symbols in `OorMarks`, which are then
+ * converted here, so that the per-ISA kernels do not handle properties.
+ */
+template <typename T>
+void add_oor_props(
+    vec::Buffers<T>& output,
+    std::vector<Properties>& props,
+    off_t offset,
+    unsigned code_len,
+    T card,
+    size_t vec_len,
+    size_t trailing_offset)
+{
+    const size_t size = output.get_size();
+    const T threshold = card - 1;
+    OorMarks marks(0, code_len, size, sizeof(T));
+
+    simd::kernels<T>().encode_post_process(
+        output, marks, code_len, card, vec_len);
+
+    for (unsigned i = 0; i < code_len; ++i) {
+        marks.detect(i, output.get(i), trailing_offset, size, threshold);
+        marks.get_props(i, props[i], offset);
+    }
+}
+
+} // namespace
+
 template <>
 void RsFnt<uint16_t>::encode_post_process(
     vec::Buffers<uint16_t>& output,
     std::vector<Properties>& props,
     off_t offset)
 {
-    size_t size = this->pkt_size;
-    uint16_t threshold = this->gf->card_minus_one();
-    unsigned code_len = this->n_outputs;
-
-    simd::encode_post_process(
-        output, props, offset, code_len, threshold, simd_vec_len);
-
-    if (simd_trailing_len > 0) {
-        for (unsigned i = 0; i < code_len; ++i) {
-            uint16_t* chunk = output.get(i);
-            for (size_t j = simd_offset; j < size; ++j) {
-                if (chunk[j] == threshold) {
-                    props[i].add(offset + j, OOR_MARK);
-                }
-            }
-        }
-    }
+    add_oor_props(
+        output,
+        props,
+        offset,
+        this->n_outputs,
+        this->gf->card(),
+        simd_vec_len,
+        simd_offset);
 }
 
 template <>
@@ -74,23 +97,14 @@ void RsFnt<uint32_t>::encode_post_process(
     std::vector<Properties>& props,
     off_t offset)
 {
-    const size_t size = this->pkt_size;
-    const uint32_t threshold = this->gf->card_minus_one();
-    const unsigned code_len = this->n_outputs;
-
-    simd::encode_post_process(
-        output, props, offset, code_len, threshold, simd_vec_len);
-
-    if (simd_trailing_len > 0) {
-        for (unsigned i = 0; i < code_len; ++i) {
-            uint32_t* chunk = output.get(i);
-            for (size_t j = simd_offset; j < size; ++j) {
-                if (chunk[j] == threshold) {
-                    props[i].add(offset + j, OOR_MARK);
-                }
-            }
-        }
-    }
+    add_oor_props(
+        output,
+        props,
+        offset,
+        this->n_outputs,
+        this->gf->card(),
+        simd_vec_len,
+        simd_offset);
 }
 
 } // namespace fec
@@ -0,0 +1,164 @@
+/* -*- mode: c++ -*- */
+/*
+ * Copyright 2017-2018 Scality
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its contributors
+ *    may be used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+#ifndef __QUAD_FEC_WORKSPACE_H__
+#define __QUAD_FEC_WORKSPACE_H__
+
+#include <cstdint>
+#include <memory>
+#include <utility>
+#include <vector>
+
+#include "fft_base.h"
+#include "gf_base.h"
+#include "property.h"
+#include "vec_buffers.h"
+#include "vec_vector.h"
+
+namespace quadiron {
+namespace fec {
+
+/** Codec specific scratch memory of a workspace
+ *
+ * Codecs derive it with the buffers they need and attach it to workspaces in
+ * `FecCode::init_workspace`.
+ */
+class WorkspaceExt {
+  public:
+    virtual ~WorkspaceExt() = default;
+};
+
+/** Scratch memory used to encode or decode blocks packet by packet
+ *
+ * A workspace is allocated once for a given codec (see
+ * `FecCode::make_workspace`) and can then be passed to every call of
+ * `encode_blocks_vertical` and `decode_blocks_vertical`, so that no memory is
+ * allocated in the steady state.
+ *
+ * Decoding contexts are not part of it, they are kept by the code (see
+ * `ContextCache`).
+ *
+ * A workspace is the per-thread part of a code: threads sharing a code must
+ * each use their own workspace.
+ *
+ * @note A workspace must not be used by several threads at the same time.
+ */
+template <typename T>
+class Workspace {
+  public:
+    Workspace(
+        const gf::Field<T>& gf,
+        unsigned n_data,
+        unsigned n_outputs,
+        size_t pkt_size,
+        size_t buf_size)
+        : words_char(n_data, buf_size), words(n_data, pkt_size),
+          enc_output(n_outputs, pkt_size), enc_output_char(n_outputs, buf_size),
+          dec_output_char(n_data, buf_size), fragments_ids(gf, n_data),
+          avail_parity_ids(gf, n_data), repair_coefs(gf, n_data)
+    {
+    }
+
+    Workspace(const Workspace&) = delete;
+    Workspace& operator=(const Workspace&) = delete;
+
+    void reset_stats_enc()
+    {
+        total_encode_cycles = 0;
+        n_encode_ops = 0;
+        total_enc_usec = 0;
+    }
+
+    void reset_stats_dec()
+    {
+        total_decode_cycles = 0;
+        n_decode_ops = 0;
+        total_dec_usec = 0;
+    }
+
+    // packed data read from blocks
+    vec::Buffers<uint8_t> words_char;
+    vec::Buffers<T> words;
+    // encoded symbols and their unpacked version
+    vec::Buffers<T> enc_output;
+    vec::Buffers<uint8_t> enc_output_char;
+    // unpacked decoded symbols
+    vec::Buffers<uint8_t> dec_output_char;
+    // ids of received fragments, from 0 to codelen-1
+    vec::Vector<T> fragments_ids;
+    // ids of received parities
+    vec::Vector<T> avail_parity_ids;
+    // coefficients of received fragments in a repaired one
+    vec::Vector<T> repair_coefs;
+
+    // outputs wanted by the last encoding, see `FecCode::init_pruning`
+    std::vector<bool> enc_wanted;
+    // codec specific scratch memory, see `FecCode::init_workspace`
+    std::unique_ptr<WorkspaceExt> ext = nullptr;
+
+    // workspaces and properties of the additional threads used in encoding
+    std::vector<std::unique_ptr<Workspace<T>>> workers;
+    std::vector<std::vector<Properties>> workers_props;
+
+    // statistics of the last encoding and decoding done with this workspace
+    uint64_t total_encode_cycles = 0;
+    uint64_t n_encode_ops = 0;
+    uint64_t total_enc_usec = 0;
+    uint64_t total_decode_cycles = 0;
+    uint64_t n_decode_ops = 0;
+    uint64_t total_dec_usec = 0;
+};
+
+/** Scratch memory of the Buffers transforms of the FFT of a code
+ *
+ * Codecs encoding by a FFT attach it to workspaces, so that threads sharing
+ * the FFT each compute with their own scratch memory.
+ */
+template <typename T>
+class FftWorkspace : public WorkspaceExt {
+  public:
+    explicit FftWorkspace(std::unique_ptr<fft::Scratch<T>> scratch)
+        : scratch(std::move(scratch))
+    {
+    }
+
+    /** Get the scratch memory attached to a workspace */
+    static fft::Scratch<T>& get(Workspace<T>& ws)
+    {
+        return *static_cast<FftWorkspace<T>&>(*ws.ext).scratch;
+    }
+
+    std::unique_ptr<fft::Scratch<T>> scratch;
+};
+
+} // namespace fec
+} // namespace quadiron
+
+#endif
@@ -46,7 +46,8 @@ template <>
 void Radix2<uint16_t>::butterfly_ct_two_layers_step(
     vec::Buffers<uint16_t>& buf,
     unsigned start,
-    unsigned m)
+    unsigned m,
+    OorMarks* marks)
 {
     const unsigned coefIndex = start * this->n / m / 2;
     const uint16_t r1 = vec_W[coefIndex];
@@ -54,12 +55,34 @@ void Radix2<uint16_t>::butterfly_ct_two_layers_step(
     const uint16_t r3 = vec_W[coefIndex / 2 + this->n / 4];
 
     // perform vector operations
-    simd::butterfly_ct_two_layers_step(
-        buf, r1, r2, r3, start, m, simd_vec_len, card);
+    simd::kernels<uint16_t>().butterfly_ct_two_layers_step(
+        buf, r1, r2, r3, start, m, simd_vec_len, card, marks);
 
     // for last elements, perform as non-SIMD method
     if (simd_trailing_len > 0) {
-        butterfly_ct_two_layers_step_slow(buf, start, m, simd_offset);
+        butterfly_ct_two_layers_step_slow(buf, start, m, simd_offset, marks);
+    }
+}
+
+template <>
+void Radix2<uint16_t>::butterfly_ct_layers_step(
+    vec::Buffers<uint16_t>& buf,
+    unsigned start,
+    unsigned m,
+    unsigned depth,
+    OorMarks* marks)
+{
+    uint16_t coefs[(1U << FFT_MAX_CODELET_DEPTH) - 1];
+    codelet_coefs(vec_W, start, m, depth, coefs);
+
+    // perform vector operations
+    simd::kernels<uint16_t>().butterfly_ct_layers_step(
+        buf, coefs, depth, start, m, simd_vec_len, card, marks);
+
+    // for last elements, perform as non-SIMD method
+    if (simd_trailing_len > 0) {
+        butterfly_ct_layers_step_slow(
+            buf, start, m, depth, simd_offset, marks);
     }
 }
 
@@ -69,14 +92,35 @@ void Radix2<uint16_t>::butterfly_ct_step(
     uint16_t r,
     unsigned start,
     unsigned m,
-    unsigned step)
+    unsigned step,
+    OorMarks* marks)
 {
     // perform vector operations
-    simd::butterfly_ct_step(buf, r, start, m, step, simd_vec_len, card);
+    simd::kernels<uint16_t>().butterfly_ct_step(
+        buf, r, start, m, step, simd_vec_len, card, marks);
 
     // for last elements, perform as non-SIMD method
     if (simd_trailing_len > 0) {
-        butterfly_ct_step_slow(buf, r, start, m, step, simd_offset);
+        butterfly_ct_step_slow(buf, r, start, m, step, simd_offset, marks);
+    }
+}
+
+template <>
+void Radix2<uint16_t>::butterfly_ct_step_top(
+    vec::Buffers<uint16_t>& buf,
+    uint16_t r,
+    unsigned start,
+    unsigned m,
+    unsigned step,
+    OorMarks* marks)
+{
+    // perform vector operations
+    simd::kernels<uint16_t>().butterfly_ct_step_top(
+        buf, r, start, m, step, simd_vec_len, card, marks);
+
+    // for last elements, perform as non-SIMD method
+    if (simd_trailing_len > 0) {
+        butterfly_ct_step_top_slow(buf, r, start, m, step, simd_offset, marks);
     }
 }
 
@@ -89,7 +133,8 @@ void Radix2<uint16_t>::butterfly_gs_step(
     unsigned step)
 {
     // perform vector operations
-    simd::butterfly_gs_step(buf, coef, start, m, simd_vec_len, card);
+    simd::kernels<uint16_t>().butterfly_gs_step(
+        buf, coef, start, m, step, simd_vec_len, card);
 
     // for last elements, perform as non-SIMD method
     if (simd_trailing_len > 0) {
@@ -97,6 +142,26 @@ void Radix2<uint16_t>::butterfly_gs_step(
     }
 }
 
+template <>
+void Radix2<uint16_t>::butterfly_gs_layers_step(
+    vec::Buffers<uint16_t>& buf,
+    unsigned start,
+    unsigned m,
+    unsigned depth)
+{
+    uint16_t coefs[(1U << FFT_MAX_CODELET_DEPTH) - 1];
+    codelet_coefs(inv_W->get_mem(), start, m, depth, coefs);
+
+    // perform vector operations
+    simd::kernels<uint16_t>().butterfly_gs_layers_step(
+        buf, coefs, depth, start, m, simd_vec_len, card);
+
+    // for last elements, perform as non-SIMD method
+    if (simd_trailing_len > 0) {
+        butterfly_gs_layers_step_slow(buf, start, m, depth, simd_offset);
+    }
+}
+
 template <>
 void Radix2<uint16_t>::butterfly_gs_step_simple(
     vec::Buffers<uint16_t>& buf,
@@ -106,7 +171,8 @@ void Radix2<uint16_t>::butterfly_gs_step_simple(
     unsigned step)
 {
     // perform vector operations
-    simd::butterfly_gs_step_simple(buf, coef, start, m, simd_vec_len, card);
+    simd::kernels<uint16_t>().butterfly_gs_step_simple(
+        buf, coef, start, m, step, simd_vec_len, card);
 
     // for last elements, perform as non-SIMD method
     if (simd_trailing_len > 0) {
@@ -118,7 +184,8 @@ template <>
 void Radix2<uint32_t>::butterfly_ct_two_layers_step(
     vec::Buffers<uint32_t>& buf,
     unsigned start,
-    unsigned m)
+    unsigned m,
+    OorMarks* marks)
 {
     const unsigned coefIndex = start * this->n / m / 2;
     const uint32_t r1 = vec_W[coefIndex];
@@ -126,12 +193,34 @@ void Radix2<uint32_t>::butterfly_ct_two_layers_step(
     const uint32_t r3 = vec_W[coefIndex / 2 + this->n / 4];
 
     // perform vector operations
-    simd::butterfly_ct_two_layers_step(
-        buf, r1, r2, r3, start, m, simd_vec_len, card);
+    simd::kernels<uint32_t>().butterfly_ct_two_layers_step(
+        buf, r1, r2, r3, start, m, simd_vec_len, card, marks);
+
+    // for last elements, perform as non-SIMD method
+    if (simd_trailing_len > 0) {
+        butterfly_ct_two_layers_step_slow(buf, start, m, simd_offset, marks);
+    }
+}
+
+template <>
+void Radix2<uint32_t>::butterfly_ct_layers_step(
+    vec::Buffers<uint32_t>& buf,
+    unsigned start,
+    unsigned m,
+    unsigned depth,
+    OorMarks* marks)
+{
+    uint32_t coefs[(1U << FFT_MAX_CODELET_DEPTH) - 1];
+    codelet_coefs(vec_W, start, m, depth, coefs);
+
+    // perform vector operations
+    simd::kernels<uint32_t>().butterfly_ct_layers_step(
+        buf, coefs, depth, start, m, simd_vec_len, card, marks);
 
     // for last elements, perform as non-SIMD method
     if (simd_trailing_len > 0) {
-        butterfly_ct_two_layers_step_slow(buf, start, m, simd_offset);
+        butterfly_ct_layers_step_slow(
+            buf, start, m, depth, simd_offset, marks);
     }
 }
 
@@ -141,14 +230,35 @@ void Radix2<uint32_t>::butterfly_ct_step(
     uint32_t r,
     unsigned start,
     unsigned m,
-    unsigned step)
+    unsigned step,
+    OorMarks* marks)
 {
     // perform vector operations
-    simd::butterfly_ct_step(buf, r, start, m, step, simd_vec_len, card);
+    simd::kernels<uint32_t>().butterfly_ct_step(
+        buf, r, start, m, step, simd_vec_len, card, marks);
 
     // for last elements, perform as non-SIMD method
     if (simd_trailing_len > 0) {
-        butterfly_ct_step_slow(buf, r, start, m, step, simd_offset);
+        butterfly_ct_step_slow(buf, r, start, m, step, simd_offset, marks);
+    }
+}
+
+template <>
+void Radix2<uint32_t>::butterfly_ct_step_top(
+    vec::Buffers<uint32_t>& buf,
+    uint32_t r,
+    unsigned start,
+    unsigned m,
+    unsigned step,
+    OorMarks* marks)
+{
+    // perform vector operations
+    simd::kernels<uint32_t>().butterfly_ct_step_top(
+        buf, r, start, m, step, simd_vec_len, card, marks);
+
+    // for last elements, perform as non-SIMD method
+    if (simd_trailing_len > 0) {
+        butterfly_ct_step_top_slow(buf, r, start, m, step, simd_offset, marks);
     }
 }
 
@@ -161,7 +271,8 @@ void Radix2<uint32_t>::butterfly_gs_step(
     unsigned step)
 {
     // perform vector operations
-    simd::butterfly_gs_step(buf, coef, start, m, simd_vec_len, card);
+    simd::kernels<uint32_t>().butterfly_gs_step(
+        buf, coef, start, m, step, simd_vec_len, card);
 
     // for last elements, perform as non-SIMD method
     if (simd_trailing_len > 0) {
@@ -169,6 +280,26 @@ void Radix2<uint32_t>::butterfly_gs_step(
     }
 }
 
+template <>
+void Radix2<uint32_t>::butterfly_gs_layers_step(
+    vec::Buffers<uint32_t>& buf,
+    unsigned start,
+    unsigned m,
+    unsigned depth)
+{
+    uint32_t coefs[(1U << FFT_MAX_CODELET_DEPTH) - 1];
+    codelet_coefs(inv_W->get_mem(), start, m, depth, coefs);
+
+    // perform vector operations
+    simd::kernels<uint32_t>().butterfly_gs_layers_step(
+        buf, coefs, depth, start, m, simd_vec_len, card);
+
+    // for last elements, perform as non-SIMD method
+    if (simd_trailing_len > 0) {
+        butterfly_gs_layers_step_slow(buf, start, m, depth, simd_offset);
+    }
+}
+
 template <>
 void Radix2<uint32_t>::butterfly_gs_step_simple(
     vec::Buffers<uint32_t>& buf,
@@ -178,7 +309,8 @@ void Radix2<uint32_t>::butterfly_gs_step_simple(
     unsigned step)
 {
     // perform vector operations
-    simd::butterfly_gs_step_simple(buf, coef, start, m, simd_vec_len, card);
+    simd::kernels<uint32_t>().butterfly_gs_step_simple(
+        buf, coef, start, m, step, simd_vec_len, card);
 
     // for last elements, perform as non-SIMD method
     if (simd_trailing_len > 0) {
@@ -186,6 +318,61 @@ void Radix2<uint32_t>::butterfly_gs_step_simple(
     }
 }
 
+/* Operations on 16-bit symbols of GF(65537) are vectorized by SIMD */
+template <>
+void Radix2<uint32_t>::butterfly_ct_two_layers_step_narrow(
+    vec::Buffers<uint16_t>& buf,
+    unsigned start,
+    unsigned m,
+    OorMarks& marks)
+{
+    if (card != F4) {
+        butterfly_ct_two_layers_step_narrow_slow(buf, start, m, marks);
+        return;
+    }
+    const unsigned coefIndex = start * this->n / m / 2;
+    const uint32_t r1 = vec_W[coefIndex];
+    const uint32_t r2 = vec_W[coefIndex / 2];
+    const uint32_t r3 = vec_W[coefIndex / 2 + this->n / 4];
+
+    simd::f4_kernels().butterfly_ct_two_layers_step(
+        buf, r1, r2, r3, start, m, pkt_size, marks);
+}
+
+template <>
+void Radix2<uint32_t>::butterfly_ct_step_narrow(
+    vec::Buffers<uint16_t>& buf,
+    uint32_t r,
+    unsigned start,
+    unsigned m,
+    unsigned step,
+    OorMarks& marks)
+{
+    if (card != F4) {
+        butterfly_ct_step_narrow_slow(buf, r, start, m, step, marks, false);
+        return;
+    }
+    simd::f4_kernels().butterfly_ct_step(
+        buf, r, start, m, step, pkt_size, marks);
+}
+
+template <>
+void Radix2<uint32_t>::butterfly_ct_step_top_narrow(
+    vec::Buffers<uint16_t>& buf,
+    uint32_t r,
+    unsigned start,
+    unsigned m,
+    unsigned step,
+    OorMarks& marks)
+{
+    if (card != F4) {
+        butterfly_ct_step_narrow_slow(buf, r, start, m, step, marks, true);
+        return;
+    }
+    simd::f4_kernels().butterfly_ct_step_top(
+        buf, r, start, m, step, pkt_size, marks);
+}
+
 } // namespace fft
 } // namespace quadiron
 
@@ -31,11 +31,19 @@
 #ifndef __QUAD_FFT_2N_H__
 #define __QUAD_FFT_2N_H__
 
+#include <algorithm>
+#include <memory>
+#include <type_traits>
+#include <typeinfo>
+#include <vector>
+
 #include "arith.h"
 #include "fft_2.h"
 #include "fft_base.h"
 #include "fft_single.h"
 #include "gf_base.h"
+#include "gf_prime.h"
+#include "property.h"
 #include "vec_vector.h"
 #include "vec_zero_ext.h"
 
@@ -63,10 +71,72 @@ inline unsigned reverse_bitwise(unsigned x, unsigned len, unsigned bit_len)
 namespace quadiron {
 namespace fft {
 
+/** Size in bytes of the buffers above which Buffers transforms are tiled
+ *
+ * Below it, buffers mostly stay in the last-level cache across layers and
+ * computing whole packets keeps hardware prefetching efficient.
+ */
+static constexpr size_t FFT_TILED_SIZE = 32 * 1024 * 1024;
+
+/// Size in bytes of the columns of all buffers processed at a time
+static constexpr size_t FFT_TILE_SIZE = 4 * 1024 * 1024;
+
+/// Minimal size in bytes of a column tile of a packet
+static constexpr size_t FFT_MIN_TILE_SIZE = 4 * 1024;
+
+/** Maximal number of layers of Buffers transforms computed at a time
+ *
+ * Deeper codelets save loads and stores, but butterflies over Fermat primes
+ * are bound by arithmetic on AVX2: radix-8 and radix-16 codelets measured
+ * slower than radix-4 ones, whose register pressure is lower. Vectorized
+ * codelets of 3 and 4 layers are kept, and tested, for targets where they
+ * pay off, but they are unreachable at the current bound.
+ */
+static constexpr unsigned FFT_MAX_CODELET_DEPTH = 2;
+
 /** Implementation of the radix-2 FFT
  *
  * It uses bit-reversal permutation algorithm that is originally described in
  * Algorithm 9.5.5 in @cite primenumbers
+ *
+ * The transform can be truncated (in the spirit of van der Hoeven's truncated
+ * FFT) when only some outputs are needed, e.g. for codes whose length is not
+ * a power of 2:
+ * - `fft` only computes the first `out_len` outputs,
+ * - `fft_inv` and `ifft` only compute the first `data_len` outputs, i.e. the
+ *   coefficients of a polynomial of degree lower than `data_len`.
+ *
+ * Other outputs are left with intermediate values, the output vector still
+ * needs `n` elements as the transform is computed in place.
+ *
+ * For buffers, the transform can also be pruned:
+ * - `fft_pruned` only computes an arbitrary subset of outputs, e.g. a single
+ *   lost parity, see `init_pruning`,
+ * - `fft_inv_sparse` skips the operations on zero inputs, e.g. the missing
+ *   fragments of a codeword.
+ *
+ * `fft_inv_scaled` multiplies the inputs of `fft_inv` by coefficients while
+ * copying them, e.g. to fuse the products of decoding into the transform.
+ *
+ * Buffers transforms can also mark their outputs equal to `card - 1`, i.e.
+ * the out-of-range symbols of FNT codes, while the last layer computes them,
+ * see `fft_marked`.
+ *
+ * When the `n` buffers exceed `FFT_TILED_SIZE` bytes, `fft` and `fft_pruned`
+ * compute all layers on a column tile of the packets before moving to the
+ * next one, so that each tile stays in cache instead of streaming all
+ * buffers from memory at each layer.
+ *
+ * For fields of at most 65537 elements, `fft_narrow` computes the transform
+ * on 16-bit symbols, `card - 1` being stored as 0 and marked, so that
+ * vectorized operations process twice as many symbols per register as on
+ * 32-bit symbols.
+ *
+ * For prime fields, products by twiddle factors that are not vectorized are
+ * computed by Shoup's reduction, see `arith::mul_shoup`: the companions of
+ * the factors are precomputed, which saves a division per product. Other
+ * operations of non-vectorized loops are statically bound to the prime
+ * field, see `with_field`.
  */
 template <typename T>
 class Radix2 : public FourierTransform<T> {
@@ -75,7 +145,9 @@ class Radix2 : public FourierTransform<T> {
         const gf::Field<T>& gf,
         int n,
         int data_len = 0,
-        size_t pkt_size = 0);
+        size_t pkt_size = 0,
+        int out_len = 0,
+        size_t tile_len = 0);
     ~Radix2() = default;
     void fft(vec::Vector<T>& output, vec::Vector<T>& input) override;
     void ifft(vec::Vector<T>& output, vec::Vector<T>& input) override;
@@ -83,24 +155,129 @@ class Radix2 : public FourierTransform<T> {
     void fft(vec::Buffers<T>& output, vec::Buffers<T>& input) override;
     void ifft(vec::Buffers<T>& output, vec::Buffers<T>& input) override;
     void fft_inv(vec::Buffers<T>& output, vec::Buffers<T>& input) override;
+    void fft_inv_sparse(
+        vec::Buffers<T>& output,
+        vec::Buffers<T>& input,
+        std::vector<bool>& nonzero) override;
+    void fft_inv_sparse_ws(
+        vec::Buffers<T>& output,
+        vec::Buffers<T>& input,
+        std::vector<bool>& nonzero,
+        Scratch<T>& scratch) override;
+    void fft_inv_scaled(
+        vec::Buffers<T>& output,
+        vec::Buffers<T>& input,
+        vec::Vector<T>& coefs);
+
+    void fft_marked(
+        vec::Buffers<T>& output,
+        vec::Buffers<T>& input,
+        OorMarks* marks);
+    void init_pruning(std::vector<bool>& pruning) const;
+    void fft_pruned(
+        vec::Buffers<T>& output,
+        vec::Buffers<T>& input,
+        const std::vector<bool>& pruning,
+        OorMarks* marks = nullptr);
+    void fft_narrow(
+        vec::Buffers<uint16_t>& output,
+        vec::Buffers<uint16_t>& input,
+        const std::vector<bool>& pruning,
+        OorMarks& marks,
+        OorMarks* input_marks = nullptr);
 
     OpCounter fft_op_counter(size_t input_len) override;
     OpCounter ifft_op_counter(size_t input_len) override;
 
   private:
     void init_bitrev();
+    template <typename F>
+    void for_each_tile(
+        vec::Buffers<T>& output,
+        vec::Buffers<T>& input,
+        OorMarks* marks,
+        F f);
+    void init_shoup(std::true_type);
+    void init_shoup(std::false_type);
+    T shoup_companion(T coef) const;
+    T shoup_companion(T coef, std::true_type) const;
+    T shoup_companion(T coef, std::false_type) const;
+    template <typename F>
+    void with_field(F f) const;
+    template <typename Gf>
+    T mul_twiddle(const Gf& gf, T coef, T coef_shoup, T x) const;
+    template <typename Gf>
+    T mul_shoup(const Gf& gf, T coef, T coef_shoup, T x, std::true_type)
+        const;
+    template <typename Gf>
+    T mul_shoup(const Gf& gf, T coef, T coef_shoup, T x, std::false_type)
+        const;
+    void fft_butterflies(T* output, unsigned group_len);
+    void fft_inv_butterflies(T* output);
+    void fft_inv_buffers(
+        vec::Buffers<T>& output,
+        vec::Buffers<T>& input,
+        vec::Vector<T>* coefs);
     void bit_rev_permute(vec::Vector<T>& vec);
     void bit_rev_permute(vec::Buffers<T>& vec);
+    void mark_outputs(vec::Buffers<T>& buf, OorMarks* marks);
+    unsigned fft_inv_layers(vec::Buffers<T>& output, unsigned m);
     void butterfly_ct_step(
         vec::Buffers<T>& buf,
         T r,
         unsigned start,
         unsigned m,
-        unsigned step);
+        unsigned step,
+        OorMarks* marks = nullptr);
+    void butterfly_ct_step_top(
+        vec::Buffers<T>& buf,
+        T r,
+        unsigned start,
+        unsigned m,
+        unsigned step,
+        OorMarks* marks = nullptr);
     void butterfly_ct_two_layers_step(
         vec::Buffers<T>& buf,
         unsigned start,
-        unsigned m);
+        unsigned m,
+        OorMarks* marks = nullptr);
+    void butterfly_ct_layers_step(
+        vec::Buffers<T>& buf,
+        unsigned start,
+        unsigned m,
+        unsigned depth,
+        OorMarks* marks = nullptr);
+    void butterfly_ct_step_pruned(
+        vec::Buffers<T>& buf,
+        const std::vector<bool>& pruning,
+        unsigned start,
+        unsigned m,
+        OorMarks* marks);
+    void butterfly_ct_step_narrow(
+        vec::Buffers<uint16_t>& buf,
+        T r,
+        unsigned start,
+        unsigned m,
+        unsigned step,
+        OorMarks& marks);
+    void butterfly_ct_step_top_narrow(
+        vec::Buffers<uint16_t>& buf,
+        T r,
+        unsigned start,
+        unsigned m,
+        unsigned step,
+        OorMarks& marks);
+    void butterfly_ct_two_layers_step_narrow(
+        vec::Buffers<uint16_t>& buf,
+        unsigned start,
+        unsigned m,
+        OorMarks& marks);
+    void butterfly_ct_step_pruned_narrow(
+        vec::Buffers<uint16_t>& buf,
+        const std::vector<bool>& pruning,
+        unsigned start,
+        unsigned m,
+        OorMarks& marks);
     void butterfly_gs_step(
         vec::Buffers<T>& buf,
         T r,
@@ -113,20 +290,62 @@ class Radix2 : public FourierTransform<T> {
         unsigned start,
         unsigned m,
         unsigned step);
+    void butterfly_gs_layers_step(
+        vec::Buffers<T>& buf,
+        unsigned start,
+        unsigned m,
+        unsigned depth);
+    unsigned codelet_depth(unsigned layers) const;
+    void codelet_coefs(
+        const T* omegas,
+        unsigned start,
+        unsigned m,
+        unsigned depth,
+        T* coefs) const;
 
     // Only used for non-vectorized elements
     void butterfly_ct_two_layers_step_slow(
         vec::Buffers<T>& buf,
         unsigned start,
         unsigned m,
-        size_t offset = 0);
+        size_t offset = 0,
+        OorMarks* marks = nullptr);
+    void butterfly_ct_layers_step_slow(
+        vec::Buffers<T>& buf,
+        unsigned start,
+        unsigned m,
+        unsigned depth,
+        size_t offset = 0,
+        OorMarks* marks = nullptr);
     void butterfly_ct_step_slow(
         vec::Buffers<T>& buf,
         T coef,
         unsigned start,
         unsigned m,
         unsigned step,
-        size_t offset = 0);
+        size_t offset = 0,
+        OorMarks* marks = nullptr);
+    void butterfly_ct_step_top_slow(
+        vec::Buffers<T>& buf,
+        T coef,
+        unsigned start,
+        unsigned m,
+        unsigned step,
+        size_t offset = 0,
+        OorMarks* marks = nullptr);
+    void butterfly_ct_two_layers_step_narrow_slow(
+        vec::Buffers<uint16_t>& buf,
+        unsigned start,
+        unsigned m,
+        OorMarks& marks);
+    void butterfly_ct_step_narrow_slow(
+        vec::Buffers<uint16_t>& buf,
+        T coef,
+        unsigned start,
+        unsigned m,
+        unsigned step,
+        OorMarks& marks,
+        bool top);
     void butterfly_gs_step_slow(
         vec::Buffers<T>& buf,
         T coef,
@@ -141,14 +360,26 @@ class Radix2 : public FourierTransform<T> {
         unsigned m,
         unsigned step,
         size_t offset = 0);
+    void butterfly_gs_layers_step_slow(
+        vec::Buffers<T>& buf,
+        unsigned start,
+        unsigned m,
+        unsigned depth,
+        size_t offset = 0);
 
     unsigned data_len; // number of real input elements
+    unsigned out_len;  // number of wanted outputs of `fft`
+    // length of groups of `fft_inv` outputs among which only the first one is
+    // wanted, outputs being in bit-reversed order
+    unsigned inv_stride;
     T card;
     T card_minus_one;
     T w;
     T inv_w;
     size_t pkt_size;
     size_t buf_size;
+    // flags of `fft_pruned` computing the first `out_len` outputs
+    std::vector<bool> out_pruning;
 
     // Indices used for accelerated functions
     size_t simd_vec_len;
@@ -159,6 +390,18 @@ class Radix2 : public FourierTransform<T> {
     std::unique_ptr<vec::Vector<T>> W = nullptr;
     std::unique_ptr<vec::Vector<T>> inv_W = nullptr;
     T* vec_W;
+    // the field if it is a prime field, otherwise nullptr
+    const gf::Prime<T>* prime = nullptr;
+    // Shoup companions of `W` and `inv_W`, empty if `shoup` is false
+    bool shoup = false;
+    std::vector<T> W_shoup;
+    std::vector<T> inv_W_shoup;
+    // number of symbols of column tiles, `pkt_size` if transforms are not
+    // tiled
+    size_t tile_len;
+    // transforms of a tile and of the last tile if it is shorter
+    std::unique_ptr<Radix2<T>> tile_fft = nullptr;
+    std::unique_ptr<Radix2<T>> last_tile_fft = nullptr;
 };
 
 /** Initialize the FFT object.
@@ -171,12 +414,25 @@ class Radix2 : public FourierTransform<T> {
  * shorterning operation cycles
  * @param pkt_size size of packet, i.e. number of symbols per chunk will be
  *  received and processed at a time
+ * @param out_len if non-zero, the transform is truncated: `fft` only
+ *  computes the first `out_len` outputs and `fft_inv` only the first
+ *  `data_len` ones
+ * @param tile_len number of symbols of the column tiles of Buffers
+ *  transforms, a multiple of a cache line, or 0 to choose it from the size of
+ *  buffers
  */
 template <typename T>
-Radix2<T>::Radix2(const gf::Field<T>& gf, int n, int data_len, size_t pkt_size)
+Radix2<T>::Radix2(
+    const gf::Field<T>& gf,
+    int n,
+    int data_len,
+    size_t pkt_size,
+    int out_len,
+    size_t tile_len)
     : FourierTransform<T>(gf, n)
 {
     assert(n >= data_len);
+    assert(n >= out_len);
 
     if ((gf.get_p() - 1) % n != 0) {
         throw InvalidArgument("Radix2: card-1 not divisible by n");
@@ -185,6 +441,8 @@ Radix2<T>::Radix2(const gf::Field<T>& gf, int n, int data_len, size_t pkt_size)
     inv_w = gf.inv(w);
     this->pkt_size = pkt_size;
     this->data_len = data_len > 0 ? data_len : n;
+    this->out_len = out_len > 0 ? out_len : n;
+    inv_stride = out_len > 0 ? n / arith::ceil2<unsigned>(this->data_len) : 1;
     buf_size = pkt_size * sizeof(T);
 
     W = std::unique_ptr<vec::Vector<T>>(new vec::Vector<T>(gf, n));
@@ -197,14 +455,88 @@ Radix2<T>::Radix2(const gf::Field<T>& gf, int n, int data_len, size_t pkt_size)
     card = this->gf->card();
     card_minus_one = this->gf->card_minus_one();
 
+    prime = dynamic_cast<const gf::Prime<T>*>(&gf);
+    init_shoup(arith::HasFastModMul<T>());
+
     rev = std::unique_ptr<T[]>(new T[n]);
     init_bitrev();
 
-    // Indices used for accelerated functions
-    const unsigned ratio = simd::countof<T>();
-    simd_vec_len = this->pkt_size / ratio;
+    out_pruning.assign(2 * n, false);
+    std::fill_n(out_pruning.begin() + n, this->out_len, true);
+    init_pruning(out_pruning);
+
+    // Indices used for accelerated functions, whose modular kernels only
+    // compute modulo the Fermat prime of their lanes
+    const unsigned ratio = simd::vec_countof<T>();
+    simd_vec_len = simd::is_kernel_card(card) ? this->pkt_size / ratio : 0;
     simd_trailing_len = this->pkt_size - simd_vec_len * ratio;
     simd_offset = simd_vec_len * ratio;
+
+    // Tiles are made of whole cache lines, which keeps the alignment of
+    // packets and gives each tile its own words of `OorMarks` bitmaps
+    const size_t line_len = 64 / sizeof(T);
+    if (tile_len == 0) {
+        // tiles shorter than a few pages defeat hardware prefetching
+        tile_len = this->pkt_size;
+        if (n * buf_size > FFT_TILED_SIZE
+            && n * FFT_MIN_TILE_SIZE <= FFT_TILE_SIZE) {
+            tile_len = FFT_TILE_SIZE / n / sizeof(T);
+        }
+    }
+    assert(tile_len >= this->pkt_size || tile_len % line_len == 0);
+    this->tile_len = std::max<size_t>(tile_len, line_len);
+    if (this->tile_len >= this->pkt_size) {
+        this->tile_len = this->pkt_size;
+    } else {
+        tile_fft = std::make_unique<Radix2<T>>(
+            gf, n, data_len, this->tile_len, out_len, this->tile_len);
+        const size_t last_len = this->pkt_size % this->tile_len;
+        if (last_len > 0) {
+            last_tile_fft = std::make_unique<Radix2<T>>(
+                gf, n, data_len, last_len, out_len, last_len);
+        }
+    }
+}
+
+/** Run a Buffers transform on each column tile of the packets
+ *
+ * @param output - output buffers
+ * @param input - input buffers
+ * @param marks - marks of the outputs, or nullptr
+ * @param f - function called with the transform of a tile, the output and
+ * input columns of the tile and a window on the marks of the tile
+ */
+template <typename T>
+template <typename F>
+void Radix2<T>::for_each_tile(
+    vec::Buffers<T>& output,
+    vec::Buffers<T>& input,
+    OorMarks* marks,
+    F f)
+{
+    const std::vector<T*>& i_mem = input.get_mem();
+    const std::vector<T*>& o_mem = output.get_mem();
+    std::vector<T*> i_cols(i_mem.size());
+    std::vector<T*> o_cols(o_mem.size());
+
+    for (size_t col = 0; col < pkt_size; col += tile_len) {
+        const size_t len = std::min(tile_len, pkt_size - col);
+        Radix2<T>& fft = (len == tile_len) ? *tile_fft : *last_tile_fft;
+        for (size_t i = 0; i < i_mem.size(); ++i) {
+            i_cols[i] = i_mem[i] + col;
+        }
+        for (size_t i = 0; i < o_mem.size(); ++i) {
+            o_cols[i] = o_mem[i] + col;
+        }
+        vec::Buffers<T> i_tile(input.get_n(), len, i_cols);
+        vec::Buffers<T> o_tile(output.get_n(), len, o_cols);
+        if (marks == nullptr) {
+            f(fft, o_tile, i_tile, nullptr);
+        } else {
+            OorMarks tile_marks(*marks, col, len);
+            f(fft, o_tile, i_tile, &tile_marks);
+        }
+    }
 }
 
 template <typename T>
@@ -219,6 +551,95 @@ void Radix2<T>::init_bitrev()
     }
 }
 
+/// Precompute the Shoup companions of twiddle factors of prime fields
+template <typename T>
+void Radix2<T>::init_shoup(std::true_type)
+{
+    if (prime == nullptr || (card >> (8 * sizeof(T) - 1)) != 0) {
+        return;
+    }
+    shoup = true;
+    W_shoup.resize(this->n);
+    inv_W_shoup.resize(this->n);
+    for (int i = 0; i < this->n; ++i) {
+        W_shoup[i] = arith::shoup_companion(W->get(i), card);
+        inv_W_shoup[i] = arith::shoup_companion(inv_W->get(i), card);
+    }
+}
+
+template <typename T>
+void Radix2<T>::init_shoup(std::false_type)
+{
+}
+
+/// Get the Shoup companion of a factor, or 0 if `shoup` is false
+template <typename T>
+inline T Radix2<T>::shoup_companion(T coef) const
+{
+    return shoup ? shoup_companion(coef, arith::HasFastModMul<T>()) : 0;
+}
+
+template <typename T>
+inline T Radix2<T>::shoup_companion(T coef, std::true_type) const
+{
+    return arith::shoup_companion(coef, card);
+}
+
+template <typename T>
+inline T Radix2<T>::shoup_companion(T, std::false_type) const
+{
+    return 0;
+}
+
+/** Call a function on the field of the transform
+ *
+ * `f` is a generic function called with the field as a `gf::Prime<T>` if it
+ * is a prime field, otherwise as a `gf::Field<T>`. In the first case, the
+ * operations of the field are statically bound since `gf::Prime` is final,
+ * hence they can be inlined in the loops of `f`.
+ */
+template <typename T>
+template <typename F>
+inline void Radix2<T>::with_field(F f) const
+{
+    if (prime != nullptr) {
+        f(*prime);
+    } else {
+        f(*this->gf);
+    }
+}
+
+/// Multiply by a twiddle factor whose Shoup companion is `coef_shoup`
+template <typename T>
+template <typename Gf>
+inline T Radix2<T>::mul_twiddle(const Gf& gf, T coef, T coef_shoup, T x) const
+{
+    if (!shoup) {
+        return gf.mul(coef, x);
+    }
+    return mul_shoup(gf, coef, coef_shoup, x, arith::HasFastModMul<T>());
+}
+
+template <typename T>
+template <typename Gf>
+inline T Radix2<T>::mul_shoup(
+    const Gf&,
+    T coef,
+    T coef_shoup,
+    T x,
+    std::true_type) const
+{
+    return arith::mul_shoup(x, coef, coef_shoup, card);
+}
+
+template <typename T>
+template <typename Gf>
+inline T Radix2<T>::mul_shoup(const Gf& gf, T coef, T, T x, std::false_type)
+    const
+{
+    return gf.mul(coef, x);
+}
+
 template <typename T>
 void Radix2<T>::bit_rev_permute(vec::Vector<T>& vec)
 {
@@ -262,6 +683,10 @@ void Radix2<T>::bit_rev_permute(vec::Buffers<T>& vec)
  * - For other groups, initialize them normally
  * It leads to a O(K*logN) complexity
  *
+ * If the transform is truncated, a butterfly operation is skipped or reduced
+ * to its first output when its outputs do not contribute to the first
+ * `out_len` outputs.
+ *
  * @param output - output vector
  * @param input - input vector
  */
@@ -289,20 +714,51 @@ void Radix2<T>::fft(vec::Vector<T>& output, vec::Vector<T>& input)
             output.set(i, 0);
         }
     }
-    // perform butterfly operations
-    for (unsigned m = group_len; m < len; m *= 2) {
-        const unsigned doubled_m = 2 * m;
-        const unsigned ratio = len / doubled_m;
-        for (unsigned j = 0; j < m; ++j) {
-            const T r = W->get(j * ratio);
-            for (unsigned i = j; i < len; i += doubled_m) {
-                const T a = output.get(i);
-                const T b = this->gf->mul(r, output.get(i + m));
-                output.set(i, this->gf->add(a, b));
-                output.set(i + m, this->gf->sub(a, b));
+    // perform butterfly operations on the memory of plain vectors, other
+    // vectors may not store their elements contiguously
+    if (typeid(output) == typeid(vec::Vector<T>)) {
+        fft_butterflies(output.get_mem(), group_len);
+        return;
+    }
+    std::vector<T> values(len);
+    for (unsigned i = 0; i < len; ++i) {
+        values[i] = output.get(i);
+    }
+    fft_butterflies(values.data(), group_len);
+    for (unsigned i = 0; i < len; ++i) {
+        output.set(i, values[i]);
+    }
+}
+
+// butterfly operations of `fft` on `n` values from groups of `group_len`
+// values
+template <typename T>
+void Radix2<T>::fft_butterflies(T* output, unsigned group_len)
+{
+    const unsigned len = this->n;
+
+    with_field([&](const auto& gf) {
+        for (unsigned m = group_len; m < len; m *= 2) {
+            const unsigned doubled_m = 2 * m;
+            const unsigned ratio = len / doubled_m;
+            // only the first `out_len` outputs of each group are wanted
+            const unsigned end = std::min(m, out_len);
+            for (unsigned j = 0; j < end; ++j) {
+                const T r = vec_W[j * ratio];
+                const T r_shoup = shoup ? W_shoup[j * ratio] : 0;
+                const bool full = j + m < out_len;
+                for (unsigned i = j; i < len; i += doubled_m) {
+                    const T a = output[i];
+                    const T b =
+                        this->mul_twiddle(gf, r, r_shoup, output[i + m]);
+                    output[i] = gf.add(a, b);
+                    if (full) {
+                        output[i + m] = gf.sub(a, b);
+                    }
+                }
             }
         }
-    }
+    });
 }
 
 /** Perform decimation-in-frequency FFT or inverse FFT
@@ -314,33 +770,61 @@ void Radix2<T>::fft(vec::Vector<T>& output, vec::Vector<T>& input)
  * - Output is copied from input at bit-reversed indices
  * It leads to a O(N*logN) complexity.
  *
+ * If the transform is truncated, only outputs at multiple of `inv_stride`
+ * indices are computed by the last layers, their bit-reversed indices being
+ * lower than `data_len`. These layers need additions only.
+ *
  * @param output - output vector
  * @param input - input vector
  */
 template <typename T>
 void Radix2<T>::fft_inv(vec::Vector<T>& output, vec::Vector<T>& input)
 {
-    const unsigned len = this->n;
-
     output.copy(&input);
 
-    for (unsigned m = len / 2; m >= 1; m /= 2) {
-        unsigned doubled_m = 2 * m;
-        for (unsigned j = 0; j < m; ++j) {
-            T r = inv_W->get(j * len / doubled_m);
-            for (unsigned i = j; i < len; i += doubled_m) {
-                const T a = output.get(i);
-                const T b = output.get(i + m);
-                output.set(i, this->gf->add(a, b));
-                output.set(i + m, this->gf->mul(r, this->gf->sub(a, b)));
-            }
-        }
-    }
+    // butterfly operations are performed on the memory of the output, as
+    // `copy` and `bit_rev_permute`
+    fft_inv_butterflies(output.get_mem());
 
     // reversion of elements of output to return values on the natural order
     bit_rev_permute(output);
 }
 
+// butterfly operations of `fft_inv` on `n` values
+template <typename T>
+void Radix2<T>::fft_inv_butterflies(T* output)
+{
+    const unsigned len = this->n;
+    const T* inv_w_mem = inv_W->get_mem();
+
+    with_field([&](const auto& gf) {
+        for (unsigned m = len / 2; m >= 1; m /= 2) {
+            const unsigned doubled_m = 2 * m;
+            if (m < inv_stride) {
+                // only the first output of butterfly operations is wanted
+                for (unsigned i = 0; i < len; i += inv_stride) {
+                    for (unsigned j = i; j < i + m; ++j) {
+                        output[j] = gf.add(output[j], output[j + m]);
+                    }
+                }
+                continue;
+            }
+            const unsigned ratio = len / doubled_m;
+            for (unsigned j = 0; j < m; ++j) {
+                const T r = inv_w_mem[j * ratio];
+                const T r_shoup = shoup ? inv_W_shoup[j * ratio] : 0;
+                for (unsigned i = j; i < len; i += doubled_m) {
+                    const T a = output[i];
+                    const T b = output[i + m];
+                    output[i] = gf.add(a, b);
+                    output[i + m] =
+                        this->mul_twiddle(gf, r, r_shoup, gf.sub(a, b));
+                }
+            }
+        }
+    });
+}
+
 template <typename T>
 void Radix2<T>::ifft(vec::Vector<T>& output, vec::Vector<T>& input)
 {
@@ -360,6 +844,40 @@ void Radix2<T>::ifft(vec::Vector<T>& output, vec::Vector<T>& input)
 template <typename T>
 void Radix2<T>::fft(vec::Buffers<T>& output, vec::Buffers<T>& input)
 {
+    fft_marked(output, input, nullptr);
+}
+
+/** Perform decimation-in-time FFT marking out-of-range outputs
+ *
+ * Outputs equal to `card - 1` are marked by the last layer while they are
+ * still in registers, which saves another pass over the outputs to find
+ * them.
+ *
+ * @param output - output buffers
+ * @param input - input buffers
+ * @param marks - marks of the outputs, only set bits are written: it must be
+ * cleared beforehand. It may be nullptr.
+ */
+template <typename T>
+void Radix2<T>::fft_marked(
+    vec::Buffers<T>& output,
+    vec::Buffers<T>& input,
+    OorMarks* marks)
+{
+    if (tile_fft != nullptr) {
+        for_each_tile(
+            output,
+            input,
+            marks,
+            [](Radix2<T>& fft,
+               vec::Buffers<T>& o_tile,
+               vec::Buffers<T>& i_tile,
+               OorMarks* tile_marks) {
+                fft.fft_marked(o_tile, i_tile, tile_marks);
+            });
+        return;
+    }
+
     const unsigned len = this->n;
     const unsigned input_len = input.get_n();
 
@@ -387,25 +905,58 @@ void Radix2<T>::fft(vec::Buffers<T>& output, vec::Buffers<T>& input)
     }
 
     // ----------------------
-    // Two layers at a time
+    // Several layers at a time, as long as all outputs of the layers are
+    // wanted
     // ----------------------
     unsigned m = group_len;
-    const unsigned end = len / 2;
-    for (; m < end; m <<= 2) {
+    if (m == len) {
+        // there is no butterfly operation
+        mark_outputs(output, marks);
+        return;
+    }
+    while (4 * m <= out_len) {
+        const unsigned depth =
+            codelet_depth(arith::log2<unsigned>(out_len / m));
+        OorMarks* layer_marks = ((m << depth) == len) ? marks : nullptr;
         for (unsigned j = 0; j < m; ++j) {
-            butterfly_ct_two_layers_step(output, j, m);
+            if (depth == 2) {
+                butterfly_ct_two_layers_step(output, j, m, layer_marks);
+            } else {
+                butterfly_ct_layers_step(output, j, m, depth, layer_marks);
+            }
         }
+        m <<= depth;
     }
-    if (m < len) {
-        assert(m == end);
-        // perform the last butterfly operations
-        for (unsigned j = 0; j < m; ++j) {
-            const T r = W->get(j);
-            butterfly_ct_step(output, r, j, m, len);
+    // perform the last butterfly operations
+    for (; m < len; m <<= 1) {
+        const unsigned doubled_m = 2 * m;
+        const unsigned ratio = len / doubled_m;
+        OorMarks* layer_marks = (doubled_m == len) ? marks : nullptr;
+        // only the first `out_len` outputs of each group are wanted
+        const unsigned end = std::min(m, out_len);
+        for (unsigned j = 0; j < end; ++j) {
+            const T r = W->get(j * ratio);
+            if (j + m < out_len) {
+                butterfly_ct_step(output, r, j, m, doubled_m, layer_marks);
+            } else {
+                butterfly_ct_step_top(output, r, j, m, doubled_m, layer_marks);
+            }
         }
     }
 }
 
+// mark out-of-range outputs that are not computed by a butterfly operation
+template <typename T>
+void Radix2<T>::mark_outputs(vec::Buffers<T>& buf, OorMarks* marks)
+{
+    if (marks == nullptr) {
+        return;
+    }
+    for (unsigned i = 0; i < out_len; ++i) {
+        marks->detect(i, buf.get(i), 0, pkt_size, card_minus_one);
+    }
+}
+
 // for each pair (P, Q) = (buf[i], buf[i + m]):
 // P = P + c * Q
 // Q = P - c * Q
@@ -415,9 +966,24 @@ void Radix2<T>::butterfly_ct_step(
     T r,
     unsigned start,
     unsigned m,
-    unsigned step)
+    unsigned step,
+    OorMarks* marks)
+{
+    butterfly_ct_step_slow(buf, r, start, m, step, 0, marks);
+}
+
+// for each pair (P, Q) = (buf[i], buf[i + m]):
+// P = P + c * Q
+template <typename T>
+void Radix2<T>::butterfly_ct_step_top(
+    vec::Buffers<T>& buf,
+    T r,
+    unsigned start,
+    unsigned m,
+    unsigned step,
+    OorMarks* marks)
 {
-    butterfly_ct_step_slow(buf, r, start, m, step);
+    butterfly_ct_step_top_slow(buf, r, start, m, step, 0, marks);
 }
 
 /**
@@ -442,14 +1008,17 @@ void Radix2<T>::butterfly_ct_step(
  * @param buf - working buffers
  * @param start - index of buffer among `m` ones
  * @param m - current group size
+ * @param marks - if not nullptr, out-of-range outputs of the second layer are
+ * marked in it
  */
 template <typename T>
 void Radix2<T>::butterfly_ct_two_layers_step(
     vec::Buffers<T>& buf,
     unsigned start,
-    unsigned m)
+    unsigned m,
+    OorMarks* marks)
 {
-    butterfly_ct_two_layers_step_slow(buf, start, m);
+    butterfly_ct_two_layers_step_slow(buf, start, m, 0, marks);
 }
 
 template <typename T>
@@ -457,7 +1026,8 @@ void Radix2<T>::butterfly_ct_two_layers_step_slow(
     vec::Buffers<T>& buf,
     unsigned start,
     unsigned m,
-    size_t offset)
+    size_t offset,
+    OorMarks* marks)
 {
     const unsigned step = m << 2;
     //  ---------
@@ -473,72 +1043,581 @@ void Radix2<T>::butterfly_ct_two_layers_step_slow(
     //  ---------
     // first pair
     const T r2 = W->get(start * this->n / m / 4);
-    butterfly_ct_step_slow(buf, r2, start, 2 * m, step, offset);
+    butterfly_ct_step_slow(buf, r2, start, 2 * m, step, offset, marks);
     // second pair
     const T r3 = W->get((start + m) * this->n / m / 4);
-    butterfly_ct_step_slow(buf, r3, start + m, 2 * m, step, offset);
+    butterfly_ct_step_slow(buf, r3, start + m, 2 * m, step, offset, marks);
 }
 
+/** Choose the number of layers of the next codelet
+ *
+ * Layers are split into as few codelets as possible, of about the same depth,
+ * e.g. 10 layers are computed by codelets of 2, 2, 2, 2 and 2 layers and 5
+ * layers by codelets of 2, 2 and 1 layers.
+ *
+ * @param layers - number of remaining layers
+ * @return depth of the next codelet
+ */
 template <typename T>
-void Radix2<T>::butterfly_ct_step_slow(
-    vec::Buffers<T>& buf,
-    T coef,
+unsigned Radix2<T>::codelet_depth(unsigned layers) const
+{
+    const unsigned nb_codelets =
+        (layers + FFT_MAX_CODELET_DEPTH - 1) / FFT_MAX_CODELET_DEPTH;
+    return (layers + nb_codelets - 1) / nb_codelets;
+}
+
+/** Get the coefficients of the butterflies of a codelet
+ *
+ * The layer of butterflies on pairs `(i + k * m, i + (k + h) * m)` uses
+ * `coefs[h - 1 + k % h]`, see `simd::butterfly_ct_layers_step`.
+ *
+ * @param omegas - powers of the root of unity
+ * @param start - index of buffer among `m` ones
+ * @param m - group size of the first layer of `fft`, the last one of
+ * `fft_inv`
+ * @param depth - number of layers
+ * @param coefs - `2^depth - 1` coefficients
+ */
+template <typename T>
+void Radix2<T>::codelet_coefs(
+    const T* omegas,
     unsigned start,
     unsigned m,
-    unsigned step,
-    size_t offset)
+    unsigned depth,
+    T* coefs) const
 {
-    for (int i = start; i < this->n; i += step) {
-        T* a = buf.get(i);
-        T* b = buf.get(i + m);
-        // perform butterfly operation for Cooley-Tukey FFT algorithm
-        for (size_t j = offset; j < this->pkt_size; ++j) {
-            T x = this->gf->mul(coef, b[j]);
-            b[j] = this->gf->sub(a[j], x);
-            a[j] = this->gf->add(a[j], x);
+    for (unsigned h = 1; h < (1U << depth); h <<= 1) {
+        const unsigned ratio = this->n / (2 * h * m);
+        for (unsigned k = 0; k < h; ++k) {
+            coefs[h - 1 + k] = omegas[(start + k * m) * ratio];
         }
     }
 }
 
-/** Perform decimation-in-frequency FFT or inverse FFT
+/** Butterfly CT on `depth` layers at a time
  *
- * Input buffer is in reversed-bit order. Hence butterfly operations can
- * be performed directly on this order. But the output must be re-order in the
- * natural order by using swap operations. A swap operation is to swap only two
- * buffers' pointer, hence it's not costly. However, it will modify the output
- * buffers. To avoid that, we reverse the output twice, before and after the
- * butterfly operation.
+ * Non-vectorized elements are computed layer by layer.
  *
- * @param output - output buffers
- * @param input - input buffers
+ * @param buf - working buffers
+ * @param start - index of buffer among `m` ones
+ * @param m - current group size
+ * @param depth - number of layers
+ * @param marks - if not nullptr, out-of-range outputs of the last layer are
+ * marked in it
  */
 template <typename T>
-void Radix2<T>::fft_inv(vec::Buffers<T>& output, vec::Buffers<T>& input)
+void Radix2<T>::butterfly_ct_layers_step(
+    vec::Buffers<T>& buf,
+    unsigned start,
+    unsigned m,
+    unsigned depth,
+    OorMarks* marks)
 {
-    const unsigned len = this->n;
-    const unsigned input_len = input.get_n();
-
-    // 1st reversion of elements of output
-    bit_rev_permute(output);
-
-    // copy input to output
-    const std::vector<T*>& i_mem = input.get_mem();
-    const std::vector<T*>& o_mem = output.get_mem();
-    unsigned i;
-    for (i = 0; i < input_len; ++i) {
-        memcpy(o_mem[i], i_mem[i], buf_size);
-    }
+    butterfly_ct_layers_step_slow(buf, start, m, depth, 0, marks);
+}
+
+template <typename T>
+void Radix2<T>::butterfly_ct_layers_step_slow(
+    vec::Buffers<T>& buf,
+    unsigned start,
+    unsigned m,
+    unsigned depth,
+    size_t offset,
+    OorMarks* marks)
+{
+    const unsigned step = m << depth;
+    for (unsigned h = 1; h < (1U << depth); h <<= 1) {
+        const unsigned ratio = this->n / (2 * h * m);
+        OorMarks* layer_marks = (2 * h == (1U << depth)) ? marks : nullptr;
+        for (unsigned k = 0; k < h; ++k) {
+            const T r = W->get((start + k * m) * ratio);
+            for (unsigned i = start + k * m; i < start + step; i += 2 * h * m) {
+                butterfly_ct_step_slow(
+                    buf, r, i, h * m, step, offset, layer_marks);
+            }
+        }
+    }
+}
+
+template <typename T>
+void Radix2<T>::butterfly_ct_step_slow(
+    vec::Buffers<T>& buf,
+    T coef,
+    unsigned start,
+    unsigned m,
+    unsigned step,
+    size_t offset,
+    OorMarks* marks)
+{
+    const T coef_shoup = shoup_companion(coef);
+    with_field([&](const auto& gf) {
+        for (int i = start; i < this->n; i += step) {
+            T* a = buf.get(i);
+            T* b = buf.get(i + m);
+            // perform butterfly operation for Cooley-Tukey FFT algorithm
+            for (size_t j = offset; j < this->pkt_size; ++j) {
+                T x = this->mul_twiddle(gf, coef, coef_shoup, b[j]);
+                b[j] = gf.sub(a[j], x);
+                a[j] = gf.add(a[j], x);
+            }
+            if (marks != nullptr) {
+                // outputs are still in cache
+                marks->detect(i, a, offset, pkt_size, card_minus_one);
+                marks->detect(i + m, b, offset, pkt_size, card_minus_one);
+            }
+        }
+    });
+}
+
+template <typename T>
+void Radix2<T>::butterfly_ct_step_top_slow(
+    vec::Buffers<T>& buf,
+    T coef,
+    unsigned start,
+    unsigned m,
+    unsigned step,
+    size_t offset,
+    OorMarks* marks)
+{
+    const T coef_shoup = shoup_companion(coef);
+    with_field([&](const auto& gf) {
+        for (int i = start; i < this->n; i += step) {
+            T* a = buf.get(i);
+            T* b = buf.get(i + m);
+            for (size_t j = offset; j < this->pkt_size; ++j) {
+                const T x = this->mul_twiddle(gf, coef, coef_shoup, b[j]);
+                a[j] = gf.add(a[j], x);
+            }
+            if (marks != nullptr) {
+                marks->detect(i, a, offset, pkt_size, card_minus_one);
+            }
+        }
+    });
+}
+
+/** Compute which outputs of each layer of `fft_pruned` are needed
+ *
+ * An element of index `i` of the layer whose groups have `b` elements, i.e.
+ * after butterfly operations of step `b`, is needed iff a wanted output of
+ * index `o` verifies `o = i mod b`. Hence it only depends on `i mod b` and
+ * the flags of all layers are stored in a vector of `2n` elements: the flag
+ * of `i mod b` is at index `b + i mod b`, the last layer being at `[n, 2n)`.
+ *
+ * @param pruning vector of `2n` flags whose last `n` ones tell which outputs
+ * are wanted, the other ones are set from them
+ */
+template <typename T>
+void Radix2<T>::init_pruning(std::vector<bool>& pruning) const
+{
+    const unsigned len = this->n;
+
+    assert(pruning.size() == 2 * len);
+
+    for (unsigned b = len / 2; b >= 1; b /= 2) {
+        for (unsigned t = 0; t < b; ++t) {
+            pruning[b + t] = pruning[2 * b + t] || pruning[3 * b + t];
+        }
+    }
+}
+
+/** Perform decimation-in-time FFT computing some outputs only
+ *
+ * Butterfly operations are skipped when none of their outputs are needed,
+ * and reduced to their first output when it is the only one needed. Two
+ * layers are processed at a time for groups whose outputs are all needed.
+ * Computing a single output costs about `n` butterfly operations instead of
+ * `n/2 * log2(n)`.
+ *
+ * Other outputs are left with intermediate values.
+ *
+ * @param output - output buffers
+ * @param input - input buffers
+ * @param pruning - flags computed by `init_pruning`
+ * @param marks - marks of the outputs as for `fft_marked`, or nullptr
+ */
+template <typename T>
+void Radix2<T>::fft_pruned(
+    vec::Buffers<T>& output,
+    vec::Buffers<T>& input,
+    const std::vector<bool>& pruning,
+    OorMarks* marks)
+{
+    if (tile_fft != nullptr) {
+        for_each_tile(
+            output,
+            input,
+            marks,
+            [&pruning](
+                Radix2<T>& fft,
+                vec::Buffers<T>& o_tile,
+                vec::Buffers<T>& i_tile,
+                OorMarks* tile_marks) {
+                fft.fft_pruned(o_tile, i_tile, pruning, tile_marks);
+            });
+        return;
+    }
+
+    const unsigned len = this->n;
+    const unsigned input_len = input.get_n();
+
+    assert(input_len > 0);
+    assert(data_len > 0);
+    assert(pruning.size() == 2 * len);
+
+    // to support FFT on input vectors of length greater than from `data_len`
+    const unsigned group_len =
+        (input_len > data_len) ? len / input_len : len / data_len;
+
+    const std::vector<T*>& i_mem = input.get_mem();
+    const std::vector<T*>& o_mem = output.get_mem();
+
+    // set output = scramble(input) for needed elements only
+    for (unsigned idx = 0; idx < data_len; ++idx) {
+        for (unsigned t = 0; t < group_len; ++t) {
+            if (!pruning[group_len + t]) {
+                continue;
+            }
+            if (idx < input_len) {
+                memcpy(o_mem[rev[idx] + t], i_mem[idx], buf_size);
+            } else {
+                memset(o_mem[rev[idx] + t], 0, buf_size);
+            }
+        }
+    }
+
+    unsigned m = group_len;
+    if (m == len) {
+        mark_outputs(output, marks);
+        return;
+    }
+    for (; 4 * m <= len; m <<= 2) {
+        const unsigned step = 4 * m;
+        OorMarks* layer_marks = (step == len) ? marks : nullptr;
+        for (unsigned j = 0; j < m; ++j) {
+            if (pruning[step + j] && pruning[step + j + m]
+                && pruning[step + j + 2 * m] && pruning[step + j + 3 * m]) {
+                butterfly_ct_two_layers_step(output, j, m, layer_marks);
+            } else {
+                butterfly_ct_step_pruned(output, pruning, j, m, nullptr);
+                butterfly_ct_step_pruned(
+                    output, pruning, j, 2 * m, layer_marks);
+                butterfly_ct_step_pruned(
+                    output, pruning, j + m, 2 * m, layer_marks);
+            }
+        }
+    }
+    for (; m < len; m <<= 1) {
+        OorMarks* layer_marks = (2 * m == len) ? marks : nullptr;
+        for (unsigned j = 0; j < m; ++j) {
+            butterfly_ct_step_pruned(output, pruning, j, m, layer_marks);
+        }
+    }
+}
+
+// butterfly_ct_step reduced to the outputs flagged in `pruning`
+template <typename T>
+inline void Radix2<T>::butterfly_ct_step_pruned(
+    vec::Buffers<T>& buf,
+    const std::vector<bool>& pruning,
+    unsigned start,
+    unsigned m,
+    OorMarks* marks)
+{
+    const unsigned doubled_m = 2 * m;
+    const T r = vec_W[start * (this->n / doubled_m)];
+    if (pruning[doubled_m + start + m]) {
+        butterfly_ct_step(buf, r, start, m, doubled_m, marks);
+    } else if (pruning[doubled_m + start]) {
+        butterfly_ct_step_top(buf, r, start, m, doubled_m, marks);
+    }
+}
+
+/** Perform decimation-in-time FFT on 16-bit symbols
+ *
+ * The transform is the one of `fft_pruned`, symbols equal to `card - 1` being
+ * stored as 0 and marked in `marks`. Each butterfly operation updates the
+ * marks of its outputs.
+ *
+ * @param output - output buffers of `pkt_size` symbols
+ * @param input - input buffers of `pkt_size` symbols
+ * @param pruning - flags computed by `init_pruning`, or empty to compute the
+ * first `out_len` outputs
+ * @param marks - marks of all `n` output buffers
+ * @param input_marks - marks of the input buffers, or nullptr if no input is
+ * equal to `card - 1`
+ *
+ * @throw InvalidArgument if the field has more than 65537 elements
+ */
+template <typename T>
+void Radix2<T>::fft_narrow(
+    vec::Buffers<uint16_t>& output,
+    vec::Buffers<uint16_t>& input,
+    const std::vector<bool>& pruning,
+    OorMarks& marks,
+    OorMarks* input_marks)
+{
+    const unsigned len = this->n;
+    const unsigned input_len = input.get_n();
+
+    if (card > 65537) {
+        throw InvalidArgument("Radix2: symbols do not fit in 16 bits");
+    }
+    assert(input_len > 0);
+    assert(data_len > 0);
+
+    const std::vector<bool>& flags = pruning.empty() ? out_pruning : pruning;
+    assert(flags.size() == 2 * len);
+
+    // to support FFT on input vectors of length greater than from `data_len`
+    const unsigned group_len =
+        (input_len > data_len) ? len / input_len : len / data_len;
+    const size_t size = pkt_size * sizeof(uint16_t);
+
+    const std::vector<uint16_t*>& i_mem = input.get_mem();
+    const std::vector<uint16_t*>& o_mem = output.get_mem();
+
+    // set output = scramble(input) for needed elements only
+    for (unsigned idx = 0; idx < data_len; ++idx) {
+        for (unsigned t = 0; t < group_len; ++t) {
+            if (!flags[group_len + t]) {
+                continue;
+            }
+            const unsigned i = rev[idx] + t;
+            if (idx < input_len) {
+                memcpy(o_mem[i], i_mem[idx], size);
+            } else {
+                memset(o_mem[i], 0, size);
+            }
+            if (idx < input_len && input_marks != nullptr) {
+                marks.copy(i, *input_marks, idx);
+            } else {
+                marks.clear(i);
+            }
+        }
+    }
+
+    unsigned m = group_len;
+    for (; 4 * m <= len; m <<= 2) {
+        const unsigned step = 4 * m;
+        for (unsigned j = 0; j < m; ++j) {
+            if (flags[step + j] && flags[step + j + m]
+                && flags[step + j + 2 * m] && flags[step + j + 3 * m]) {
+                butterfly_ct_two_layers_step_narrow(output, j, m, marks);
+            } else {
+                butterfly_ct_step_pruned_narrow(output, flags, j, m, marks);
+                butterfly_ct_step_pruned_narrow(
+                    output, flags, j, 2 * m, marks);
+                butterfly_ct_step_pruned_narrow(
+                    output, flags, j + m, 2 * m, marks);
+            }
+        }
+    }
+    for (; m < len; m <<= 1) {
+        for (unsigned j = 0; j < m; ++j) {
+            butterfly_ct_step_pruned_narrow(output, flags, j, m, marks);
+        }
+    }
+}
+
+// butterfly_ct_step_pruned on 16-bit symbols
+template <typename T>
+inline void Radix2<T>::butterfly_ct_step_pruned_narrow(
+    vec::Buffers<uint16_t>& buf,
+    const std::vector<bool>& pruning,
+    unsigned start,
+    unsigned m,
+    OorMarks& marks)
+{
+    const unsigned doubled_m = 2 * m;
+    const T r = vec_W[start * (this->n / doubled_m)];
+    if (pruning[doubled_m + start + m]) {
+        butterfly_ct_step_narrow(buf, r, start, m, doubled_m, marks);
+    } else if (pruning[doubled_m + start]) {
+        butterfly_ct_step_top_narrow(buf, r, start, m, doubled_m, marks);
+    }
+}
+
+// butterfly_ct_step on 16-bit symbols
+template <typename T>
+void Radix2<T>::butterfly_ct_step_narrow(
+    vec::Buffers<uint16_t>& buf,
+    T r,
+    unsigned start,
+    unsigned m,
+    unsigned step,
+    OorMarks& marks)
+{
+    butterfly_ct_step_narrow_slow(buf, r, start, m, step, marks, false);
+}
+
+// butterfly_ct_step_top on 16-bit symbols
+template <typename T>
+void Radix2<T>::butterfly_ct_step_top_narrow(
+    vec::Buffers<uint16_t>& buf,
+    T r,
+    unsigned start,
+    unsigned m,
+    unsigned step,
+    OorMarks& marks)
+{
+    butterfly_ct_step_narrow_slow(buf, r, start, m, step, marks, true);
+}
+
+// butterfly_ct_two_layers_step on 16-bit symbols
+template <typename T>
+void Radix2<T>::butterfly_ct_two_layers_step_narrow(
+    vec::Buffers<uint16_t>& buf,
+    unsigned start,
+    unsigned m,
+    OorMarks& marks)
+{
+    butterfly_ct_two_layers_step_narrow_slow(buf, start, m, marks);
+}
+
+template <typename T>
+void Radix2<T>::butterfly_ct_two_layers_step_narrow_slow(
+    vec::Buffers<uint16_t>& buf,
+    unsigned start,
+    unsigned m,
+    OorMarks& marks)
+{
+    const unsigned step = m << 2;
+    const T r1 = W->get(start * this->n / m / 2);
+    const T r2 = W->get(start * this->n / m / 4);
+    const T r3 = W->get((start + m) * this->n / m / 4);
+    // first layer
+    butterfly_ct_step_narrow_slow(buf, r1, start, m, step, marks, false);
+    butterfly_ct_step_narrow_slow(
+        buf, r1, start + 2 * m, m, step, marks, false);
+    // second layer
+    butterfly_ct_step_narrow_slow(buf, r2, start, 2 * m, step, marks, false);
+    butterfly_ct_step_narrow_slow(
+        buf, r3, start + m, 2 * m, step, marks, false);
+}
+
+template <typename T>
+void Radix2<T>::butterfly_ct_step_narrow_slow(
+    vec::Buffers<uint16_t>& buf,
+    T coef,
+    unsigned start,
+    unsigned m,
+    unsigned step,
+    OorMarks& marks,
+    bool top)
+{
+    const T coef_shoup = shoup_companion(coef);
+    with_field([&](const auto& gf) {
+        for (int i = start; i < this->n; i += step) {
+            uint16_t* a = buf.get(i);
+            uint16_t* b = buf.get(i + m);
+            uint64_t* mask_a = marks.get(i);
+            uint64_t* mask_b = marks.get(i + m);
+            for (size_t j = 0; j < this->pkt_size; ++j) {
+                const T x = marks.is_marked(mask_a, j) ? card_minus_one : a[j];
+                const T y = marks.is_marked(mask_b, j) ? card_minus_one : b[j];
+                const T z = this->mul_twiddle(gf, coef, coef_shoup, y);
+                if (!top) {
+                    const T d = gf.sub(x, z);
+                    b[j] = narrow_cast<uint16_t>(d);
+                    marks.set_marked(mask_b, j, d == card_minus_one);
+                }
+                const T s = gf.add(x, z);
+                a[j] = narrow_cast<uint16_t>(s);
+                marks.set_marked(mask_a, j, s == card_minus_one);
+            }
+        }
+    });
+}
+
+/** Perform decimation-in-frequency FFT or inverse FFT
+ *
+ * Input buffer is in reversed-bit order. Hence butterfly operations can
+ * be performed directly on this order. But the output must be re-order in the
+ * natural order by using swap operations. A swap operation is to swap only two
+ * buffers' pointer, hence it's not costly. However, it will modify the output
+ * buffers. To avoid that, we reverse the output twice, before and after the
+ * butterfly operation.
+ *
+ * If the transform is truncated, the last layers only compute the outputs
+ * whose bit-reversed indices are lower than `data_len`.
+ *
+ * @param output - output buffers
+ * @param input - input buffers
+ */
+template <typename T>
+void Radix2<T>::fft_inv(vec::Buffers<T>& output, vec::Buffers<T>& input)
+{
+    fft_inv_buffers(output, input, nullptr);
+}
+
+/** Perform `fft_inv` on inputs multiplied by coefficients
+ *
+ * The products are computed while inputs are copied to the output buffers,
+ * which saves a pass over the buffers compared to `mul_vec_to_vecp` followed
+ * by `fft_inv`. As the transform is linear, a constant factor of the outputs,
+ * e.g. the `1/N` of the inverse FFT, can also be folded into `coefs`.
+ *
+ * @param output - output buffers
+ * @param input - input buffers
+ * @param coefs - coefficients of the input buffers
+ */
+template <typename T>
+void Radix2<T>::fft_inv_scaled(
+    vec::Buffers<T>& output,
+    vec::Buffers<T>& input,
+    vec::Vector<T>& coefs)
+{
+    fft_inv_buffers(output, input, &coefs);
+}
+
+/** Perform `fft_inv` or `fft_inv_scaled`
+ *
+ * @param output - output buffers
+ * @param input - input buffers
+ * @param coefs - coefficients of the input buffers, nullptr for `fft_inv`
+ */
+template <typename T>
+void Radix2<T>::fft_inv_buffers(
+    vec::Buffers<T>& output,
+    vec::Buffers<T>& input,
+    vec::Vector<T>* coefs)
+{
+    const unsigned len = this->n;
+    const unsigned input_len = input.get_n();
+
+    // 1st reversion of elements of output
+    bit_rev_permute(output);
+
+    // copy input to output
+    const std::vector<T*>& i_mem = input.get_mem();
+    const std::vector<T*>& o_mem = output.get_mem();
+    unsigned i;
+    if (coefs == nullptr) {
+        for (i = 0; i < input_len; ++i) {
+            memcpy(o_mem[i], i_mem[i], buf_size);
+        }
+    } else {
+        this->gf->mul_vec_to_vecp(*coefs, input, output);
+        i = input_len;
+    }
 
     unsigned m = len / 2;
 
     if (input_len < len) {
-        const unsigned input_len_power_2 = arith::ceil2<unsigned>(input_len);
-        for (; i < input_len_power_2; ++i) {
+        // the first half is the `P` part of the first layer, it must be
+        // zero-padded
+        const unsigned zero_end =
+            std::max(arith::ceil2<unsigned>(input_len), len / 2);
+        for (; i < zero_end; ++i) {
             memset(o_mem[i], 0, buf_size);
         }
 
         // For Q are zeros only => Q = c * P
+        // If only P is wanted, there is nothing to do
         for (; m >= input_len; m /= 2) {
+            if (m < inv_stride) {
+                continue;
+            }
             unsigned doubled_m = 2 * m;
             for (unsigned j = 0; j < m; ++j) {
                 const T r = inv_W->get(j * len / doubled_m);
@@ -548,11 +1627,142 @@ void Radix2<T>::fft_inv(vec::Buffers<T>& output, vec::Buffers<T>& input)
     }
 
     // Next, normal butterlfy GS is performed
+    m = fft_inv_layers(output, m);
+
+    // Only P = P + Q is wanted for groups whose outputs are wanted
     for (; m >= 1; m /= 2) {
-        unsigned doubled_m = 2 * m;
+        for (unsigned i = 0; i < len; i += inv_stride) {
+            for (unsigned j = i; j < i + m; ++j) {
+                this->gf->add_two_bufs(o_mem[j + m], o_mem[j], pkt_size);
+            }
+        }
+    }
+
+    // 2nd reversion of elements of output to return its natural order
+    bit_rev_permute(output);
+}
+
+/** Perform the layers of GS butterflies of `fft_inv` down to `inv_stride`
+ *
+ * Layers are computed several at a time, see `codelet_depth`.
+ *
+ * @param output - working buffers
+ * @param m - group size of the first layer
+ * @return group size of the next layer
+ */
+template <typename T>
+unsigned Radix2<T>::fft_inv_layers(vec::Buffers<T>& output, unsigned m)
+{
+    while (m >= inv_stride) {
+        const unsigned depth =
+            codelet_depth(arith::log2<unsigned>(m / inv_stride) + 1);
+        if (depth == 1) {
+            for (unsigned j = 0; j < m; ++j) {
+                const T r = inv_W->get(j * (this->n / (2 * m)));
+                butterfly_gs_step(output, r, j, m, 2 * m);
+            }
+            m /= 2;
+            continue;
+        }
+        // group size of the last layer
+        const unsigned last_m = m >> (depth - 1);
+        for (unsigned j = 0; j < last_m; ++j) {
+            butterfly_gs_layers_step(output, j, last_m, depth);
+        }
+        m = last_m / 2;
+    }
+    return m;
+}
+
+/** Perform decimation-in-frequency FFT on a sparse input
+ *
+ * Zero elements are tracked through the layers: a butterfly operation on
+ * a pair (P, Q) is skipped if both elements are zero and it is reduced to a
+ * multiplication if one of them is zero. Once all elements are non-zero, the
+ * remaining layers are performed as in `fft_inv`.
+ *
+ * @param output - output buffers
+ * @param input - input buffers of length `n`
+ * @param nonzero - mask of input elements that may be non-zero, it is used
+ * as scratch memory
+ */
+template <typename T>
+void Radix2<T>::fft_inv_sparse(
+    vec::Buffers<T>& output,
+    vec::Buffers<T>& input,
+    std::vector<bool>& nonzero)
+{
+    const unsigned len = this->n;
+
+    assert(input.get_n() == static_cast<int>(len));
+    assert(nonzero.size() == len);
+
+    // 1st reversion of elements of output
+    bit_rev_permute(output);
+
+    // copy non-zero elements of input to output
+    const std::vector<T*>& i_mem = input.get_mem();
+    const std::vector<T*>& o_mem = output.get_mem();
+    bool dense = true;
+    for (unsigned i = 0; i < len; ++i) {
+        if (nonzero[i]) {
+            memcpy(o_mem[i], i_mem[i], buf_size);
+        } else {
+            dense = false;
+        }
+    }
+
+    unsigned m = len / 2;
+    for (; !dense && m >= inv_stride; m /= 2) {
+        const unsigned doubled_m = 2 * m;
+        dense = true;
         for (unsigned j = 0; j < m; ++j) {
             const T r = inv_W->get(j * len / doubled_m);
-            butterfly_gs_step(output, r, j, m, doubled_m);
+            for (unsigned i = j; i < len; i += doubled_m) {
+                if (nonzero[i] && nonzero[i + m]) {
+                    butterfly_gs_step(output, r, i, m, len);
+                } else if (nonzero[i]) {
+                    // Q is zero => Q = c * P
+                    butterfly_gs_step_simple(output, r, i, m, len);
+                } else if (nonzero[i + m]) {
+                    // P is zero => P = Q and Q = -c * Q
+                    memcpy(o_mem[i], o_mem[i + m], buf_size);
+                    butterfly_gs_step_simple(
+                        output, this->gf->sub(0, r), i, m, len);
+                } else {
+                    dense = false;
+                    continue;
+                }
+                nonzero[i] = true;
+                nonzero[i + m] = true;
+            }
+        }
+    }
+
+    // Next, normal butterlfy GS is performed
+    m = fft_inv_layers(output, m);
+
+    // Only P = P + Q is wanted for groups whose outputs are wanted
+    for (; m >= 1; m /= 2) {
+        for (unsigned i = 0; i < len; i += inv_stride) {
+            for (unsigned j = i; j < i + m; ++j) {
+                if (!nonzero[j + m]) {
+                    continue;
+                }
+                if (nonzero[j]) {
+                    this->gf->add_two_bufs(o_mem[j + m], o_mem[j], pkt_size);
+                } else {
+                    memcpy(o_mem[j], o_mem[j + m], buf_size);
+                    nonzero[j] = true;
+                }
+            }
+        }
+    }
+
+    // outputs that are still zero have not been written
+    for (unsigned i = 0; i < len; ++i) {
+        if (!nonzero[i]) {
+            memset(o_mem[i], 0, buf_size);
         }
     }
 
@@ -560,6 +1770,17 @@ void Radix2<T>::fft_inv(vec::Buffers<T>& output, vec::Buffers<T>& input)
     bit_rev_permute(output);
 }
 
+/** Perform `fft_inv_sparse`, which needs no scratch memory */
+template <typename T>
+void Radix2<T>::fft_inv_sparse_ws(
+    vec::Buffers<T>& output,
+    vec::Buffers<T>& input,
+    std::vector<bool>& nonzero,
+    Scratch<T>& /* scratch */)
+{
+    fft_inv_sparse(output, input, nonzero);
+}
+
 // for each pair (P, Q) = (buf[i], buf[i + m]):
 // Q = c * P
 template <typename T>
@@ -587,6 +1808,38 @@ void Radix2<T>::butterfly_gs_step(
     butterfly_gs_step_slow(buf, coef, start, m, step);
 }
 
+// butterfly_ct_layers_step inverted by GS butterflies, `m` being the group
+// size of the last layer
+template <typename T>
+void Radix2<T>::butterfly_gs_layers_step(
+    vec::Buffers<T>& buf,
+    unsigned start,
+    unsigned m,
+    unsigned depth)
+{
+    butterfly_gs_layers_step_slow(buf, start, m, depth);
+}
+
+template <typename T>
+void Radix2<T>::butterfly_gs_layers_step_slow(
+    vec::Buffers<T>& buf,
+    unsigned start,
+    unsigned m,
+    unsigned depth,
+    size_t offset)
+{
+    const unsigned step = m << depth;
+    for (unsigned h = (1U << depth) / 2; h > 0; h >>= 1) {
+        const unsigned ratio = this->n / (2 * h * m);
+        for (unsigned k = 0; k < h; ++k) {
+            const T r = inv_W->get((start + k * m) * ratio);
+            for (unsigned i = start + k * m; i < start + step; i += 2 * h * m) {
+                butterfly_gs_step_slow(buf, r, i, h * m, step, offset);
+            }
+        }
+    }
+}
+
 template <typename T>
 void Radix2<T>::butterfly_gs_step_slow(
     vec::Buffers<T>& buf,
@@ -596,16 +1849,19 @@ void Radix2<T>::butterfly_gs_step_slow(
     unsigned step,
     size_t offset)
 {
-    for (int i = start; i < this->n; i += step) {
-        T* a = buf.get(i);
-        T* b = buf.get(i + m);
-        // perform butterfly operation for Cooley-Tukey FFT algorithm
-        for (size_t j = offset; j < this->pkt_size; ++j) {
-            T x = this->gf->sub(a[j], b[j]);
-            a[j] = this->gf->add(a[j], b[j]);
-            b[j] = this->gf->mul(coef, x);
+    const T coef_shoup = shoup_companion(coef);
+    with_field([&](const auto& gf) {
+        for (int i = start; i < this->n; i += step) {
+            T* a = buf.get(i);
+            T* b = buf.get(i + m);
+            // perform butterfly operation for Cooley-Tukey FFT algorithm
+            for (size_t j = offset; j < this->pkt_size; ++j) {
+                T x = gf.sub(a[j], b[j]);
+                a[j] = gf.add(a[j], b[j]);
+                b[j] = this->mul_twiddle(gf, coef, coef_shoup, x);
+            }
         }
-    }
+    });
 }
 
 template <typename T>
@@ -617,14 +1873,17 @@ void Radix2<T>::butterfly_gs_step_simple_slow(
     unsigned step,
     size_t offset)
 {
-    for (int i = start; i < this->n; i += step) {
-        T* a = buf.get(i);
-        T* b = buf.get(i + m);
-        // perform butterfly operation for Cooley-Tukey FFT algorithm
-        for (size_t j = offset; j < this->pkt_size; ++j) {
-            b[j] = this->gf->mul(coef, a[j]);
+    const T coef_shoup = shoup_companion(coef);
+    with_field([&](const auto& gf) {
+        for (int i = start; i < this->n; i += step) {
+            T* a = buf.get(i);
+            T* b = buf.get(i + m);
+            // perform butterfly operation for Cooley-Tukey FFT algorithm
+            for (size_t j = offset; j < this->pkt_size; ++j) {
+                b[j] = this->mul_twiddle(gf, coef, coef_shoup, a[j]);
+            }
         }
-    }
+    });
 }
 
 template <typename T>
@@ -653,15 +1912,19 @@ OpCounter Radix2<T>::fft_op_counter(size_t input_len)
     for (size_t m = group_len; m < len; m <<= 1) {
         const size_t step = 2 * m;
         const size_t ratio = len / step;
-        for (size_t start = 0; start < m; ++start) {
+        const size_t end = std::min<size_t>(m, out_len);
+        for (size_t start = 0; start < end; ++start) {
             const T coef = vec_W[start * ratio];
-            // one butterfly_ct_step operation
+            const bool full = start + m < out_len;
+            // one butterfly_ct_step (or butterfly_ct_step_top) operation
             // butterfly_ct_step(output, coef, start, m, step);
             for (size_t i = start; i < len; i += step) {
                 // one butterfly_ct on buffers of pkt_size elements
                 counter.butterfly++;
                 counter.add++;
-                counter.sub++;
+                if (full) {
+                    counter.sub++;
+                }
                 if (coef > 1 && coef < card_minus_one) {
                     counter.mul++;
                 }
@@ -684,6 +1947,9 @@ OpCounter Radix2<T>::ifft_op_counter(size_t input_len)
     if (input_len < len) {
         // For Q are zeros only => Q = c * P
         for (; m >= input_len; m /= 2) {
+            if (m < inv_stride) {
+                continue;
+            }
             const size_t step = 2 * m;
             for (size_t start = 0; start < m; ++start) {
                 const T coef = inv_W->get(start * len / step);
@@ -703,7 +1969,7 @@ OpCounter Radix2<T>::ifft_op_counter(size_t input_len)
     }
 
     // Next, normal butterlfy GS is performed
-    for (; m >= 1; m /= 2) {
+    for (; m >= inv_stride; m /= 2) {
         const size_t step = 2 * m;
         for (size_t start = 0; start < m; ++start) {
             const T coef = inv_W->get(start * len / step);
@@ -721,6 +1987,11 @@ OpCounter Radix2<T>::ifft_op_counter(size_t input_len)
         }
     }
 
+    // Truncated transform: only P = P + Q is computed for wanted groups
+    for (; m >= 1; m /= 2) {
+        counter.add += len / inv_stride * m;
+    }
+
     return counter;
 }
 
@@ -731,14 +2002,31 @@ template <>
 void Radix2<uint16_t>::butterfly_ct_two_layers_step(
     vec::Buffers<uint16_t>& buf,
     unsigned start,
-    unsigned m);
+    unsigned m,
+    OorMarks* marks);
+template <>
+void Radix2<uint16_t>::butterfly_ct_layers_step(
+    vec::Buffers<uint16_t>& buf,
+    unsigned start,
+    unsigned m,
+    unsigned depth,
+    OorMarks* marks);
 template <>
 void Radix2<uint16_t>::butterfly_ct_step(
     vec::Buffers<uint16_t>& buf,
     uint16_t r,
     unsigned start,
     unsigned m,
-    unsigned step);
+    unsigned step,
+    OorMarks* marks);
+template <>
+void Radix2<uint16_t>::butterfly_ct_step_top(
+    vec::Buffers<uint16_t>& buf,
+    uint16_t r,
+    unsigned start,
+    unsigned m,
+    unsigned step,
+    OorMarks* marks);
 template <>
 void Radix2<uint16_t>::butterfly_gs_step(
     vec::Buffers<uint16_t>& buf,
@@ -747,6 +2035,12 @@ void Radix2<uint16_t>::butterfly_gs_step(
     unsigned m,
     unsigned step);
 template <>
+void Radix2<uint16_t>::butterfly_gs_layers_step(
+    vec::Buffers<uint16_t>& buf,
+    unsigned start,
+    unsigned m,
+    unsigned depth);
+template <>
 void Radix2<uint16_t>::butterfly_gs_step_simple(
     vec::Buffers<uint16_t>& buf,
     uint16_t coef,
@@ -758,14 +2052,31 @@ template <>
 void Radix2<uint32_t>::butterfly_ct_two_layers_step(
     vec::Buffers<uint32_t>& buf,
     unsigned start,
-    unsigned m);
+    unsigned m,
+    OorMarks* marks);
+template <>
+void Radix2<uint32_t>::butterfly_ct_layers_step(
+    vec::Buffers<uint32_t>& buf,
+    unsigned start,
+    unsigned m,
+    unsigned depth,
+    OorMarks* marks);
 template <>
 void Radix2<uint32_t>::butterfly_ct_step(
     vec::Buffers<uint32_t>& buf,
     uint32_t r,
     unsigned start,
     unsigned m,
-    unsigned step);
+    unsigned step,
+    OorMarks* marks);
+template <>
+void Radix2<uint32_t>::butterfly_ct_step_top(
+    vec::Buffers<uint32_t>& buf,
+    uint32_t r,
+    unsigned start,
+    unsigned m,
+    unsigned step,
+    OorMarks* marks);
 template <>
 void Radix2<uint32_t>::butterfly_gs_step(
     vec::Buffers<uint32_t>& buf,
@@ -774,6 +2085,12 @@ void Radix2<uint32_t>::butterfly_gs_step(
     unsigned m,
     unsigned step);
 template <>
+void Radix2<uint32_t>::butterfly_gs_layers_step(
+    vec::Buffers<uint32_t>& buf,
+    unsigned start,
+    unsigned m,
+    unsigned depth);
+template <>
 void Radix2<uint32_t>::butterfly_gs_step_simple(
     vec::Buffers<uint32_t>& buf,
     uint32_t coef,
@@ -781,6 +2098,30 @@ void Radix2<uint32_t>::butterfly_gs_step_simple(
     unsigned m,
     unsigned step);
 
+
+template <>
+void Radix2<uint32_t>::butterfly_ct_two_layers_step_narrow(
+    vec::Buffers<uint16_t>& buf,
+    unsigned start,
+    unsigned m,
+    OorMarks& marks);
+template <>
+void Radix2<uint32_t>::butterfly_ct_step_narrow(
+    vec::Buffers<uint16_t>& buf,
+    uint32_t r,
+    unsigned start,
+    unsigned m,
+    unsigned step,
+    OorMarks& marks);
+template <>
+void Radix2<uint32_t>::butterfly_ct_step_top_narrow(
+    vec::Buffers<uint16_t>& buf,
+    uint32_t r,
+    unsigned start,
+    unsigned m,
+    unsigned step,
+    OorMarks& marks);
+
 #endif // #ifdef QUADIRON_USE_SIMD
 
 } // namespace fft
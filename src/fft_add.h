@@ -31,9 +31,14 @@
 #ifndef __QUAD_FFT_ADD_H__
 #define __QUAD_FFT_ADD_H__
 
+#include <algorithm>
+#include <memory>
+#include <vector>
+
 #include "arith.h"
 #include "fft_base.h"
 #include "gf_base.h"
+#include "vec_buffers.h"
 #include "vec_slice.h"
 #include "vec_vector.h"
 
@@ -45,18 +50,19 @@ namespace fft {
  * It works on length of 2<sup>m</sup> for arbitrary `m`.
  *
  * This is an implementation of the algorithm 2 in @cite fft-add.
+ *
+ * Buffers are transformed packet-wise: the Taylor expansion and its inverse
+ * are sequences of additions of whole packets done in place, the packets of
+ * the two halves of the expansion being gathered by views instead of copies.
  */
 template <typename T>
 class Additive : public FourierTransform<T> {
   public:
-    using FourierTransform<T>::fft;
-    using FourierTransform<T>::ifft;
-    using FourierTransform<T>::fft_inv;
-
     Additive(
         const gf::Field<T>& gf,
         T m,
-        std::shared_ptr<vec::Vector<T>> betas = nullptr);
+        std::shared_ptr<vec::Vector<T>> betas = nullptr,
+        size_t pkt_size = 0);
     void compute_basis();
     void compute_beta_m_powers();
     void compute_G();
@@ -65,7 +71,25 @@ class Additive : public FourierTransform<T> {
     void fft(vec::Vector<T>& output, vec::Vector<T>& input) override;
     void ifft(vec::Vector<T>& output, vec::Vector<T>& input) override;
     void fft_inv(vec::Vector<T>& output, vec::Vector<T>& input) override;
+    void fft(vec::Buffers<T>& output, vec::Buffers<T>& input) override;
+    void ifft(vec::Buffers<T>& output, vec::Buffers<T>& input) override;
+    void fft_inv(vec::Buffers<T>& output, vec::Buffers<T>& input) override;
+    std::unique_ptr<Scratch<T>> make_scratch() const override;
+    void fft_ws(
+        vec::Buffers<T>& output,
+        vec::Buffers<T>& input,
+        Scratch<T>& scratch) override;
+    void ifft_ws(
+        vec::Buffers<T>& output,
+        vec::Buffers<T>& input,
+        Scratch<T>& scratch) override;
+    void fft_inv_ws(
+        vec::Buffers<T>& output,
+        vec::Buffers<T>& input,
+        Scratch<T>& scratch) override;
     void taylor_expand_t2(vec::Vector<T>& input, int n);
+    void taylor_expand_t2(vec::Buffers<T>& input);
+    void inv_taylor_expand_t2(vec::Buffers<T>& output);
     void
     taylor_expand(vec::Vector<T>& output, vec::Vector<T>& input, int n, int t);
     void inv_taylor_expand_t2(vec::Vector<T>& output);
@@ -73,15 +97,46 @@ class Additive : public FourierTransform<T> {
     inv_taylor_expand(vec::Vector<T>& output, vec::Vector<T>& input, int t);
 
   private:
+    /// Scratch memory of Buffers transforms
+    class AddScratch : public Scratch<T> {
+      public:
+        AddScratch(const Additive<T>& fft);
+
+        // expansion of the input, respectively the halves of the input of
+        // the inverse transform
+        std::unique_ptr<vec::Buffers<T>> mem = nullptr;
+        // halves of `mem`
+        std::unique_ptr<vec::Buffers<T>> mem_lo = nullptr;
+        std::unique_ptr<vec::Buffers<T>> mem_hi = nullptr;
+        // views on g0 and g1, respectively on the halves of the output
+        std::unique_ptr<vec::Buffers<T>> g0 = nullptr;
+        std::unique_ptr<vec::Buffers<T>> g1 = nullptr;
+        std::unique_ptr<vec::Buffers<T>> u = nullptr;
+        std::unique_ptr<vec::Buffers<T>> v = nullptr;
+        std::unique_ptr<Scratch<T>> child = nullptr;
+    };
+
     int find_k(int n, int t);
     void _taylor_expand_t2(vec::Vector<T>& input, int n, int k, int start);
+    void _taylor_expand_t2(const std::vector<T*>& mem, int n, int k, int start);
+    void
+    _inv_taylor_expand_t2(const std::vector<T*>& mem, int n, int k, int start);
     void _taylor_expand(vec::Vector<T>& input, int n, int t);
     void mul_xt_x(vec::Vector<T>& vec, int t);
     void _fft(vec::Vector<T>& output, vec::Vector<T>& input);
     void _ifft(vec::Vector<T>& output, vec::Vector<T>& input);
+    void _fft(
+        vec::Buffers<T>& output,
+        vec::Buffers<T>& input,
+        AddScratch& scratch);
+    void _ifft(
+        vec::Buffers<T>& output,
+        vec::Buffers<T>& input,
+        AddScratch& scratch);
 
     bool create_betas;
     T m;
+    size_t pkt_size;
     T m_k, deg0, deg1, deg2;
     T beta_1, inv_beta_1;
     T beta_m, inv_beta_m;
@@ -98,15 +153,26 @@ class Additive : public FourierTransform<T> {
     std::unique_ptr<Additive<T>> fft_add = nullptr;
 };
 
+/** Initialize the FFT
+ *
+ * @param m the transform is of length 2<sup>m</sup>
+ * @param betas basis of the evaluation points, made from the primitive root
+ * if not given
+ * @param pkt_size size of packets of Buffers transforms, 0 if only vectors
+ * are transformed
+ */
+
 template <typename T>
 Additive<T>::Additive(
     const gf::Field<T>& gf,
     T m,
-    std::shared_ptr<vec::Vector<T>> betas)
+    std::shared_ptr<vec::Vector<T>> betas,
+    size_t pkt_size)
     : FourierTransform<T>(gf, arith::exp2<T>(m), true)
 {
     assert(m >= 1);
     this->m = m;
+    this->pkt_size = pkt_size;
     create_betas = false;
     if (betas == nullptr) {
         // it supports only GF2N
@@ -145,10 +211,34 @@ Additive<T>::Additive(
         this->v = std::make_unique<vec::Vector<T>>(gf, this->m_k);
 
         this->mem = std::make_unique<vec::Vector<T>>(gf, this->n);
-        this->fft_add = std::make_unique<Additive>(gf, m - 1, this->deltas);
+        this->fft_add =
+            std::make_unique<Additive>(gf, m - 1, this->deltas, pkt_size);
     }
 }
 
+template <typename T>
+Additive<T>::AddScratch::AddScratch(const Additive<T>& fft)
+{
+    if (fft.m > 1) {
+        const size_t size = fft.pkt_size;
+        const int m_k = fft.m_k;
+        mem = std::make_unique<vec::Buffers<T>>(fft.n, size);
+        mem_lo = std::make_unique<vec::Buffers<T>>(*mem, 0, m_k);
+        mem_hi = std::make_unique<vec::Buffers<T>>(*mem, m_k, fft.n);
+        g0 = make_view<T>(m_k, size);
+        g1 = make_view<T>(m_k, size);
+        u = make_view<T>(m_k, size);
+        v = make_view<T>(m_k, size);
+        child = fft.fft_add->make_scratch();
+    }
+}
+
+template <typename T>
+std::unique_ptr<Scratch<T>> Additive<T>::make_scratch() const
+{
+    return std::make_unique<AddScratch>(*this);
+}
+
 template <typename T>
 void Additive<T>::compute_beta_m_powers()
 {
@@ -391,6 +481,173 @@ void Additive<T>::ifft(vec::Vector<T>& output, vec::Vector<T>& input)
     fft_inv(output, input);
 }
 
+template <typename T>
+void Additive<T>::_fft(
+    vec::Buffers<T>& output,
+    vec::Buffers<T>& input,
+    AddScratch& scratch)
+{
+    const size_t size = this->pkt_size;
+    const int input_len = input.get_n();
+    const std::vector<T*>& o_mem = output.get_mem();
+    const std::vector<T*>& t_mem = scratch.mem->get_mem();
+    vec::Buffers<T>& g0_bufs = *scratch.g0;
+    vec::Buffers<T>& g1_bufs = *scratch.g1;
+    vec::Buffers<T>& u_bufs = *scratch.u;
+    vec::Buffers<T>& v_bufs = *scratch.v;
+
+    // g(x) = f(beta_m * x), missing input buffers being zero
+    for (int i = 0; i < input_len; i++) {
+        if (beta_m > 1) {
+            this->gf->mul_coef_to_buf(
+                beta_m_powers->get(i), input.get(i), t_mem[i], size);
+        } else {
+            std::copy_n(input.get(i), size, t_mem[i]);
+        }
+    }
+    for (int i = input_len; i < this->n; i++) {
+        std::fill_n(t_mem[i], size, 0);
+    }
+
+    // g0 and g1 are the even and odd packets of the expansion
+    taylor_expand_t2(*scratch.mem);
+    for (T i = 0; i < m_k; i++) {
+        g0_bufs.set(i, t_mem[2 * i]);
+        g1_bufs.set(i, t_mem[2 * i + 1]);
+    }
+
+    // u and v are computed in the halves of output
+    for (T i = 0; i < m_k; i++) {
+        u_bufs.set(i, o_mem[i]);
+        v_bufs.set(i, o_mem[m_k + i]);
+    }
+    this->fft_add->fft_ws(u_bufs, g0_bufs, *scratch.child);
+    this->fft_add->fft_ws(v_bufs, g1_bufs, *scratch.child);
+
+    // output = (u + G*v, (u + G*v) + v)
+    for (T i = 0; i < m_k; i++) {
+        this->gf->mul_coef_add_to_buf(
+            G->get(i), o_mem[m_k + i], o_mem[i], size);
+        this->gf->add_two_bufs(o_mem[i], o_mem[m_k + i], size);
+    }
+}
+
+template <typename T>
+void Additive<T>::_ifft(
+    vec::Buffers<T>& output,
+    vec::Buffers<T>& input,
+    AddScratch& scratch)
+{
+    const size_t size = this->pkt_size;
+    const std::vector<T*>& i_mem = input.get_mem();
+    const std::vector<T*>& o_mem = output.get_mem();
+    const std::vector<T*>& t_mem = scratch.mem->get_mem();
+    vec::Buffers<T>& g0_bufs = *scratch.g0;
+    vec::Buffers<T>& g1_bufs = *scratch.g1;
+
+    // input = (w0, w1): v = w1 - w0 and u = w0 - G * v are computed in the
+    // halves of the scratch buffers
+    for (T i = 0; i < m_k; i++) {
+        this->gf->sub_two_bufs(i_mem[i], i_mem[m_k + i], t_mem[m_k + i], size);
+        std::copy_n(i_mem[i], size, t_mem[i]);
+        this->gf->mul_coef_add_to_buf(
+            G->get(i), t_mem[m_k + i], t_mem[i], size);
+    }
+
+    // g0 and g1 are computed in the even and odd packets of output
+    for (T i = 0; i < m_k; i++) {
+        g0_bufs.set(i, o_mem[2 * i]);
+        g1_bufs.set(i, o_mem[2 * i + 1]);
+    }
+    this->fft_add->fft_inv_ws(g0_bufs, *scratch.mem_lo, *scratch.child);
+    this->fft_add->fft_inv_ws(g1_bufs, *scratch.mem_hi, *scratch.child);
+
+    inv_taylor_expand_t2(output);
+
+    // f(x) = g(beta_m^(-1) * x)
+    if (beta_m > 1) {
+        T coef = inv_beta_m;
+        for (int i = 1; i < this->n; i++) {
+            this->gf->mul_coef_to_buf(coef, o_mem[i], o_mem[i], size);
+            coef = this->gf->mul(coef, inv_beta_m);
+        }
+    }
+}
+
+/** Compute the additive FFT of buffers
+ *
+ * @param output - `n` output buffers
+ * @param input - input buffers, zero-extended to `n` buffers if shorter
+ */
+template <typename T>
+void Additive<T>::fft(vec::Buffers<T>& output, vec::Buffers<T>& input)
+{
+    fft_ws(output, input, this->get_scratch());
+}
+
+template <typename T>
+void Additive<T>::fft_inv(vec::Buffers<T>& output, vec::Buffers<T>& input)
+{
+    fft_inv_ws(output, input, this->get_scratch());
+}
+
+template <typename T>
+void Additive<T>::ifft(vec::Buffers<T>& output, vec::Buffers<T>& input)
+{
+    fft_inv_ws(output, input, this->get_scratch());
+}
+
+/** Compute the additive FFT of buffers with given scratch memory
+ *
+ * @param output - `n` output buffers
+ * @param input - input buffers, zero-extended to `n` buffers if shorter
+ * @param scratch - memory allocated by `make_scratch`
+ */
+template <typename T>
+void Additive<T>::fft_ws(
+    vec::Buffers<T>& output,
+    vec::Buffers<T>& input,
+    Scratch<T>& scratch)
+{
+    if (m > 1)
+        return _fft(output, input, static_cast<AddScratch&>(scratch));
+
+    // m == 1 -> output = (f(0), f(beta_1))
+    const size_t size = this->pkt_size;
+    std::copy_n(input.get(0), size, output.get(0));
+    std::copy_n(input.get(0), size, output.get(1));
+    if (input.get_n() > 1) {
+        this->gf->mul_coef_add_to_buf(
+            this->beta_1, input.get(1), output.get(1), size);
+    }
+}
+
+template <typename T>
+void Additive<T>::fft_inv_ws(
+    vec::Buffers<T>& output,
+    vec::Buffers<T>& input,
+    Scratch<T>& scratch)
+{
+    if (m > 1)
+        return _ifft(output, input, static_cast<AddScratch&>(scratch));
+
+    // m == 1 -> return ( input[0], (input[1] - input[0])*beta_1^-1 )
+    const size_t size = this->pkt_size;
+    this->gf->sub_two_bufs(input.get(0), input.get(1), output.get(1), size);
+    this->gf->mul_coef_to_buf(
+        this->inv_beta_1, output.get(1), output.get(1), size);
+    std::copy_n(input.get(0), size, output.get(0));
+}
+
+template <typename T>
+void Additive<T>::ifft_ws(
+    vec::Buffers<T>& output,
+    vec::Buffers<T>& input,
+    Scratch<T>& scratch)
+{
+    fft_inv_ws(output, input, scratch);
+}
+
 /**
  * Taylor expansion at (x^2 - x)
  *  Algorithm 1 in the paper of Shuhong Gao and Todd Mateer:
@@ -474,6 +731,109 @@ void Additive<T>::_taylor_expand_t2(
     }
 }
 
+/**
+ * Taylor expansion at (x^2 - x) of buffers
+ *
+ * The expansion is done in place: the buffers of even indices, respectively
+ * odd indices, become the ones of g0, respectively g1.
+ *
+ * @param input `n` buffers, `n` being the length of the FFT
+ */
+template <typename T>
+void Additive<T>::taylor_expand_t2(vec::Buffers<T>& input)
+{
+    assert(input.get_n() == this->n);
+
+    if (this->n > 2) {
+        _taylor_expand_t2(input.get_mem(), this->n, find_k(this->n, 2), 0);
+    }
+}
+
+/**
+ * Taylor expansion at (x^2 - x) of the buffers `mem[start, start + n)`
+ *
+ * Each step adds buffers of a range into buffers of a disjoint range, hence
+ * `_inv_taylor_expand_t2` undoes the steps in reverse order.
+ *
+ * @param n a power of 2
+ * @param k a number st \f$t2^{k} < n \leq 2t 2^{k}\f$
+ * @param start index of the first buffer
+ */
+template <typename T>
+void Additive<T>::_taylor_expand_t2(
+    const std::vector<T*>& mem,
+    int n,
+    int k,
+    int start)
+{
+    const size_t size = this->pkt_size;
+    int deg2 = arith::exp2<T>(k);
+    int deg0 = 2 * deg2;
+    int deg1 = deg0 - deg2;
+
+    // add f2 into f1, i.e. g1
+    for (int i = 0; i < deg2; i++) {
+        this->gf->add_two_bufs(
+            mem[start + deg0 + deg1 + i], mem[start + deg0 + i], size);
+    }
+    // add f1 into g0 with offset deg2
+    for (int i = 0; i < deg1; i++) {
+        this->gf->add_two_bufs(
+            mem[start + deg0 + i], mem[start + deg2 + i], size);
+    }
+
+    if (deg0 > 2) {
+        _taylor_expand_t2(mem, deg0, k - 1, start);
+        _taylor_expand_t2(mem, n - deg0, k - 1, start + deg0);
+    }
+}
+
+/**
+ * Compute f(x) from its taylor expansion at (x^2 - x) in buffers
+ *
+ * It is the inverse of `taylor_expand_t2`: the buffers of even indices,
+ * respectively odd indices, are the ones of g0, respectively g1.
+ *
+ * @param output `n` buffers, `n` being the length of the FFT
+ */
+template <typename T>
+void Additive<T>::inv_taylor_expand_t2(vec::Buffers<T>& output)
+{
+    assert(output.get_n() == this->n);
+
+    if (this->n > 2) {
+        _inv_taylor_expand_t2(
+            output.get_mem(), this->n, find_k(this->n, 2), 0);
+    }
+}
+
+template <typename T>
+void Additive<T>::_inv_taylor_expand_t2(
+    const std::vector<T*>& mem,
+    int n,
+    int k,
+    int start)
+{
+    const size_t size = this->pkt_size;
+    int deg2 = arith::exp2<T>(k);
+    int deg0 = 2 * deg2;
+    int deg1 = deg0 - deg2;
+
+    if (deg0 > 2) {
+        _inv_taylor_expand_t2(mem, deg0, k - 1, start);
+        _inv_taylor_expand_t2(mem, n - deg0, k - 1, start + deg0);
+    }
+
+    for (int i = 0; i < deg1; i++) {
+        this->gf->add_two_bufs(
+            mem[start + deg0 + i], mem[start + deg2 + i], size);
+    }
+    for (int i = 0; i < deg2; i++) {
+        this->gf->add_two_bufs(
+            mem[start + deg0 + deg1 + i], mem[start + deg0 + i], size);
+    }
+}
+
 /** This function compute f(x) from its taylor expansion.
  *
  * \f$f(x) = sum_i (gi0 + gi1 * x) * (x^2 - x)^i\f$
@@ -31,6 +31,9 @@
 #ifndef __QUAD_FFT_BASE_H__
 #define __QUAD_FFT_BASE_H__
 
+#include <memory>
+#include <vector>
+
 #include "gf_base.h"
 #include "vec_buffers.h"
 #include "vec_vector.h"
@@ -48,6 +51,33 @@ typedef struct OpCounter {
     size_t butterfly = 0;
 } OpCounter;
 
+/** Scratch memory of the Buffers transforms of a Fourier Transform
+ *
+ * Transforms needing scratch memory derive it, see
+ * `FourierTransform::make_scratch`. Threads sharing a transform can then
+ * each compute with their own scratch memory.
+ */
+template <typename T>
+class Scratch {
+  public:
+    virtual ~Scratch() = default;
+};
+
+/** Allocate a view of `n` buffers that are bound by `Buffers::set`
+ *
+ * Unlike views built from given pointers, binding buffers to it does not
+ * deallocate the previously bound ones.
+ *
+ * @param n number of buffers
+ * @param size number of elements of the buffers
+ */
+template <typename T>
+std::unique_ptr<vec::Buffers<T>> make_view(int n, size_t size)
+{
+    const vec::Buffers<T> unbound(n, size, std::vector<T*>(n));
+    return std::make_unique<vec::Buffers<T>>(unbound, 0, n);
+}
+
 /** Base class for Fourier Transform on Galois Fields.
  *
  *  The Fourier Transform is applied on vector of size `n` with ω as
@@ -71,6 +101,69 @@ class FourierTransform {
     virtual void fft_inv(vec::Vector<T>& output, vec::Vector<T>& input) = 0;
     virtual void
     fft_inv(vec::Buffers<T>& /* output */, vec::Buffers<T>& /* input */){};
+    /** Compute the summation for the inverse FFT formula on a sparse input
+     *
+     * @param output output buffers
+     * @param input input buffers, zero where `nonzero` is false
+     * @param nonzero mask of input elements that may be non-zero. It is used
+     * as scratch memory and is modified.
+     */
+    virtual void fft_inv_sparse(
+        vec::Buffers<T>& output,
+        vec::Buffers<T>& input,
+        std::vector<bool>& /* nonzero */)
+    {
+        fft_inv(output, input);
+    }
+
+    /** Allocate the scratch memory of Buffers transforms
+     *
+     * @return scratch memory to pass to `fft_ws` and alike, it must not be
+     * used by several threads at the same time
+     */
+    virtual std::unique_ptr<Scratch<T>> make_scratch() const
+    {
+        return std::make_unique<Scratch<T>>();
+    }
+    /** Compute the Fourier Transform of buffers with given scratch memory
+     *
+     * Buffers transforms without a scratch argument use scratch memory of
+     * the transform: unlike them, concurrent calls with different scratch
+     * memory are safe.
+     */
+    virtual void fft_ws(
+        vec::Buffers<T>& output,
+        vec::Buffers<T>& input,
+        Scratch<T>& /* scratch */)
+    {
+        fft(output, input);
+    }
+    /** Compute the Inverse Fourier Transform with given scratch memory */
+    virtual void ifft_ws(
+        vec::Buffers<T>& output,
+        vec::Buffers<T>& input,
+        Scratch<T>& /* scratch */)
+    {
+        ifft(output, input);
+    }
+    /** Compute the summation for the inverse FFT formula with given scratch
+     * memory */
+    virtual void fft_inv_ws(
+        vec::Buffers<T>& output,
+        vec::Buffers<T>& input,
+        Scratch<T>& /* scratch */)
+    {
+        fft_inv(output, input);
+    }
+    /** Compute `fft_inv_sparse` with given scratch memory */
+    virtual void fft_inv_sparse_ws(
+        vec::Buffers<T>& output,
+        vec::Buffers<T>& input,
+        std::vector<bool>& /* nonzero */,
+        Scratch<T>& scratch)
+    {
+        fft_inv_ws(output, input, scratch);
+    }
 
     virtual OpCounter fft_op_counter(size_t /* input_len */)
     {
@@ -89,6 +182,11 @@ class FourierTransform {
     T inv_n_mod_p;
     vec::Vector<T>* vec_inv_n = nullptr;
     FourierTransform(const gf::Field<T>& gf, int n, bool additive = false);
+    Scratch<T>& get_scratch();
+
+  private:
+    // scratch memory of Buffers transforms without a scratch argument
+    std::unique_ptr<Scratch<T>> scratch = nullptr;
 };
 
 template <typename T>
@@ -117,6 +215,16 @@ FourierTransform<T>::~FourierTransform()
         delete vec_inv_n;
 }
 
+/** Get the scratch memory of the transform, allocated at first use */
+template <typename T>
+Scratch<T>& FourierTransform<T>::get_scratch()
+{
+    if (scratch == nullptr) {
+        scratch = make_scratch();
+    }
+    return *scratch;
+}
+
 template <typename T>
 int FourierTransform<T>::get_n()
 {
@@ -31,11 +31,16 @@
 #ifndef __QUAD_FFT_CT_H__
 #define __QUAD_FFT_CT_H__
 
+#include <memory>
+#include <vector>
+
 #include "arith.h"
 #include "fft_2.h"
 #include "fft_base.h"
 #include "fft_naive.h"
+#include "fft_rader.h"
 #include "gf_base.h"
+#include "vec_buffers.h"
 #include "vec_vector.h"
 #include "vec_view.h"
 
@@ -81,33 +86,78 @@ namespace fft {
  * - Step1: calculate the inner DFT, i.e. \f$\sum_{i_2}\f$
  * - Step2: multiply to twiddle factors \f$w^{i_1 k_2}\f$
  * - Step3: calculate outer DFT, i.e. \f$\sum_{i_1}\f$
+ *
+ * Buffers transforms follow the same steps on whole packets: the inner and
+ * outer DFTs are computed on buffers gathered by the index mapping, and
+ * twiddle factors are applied by vectorized products of packets.
+ *
+ * Outer DFTs of large prime lengths use Rader's algorithm, see
+ * `create_leaf_dft`.
  */
 template <typename T>
 class CooleyTukey : public FourierTransform<T> {
   public:
-    using FourierTransform<T>::fft;
-    using FourierTransform<T>::ifft;
-    using FourierTransform<T>::fft_inv;
-
     CooleyTukey(
         const gf::Field<T>& gf,
         T n,
         int id = 0,
         std::vector<T>* factors = nullptr,
-        T _w = 0);
+        T _w = 0,
+        size_t pkt_size = 0);
     ~CooleyTukey();
     void fft(vec::Vector<T>& output, vec::Vector<T>& input) override;
     void ifft(vec::Vector<T>& output, vec::Vector<T>& input) override;
     void fft_inv(vec::Vector<T>& output, vec::Vector<T>& input) override;
+    void fft(vec::Buffers<T>& output, vec::Buffers<T>& input) override;
+    void ifft(vec::Buffers<T>& output, vec::Buffers<T>& input) override;
+    void fft_inv(vec::Buffers<T>& output, vec::Buffers<T>& input) override;
+    std::unique_ptr<Scratch<T>> make_scratch() const override;
+    void fft_ws(
+        vec::Buffers<T>& output,
+        vec::Buffers<T>& input,
+        Scratch<T>& scratch) override;
+    void ifft_ws(
+        vec::Buffers<T>& output,
+        vec::Buffers<T>& input,
+        Scratch<T>& scratch) override;
+    void fft_inv_ws(
+        vec::Buffers<T>& output,
+        vec::Buffers<T>& input,
+        Scratch<T>& scratch) override;
 
   private:
+    /// Scratch memory of Buffers transforms
+    class CtScratch : public Scratch<T> {
+      public:
+        CtScratch(const CooleyTukey<T>& fft);
+
+        // products of the inner DFTs by the twiddle factors
+        std::unique_ptr<vec::Buffers<T>> G = nullptr;
+        // a zero packet standing for the missing input buffers
+        vec::Buffers<T> zero;
+        // views on the inputs and outputs of the inner and outer DFTs
+        std::unique_ptr<vec::Buffers<T>> inner_x = nullptr;
+        std::unique_ptr<vec::Buffers<T>> inner_y = nullptr;
+        std::unique_ptr<vec::Buffers<T>> outer_x = nullptr;
+        std::unique_ptr<vec::Buffers<T>> outer_y = nullptr;
+        std::unique_ptr<Scratch<T>> inner = nullptr;
+        std::unique_ptr<Scratch<T>> outer = nullptr;
+    };
+
     void _fft(vec::Vector<T>& output, vec::Vector<T>& input, bool inv);
+    vec::Buffers<T>& extend(vec::Buffers<T>& input, CtScratch& scratch);
+    void _fft(
+        vec::Buffers<T>& output,
+        vec::Buffers<T>& input,
+        bool inv,
+        CtScratch& scratch);
 
     bool loop;
     bool first_layer_fft;
     T n1;
     T n2;
     T w, w1, w2, inv_w;
+    size_t pkt_size;
     vec::Vector<T>* G = nullptr;
     vec::View<T>* Y = nullptr;
     vec::View<T>* X = nullptr;
@@ -115,6 +165,7 @@ class CooleyTukey : public FourierTransform<T> {
     FourierTransform<T>* dft_inner = nullptr;
     std::vector<T> prime_factors;
     void mul_twiddle_factors(bool inv);
+    void mul_twiddle_factors_bufs(vec::Buffers<T>& bufs, bool inv);
 };
 
 /** Initialize the FFT.
@@ -122,6 +173,8 @@ class CooleyTukey : public FourierTransform<T> {
  * n-th root will be constructed with primitive root
  *
  * @param id index in the list of factors of n
+ * @param pkt_size size of packets of Buffers transforms, 0 if only vectors
+ * are transformed
  */
 template <typename T>
 CooleyTukey<T>::CooleyTukey(
@@ -129,9 +182,11 @@ CooleyTukey<T>::CooleyTukey(
     T n,
     int id,
     std::vector<T>* factors,
-    T _w)
+    T _w,
+    size_t pkt_size)
     : FourierTransform<T>(gf, n)
 {
+    this->pkt_size = pkt_size;
     if (factors == nullptr) {
         first_layer_fft = true;
         this->prime_factors = arith::get_prime_factors<T>(n);
@@ -150,7 +205,7 @@ CooleyTukey<T>::CooleyTukey(
     if (n1 == 2) {
         this->dft_outer = new fft::Size2<T>(gf);
     } else {
-        this->dft_outer = new fft::Naive<T>(gf, n1, w1);
+        this->dft_outer = fft::create_leaf_dft<T>(gf, n1, w1, pkt_size);
     }
 
     if (n2 > 1) {
@@ -161,8 +216,8 @@ CooleyTukey<T>::CooleyTukey(
         // if (_is_power_of_2<T>(_n2))
         //   this->dft_inner = new fft::Radix2<T>(gf, _n2);
         // else
-        this->dft_inner =
-            new CooleyTukey<T>(gf, _n2, id + 1, &this->prime_factors, w2);
+        this->dft_inner = new CooleyTukey<T>(
+            gf, _n2, id + 1, &this->prime_factors, w2, pkt_size);
         this->G = new vec::Vector<T>(gf, this->n);
         this->Y = new vec::View<T>(this->G);
         this->X = new vec::View<T>(this->G);
@@ -185,6 +240,29 @@ CooleyTukey<T>::~CooleyTukey()
         delete G;
 }
 
+template <typename T>
+CooleyTukey<T>::CtScratch::CtScratch(const CooleyTukey<T>& fft)
+    : zero(1, fft.pkt_size)
+{
+    const size_t size = fft.pkt_size;
+    zero.zero_fill();
+    outer_x = make_view<T>(fft.n1, size);
+    outer = fft.dft_outer->make_scratch();
+    if (fft.loop) {
+        G = std::make_unique<vec::Buffers<T>>(fft.n, size);
+        inner_x = make_view<T>(fft.n2, size);
+        inner_y = make_view<T>(fft.n2, size);
+        outer_y = make_view<T>(fft.n1, size);
+        inner = fft.dft_inner->make_scratch();
+    }
+}
+
+template <typename T>
+std::unique_ptr<Scratch<T>> CooleyTukey<T>::make_scratch() const
+{
+    return std::make_unique<CtScratch>(*this);
+}
+
 template <typename T>
 void CooleyTukey<T>::mul_twiddle_factors(bool inv)
 {
@@ -278,6 +356,178 @@ void CooleyTukey<T>::ifft(vec::Vector<T>& output, vec::Vector<T>& input)
     }
 }
 
+template <typename T>
+void CooleyTukey<T>::mul_twiddle_factors_bufs(vec::Buffers<T>& bufs, bool inv)
+{
+    const T _w = inv ? inv_w : w;
+    // vectorized products exclude the opposite of one
+    const T minus_one = this->gf->neg(1);
+    T base = 1;
+    for (T i1 = 1; i1 < n1; i1++) {
+        base = this->gf->mul(base, _w); // base = _w^i1
+        T factor = base;                // init factor = base^1
+        for (T k2 = 1; k2 < n2; k2++) {
+            T* buf = bufs.get(i1 + n1 * k2);
+            if (factor == minus_one) {
+                this->gf->neg(pkt_size, buf);
+            } else {
+                this->gf->mul_coef_to_buf(factor, buf, buf, pkt_size);
+            }
+            // next factor = base^(k2+1)
+            factor = this->gf->mul(factor, base);
+        }
+    }
+}
+
+template <typename T>
+void CooleyTukey<T>::_fft(
+    vec::Buffers<T>& output,
+    vec::Buffers<T>& input,
+    bool inv,
+    CtScratch& scratch)
+{
+    const std::vector<T*>& i_mem = input.get_mem();
+    const std::vector<T*>& o_mem = output.get_mem();
+    const std::vector<T*>& g_mem = scratch.G->get_mem();
+    const size_t input_len = input.get_n();
+    T* zero = scratch.zero.get(0);
+    vec::Buffers<T>& inner_x = *scratch.inner_x;
+    vec::Buffers<T>& inner_y = *scratch.inner_y;
+    vec::Buffers<T>& outer_x = *scratch.outer_x;
+    vec::Buffers<T>& outer_y = *scratch.outer_y;
+
+    for (T i1 = 0; i1 < n1; i1++) {
+        for (T i2 = 0; i2 < n2; i2++) {
+            const size_t loc = i1 + n1 * i2;
+            inner_x.set(i2, (loc < input_len) ? i_mem[loc] : zero);
+            inner_y.set(i2, g_mem[loc]);
+        }
+        if (inv)
+            this->dft_inner->fft_inv_ws(inner_y, inner_x, *scratch.inner);
+        else
+            this->dft_inner->fft_ws(inner_y, inner_x, *scratch.inner);
+    }
+
+    // multiply to twiddle factors
+    mul_twiddle_factors_bufs(*scratch.G, inv);
+
+    for (T k2 = 0; k2 < n2; k2++) {
+        for (T k1 = 0; k1 < n1; k1++) {
+            outer_x.set(k1, o_mem[k2 + n2 * k1]);
+            outer_y.set(k1, g_mem[k2 * n1 + k1]);
+        }
+        if (inv)
+            this->dft_outer->fft_inv_ws(outer_x, outer_y, *scratch.outer);
+        else
+            this->dft_outer->fft_ws(outer_x, outer_y, *scratch.outer);
+    }
+}
+
+/** Zero-extend input buffers to `n` buffers
+ *
+ * @param input - input buffers
+ * @param scratch - scratch memory whose view on the outer DFT inputs is
+ * bound to `input` if it is shorter
+ * @return `input` or the view
+ */
+template <typename T>
+vec::Buffers<T>&
+CooleyTukey<T>::extend(vec::Buffers<T>& input, CtScratch& scratch)
+{
+    const int input_len = input.get_n();
+    if (input_len == this->n) {
+        return input;
+    }
+    vec::Buffers<T>& x = *scratch.outer_x;
+    for (int i = 0; i < this->n; i++) {
+        x.set(i, (i < input_len) ? input.get(i) : scratch.zero.get(0));
+    }
+    return x;
+}
+
+/** Perform the FFT of buffers
+ *
+ * @param output - `n` output buffers
+ * @param input - input buffers, zero-extended to `n` buffers if shorter
+ */
+template <typename T>
+void CooleyTukey<T>::fft(vec::Buffers<T>& output, vec::Buffers<T>& input)
+{
+    fft_ws(output, input, this->get_scratch());
+}
+
+/** Perform the inverse FFT of buffers without the division by `n`
+ *
+ * @param output - `n` output buffers
+ * @param input - input buffers, zero-extended to `n` buffers if shorter
+ */
+template <typename T>
+void CooleyTukey<T>::fft_inv(vec::Buffers<T>& output, vec::Buffers<T>& input)
+{
+    fft_inv_ws(output, input, this->get_scratch());
+}
+
+template <typename T>
+void CooleyTukey<T>::ifft(vec::Buffers<T>& output, vec::Buffers<T>& input)
+{
+    ifft_ws(output, input, this->get_scratch());
+}
+
+/** Perform the FFT of buffers with given scratch memory
+ *
+ * @param output - `n` output buffers
+ * @param input - input buffers, zero-extended to `n` buffers if shorter
+ * @param scratch - memory allocated by `make_scratch`
+ */
+template <typename T>
+void CooleyTukey<T>::fft_ws(
+    vec::Buffers<T>& output,
+    vec::Buffers<T>& input,
+    Scratch<T>& scratch)
+{
+    CtScratch& cs = static_cast<CtScratch&>(scratch);
+    if (loop)
+        _fft(output, input, false, cs);
+    else
+        dft_outer->fft_ws(output, extend(input, cs), *cs.outer);
+}
+
+/** Perform the inverse FFT of buffers without the division by `n` with
+ * given scratch memory
+ *
+ * @param output - `n` output buffers
+ * @param input - input buffers, zero-extended to `n` buffers if shorter
+ * @param scratch - memory allocated by `make_scratch`
+ */
+template <typename T>
+void CooleyTukey<T>::fft_inv_ws(
+    vec::Buffers<T>& output,
+    vec::Buffers<T>& input,
+    Scratch<T>& scratch)
+{
+    CtScratch& cs = static_cast<CtScratch&>(scratch);
+    if (loop)
+        _fft(output, input, true, cs);
+    else
+        dft_outer->fft_inv_ws(output, extend(input, cs), *cs.outer);
+}
+
+template <typename T>
+void CooleyTukey<T>::ifft_ws(
+    vec::Buffers<T>& output,
+    vec::Buffers<T>& input,
+    Scratch<T>& scratch)
+{
+    fft_inv_ws(output, input, scratch);
+
+    /*
+     * We need to divide output to `N` for the inverse formular
+     */
+    if (this->first_layer_fft && (this->inv_n_mod_p > 1)) {
+        this->gf->mul_vec_to_vecp(*(this->vec_inv_n), output, output);
+    }
+}
+
 } // namespace fft
 } // namespace quadiron
 
@@ -31,6 +31,8 @@
 #ifndef __QUAD_FFT_NAIVE_H__
 #define __QUAD_FFT_NAIVE_H__
 
+#include <algorithm>
+
 #include "fft_base.h"
 #include "gf_base.h"
 #include "vec_matrix.h"
@@ -149,15 +151,26 @@ void Naive<T>::_fft(
     vec::Matrix<T>* _W)
 {
     const unsigned len = this->n;
-    const unsigned size = this->pkt_size;
+    // missing input buffers are zero and do not contribute
+    const unsigned input_len = input.get_n();
+    const size_t size = this->pkt_size;
+    // vectorized products exclude the opposite of one, which is one in
+    // characteristic 2
+    const T minus_one = this->gf->neg(1);
+    assert(input_len > 0 && input_len <= len);
     for (unsigned i = 0; i < len; ++i) {
-        output.fill(i, 0);
         T* buf = output.get(i);
-        for (unsigned j = 0; j < len; ++j) {
+        // the first column of `_W` is made of ones
+        std::copy_n(input.get(0), size, buf);
+        for (unsigned j = 1; j < input_len; ++j) {
             T* ibuf = input.get(j);
-            T r = _W->get(i, j);
-            for (unsigned u = 0; u < size; ++u) {
-                buf[u] = this->gf->add(buf[u], this->gf->mul(r, ibuf[u]));
+            const T r = _W->get(i, j);
+            if (r == 1) {
+                this->gf->add_two_bufs(ibuf, buf, size);
+            } else if (r == minus_one) {
+                this->gf->sub_two_bufs(buf, ibuf, buf, size);
+            } else {
+                this->gf->mul_coef_add_to_buf(r, ibuf, buf, size);
             }
         }
     }
@@ -166,7 +179,7 @@ void Naive<T>::_fft(
 /** Perform decimation-in-time FFT
  *
  * @param output - output buffers
- * @param input - input buffers
+ * @param input - input buffers, zero-extended to `n` buffers if shorter
  */
 template <typename T>
 void Naive<T>::fft(vec::Buffers<T>& output, vec::Buffers<T>& input)
@@ -177,7 +190,7 @@ void Naive<T>::fft(vec::Buffers<T>& output, vec::Buffers<T>& input)
 /** Perform decimation-in-frequency FFT or inverse FFT
  *
  * @param output - output buffers
- * @param input - input buffers
+ * @param input - input buffers, zero-extended to `n` buffers if shorter
  */
 template <typename T>
 void Naive<T>::fft_inv(vec::Buffers<T>& output, vec::Buffers<T>& input)
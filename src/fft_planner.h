@@ -0,0 +1,500 @@
+/* -*- mode: c++ -*- */
+/*
+ * Copyright 2017-2018 Scality
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its contributors
+ *    may be used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+#ifndef __QUAD_FFT_PLANNER_H__
+#define __QUAD_FFT_PLANNER_H__
+
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <fstream>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <random>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "arith.h"
+#include "exceptions.h"
+#include "fft_2n.h"
+#include "fft_base.h"
+#include "fft_ct.h"
+#include "fft_gt.h"
+#include "fft_naive.h"
+#include "gf_base.h"
+#include "misc.h"
+#include "vec_buffers.h"
+#include "vec_vector.h"
+
+namespace quadiron {
+namespace fft {
+
+/// Transforms a `Planner` chooses from
+enum class Algorithm { RADIX2, COOLEY_TUKEY, GOOD_THOMAS, NAIVE };
+
+/// How a `Planner` chooses a transform that is not in its wisdom
+enum class PlannerMode {
+    /// pick a transform from the length only, without timing
+    ESTIMATE,
+    /// time the candidate transforms and keep the fastest one
+    MEASURE,
+};
+
+/// Naive transforms longer than this are not timed
+static constexpr int PLANNER_NAIVE_MAX_LEN = 64;
+/// Number of timed runs of each candidate, the fastest one is kept
+static constexpr int PLANNER_N_RUNS = 5;
+
+inline const char* algorithm_name(Algorithm algo)
+{
+    switch (algo) {
+    case Algorithm::RADIX2:
+        return "radix2";
+    case Algorithm::COOLEY_TUKEY:
+        return "cooley_tukey";
+    case Algorithm::GOOD_THOMAS:
+        return "good_thomas";
+    case Algorithm::NAIVE:
+        return "naive";
+    }
+    throw LogicError("FFT planner: unknown algorithm");
+}
+
+inline Algorithm parse_algorithm(const std::string& name)
+{
+    for (Algorithm algo :
+         {Algorithm::RADIX2,
+          Algorithm::COOLEY_TUKEY,
+          Algorithm::GOOD_THOMAS,
+          Algorithm::NAIVE}) {
+        if (name == algorithm_name(algo)) {
+            return algo;
+        }
+    }
+    throw InvalidArgument("FFT planner: unknown algorithm " + name);
+}
+
+/** Planner of the Fourier transforms of the codes, in the spirit of FFTW
+ *
+ * For a field, a length and a packet size, the planner picks one of the
+ * transforms able to compute the DFT, see `get_candidates`:
+ * - in `ESTIMATE` mode, `Radix2` for powers of 2 and `CooleyTukey` otherwise,
+ * - in `MEASURE` mode, the fastest candidate on random packets, a forward and
+ *   an inverse transform being timed.
+ *
+ * Choices are kept as "wisdom", which is looked up before planning. Wisdom
+ * can be exported to and imported from a text file, one choice per line:
+ *
+ *     <element size> <field cardinal> <length> <packet size> <algorithm>
+ *
+ * the element size being `sizeof(T)` in bytes, e.g.
+ * `8 65537 96 1024 good_thomas`. Lines starting with `#` are ignored.
+ *
+ * The codes use the process-wide planner returned by `get`, configured by the
+ * environment:
+ * - `QUADIRON_FFT_PLANNER`: `estimate` (default) or `measure`,
+ * - `QUADIRON_FFT_WISDOM`: path of a wisdom file, imported at the first use
+ *   of the planner and exported whenever a measure adds a choice, failing
+ *   with `InvalidArgument` if it cannot be written.
+ *
+ * Planning is thread-safe.
+ */
+template <typename T>
+class Planner {
+  public:
+    explicit Planner(PlannerMode mode = PlannerMode::ESTIMATE) : mode(mode) {}
+    Planner(const Planner&) = delete;
+    Planner& operator=(const Planner&) = delete;
+
+    static Planner<T>& get();
+
+    std::unique_ptr<FourierTransform<T>>
+    plan(const gf::Field<T>& gf, int n, size_t pkt_size = 0);
+    Algorithm choose(const gf::Field<T>& gf, int n, size_t pkt_size = 0);
+
+    static std::vector<Algorithm> get_candidates(int n);
+    static std::unique_ptr<FourierTransform<T>> create(
+        Algorithm algo,
+        const gf::Field<T>& gf,
+        int n,
+        size_t pkt_size = 0);
+    static double
+    measure(FourierTransform<T>& fft, const gf::Field<T>& gf, size_t pkt_size);
+
+    void set_mode(PlannerMode mode);
+    PlannerMode get_mode() const;
+    void set_wisdom_path(const std::string& path);
+    void import_wisdom(std::istream& is);
+    void export_wisdom(std::ostream& os) const;
+    void forget_wisdom();
+
+  private:
+    static std::string
+    get_key(const gf::Field<T>& gf, int n, size_t pkt_size);
+    static Algorithm estimate(int n);
+    template <typename V>
+    static double
+    time_runs(FourierTransform<T>& fft, V& input, V& output, V& inverse);
+    void save_wisdom() const;
+
+    PlannerMode mode;
+    // path of the wisdom file exported after each measure, if not empty
+    std::string wisdom_path;
+    // chosen algorithm by key, see `get_key`
+    std::map<std::string, Algorithm> wisdom;
+    mutable std::mutex mutex;
+};
+
+/** Get the planner used by the codes
+ *
+ * It is configured by the `QUADIRON_FFT_PLANNER` and `QUADIRON_FFT_WISDOM`
+ * environment variables at its first use.
+ */
+template <typename T>
+Planner<T>& Planner<T>::get()
+{
+    static Planner<T> planner([]() {
+        const char* name = std::getenv("QUADIRON_FFT_PLANNER");
+        if (name == nullptr || *name == '\0'
+            || std::string(name) == "estimate") {
+            return PlannerMode::ESTIMATE;
+        }
+        if (std::string(name) == "measure") {
+            return PlannerMode::MEASURE;
+        }
+        throw InvalidArgument(
+            std::string("QUADIRON_FFT_PLANNER: unknown mode ") + name);
+    }());
+    static std::once_flag wisdom_flag;
+    std::call_once(wisdom_flag, []() {
+        const char* path = std::getenv("QUADIRON_FFT_WISDOM");
+        if (path != nullptr && *path != '\0') {
+            planner.set_wisdom_path(path);
+        }
+    });
+    return planner;
+}
+
+/** Create the transform of length `n` chosen for a field and a packet size
+ *
+ * The transform uses the root `gf.get_nth_root(n)`, as the codes do.
+ *
+ * @param gf field of the transform
+ * @param n length of the transform, dividing the order of the multiplicative
+ * group of `gf`
+ * @param pkt_size size of the packets of Buffers transforms, 0 for vectors
+ * only
+ */
+template <typename T>
+std::unique_ptr<FourierTransform<T>>
+Planner<T>::plan(const gf::Field<T>& gf, int n, size_t pkt_size)
+{
+    return create(choose(gf, n, pkt_size), gf, n, pkt_size);
+}
+
+/// Choose the transform of length `n` for a field and a packet size
+template <typename T>
+Algorithm Planner<T>::choose(const gf::Field<T>& gf, int n, size_t pkt_size)
+{
+    const std::vector<Algorithm> candidates = get_candidates(n);
+    const std::string key = get_key(gf, n, pkt_size);
+
+    {
+        std::lock_guard<std::mutex> guard(mutex);
+
+        auto it = wisdom.find(key);
+        // wisdom may come from another build, check that it still applies
+        if (it != wisdom.end()
+            && std::find(candidates.begin(), candidates.end(), it->second)
+                   != candidates.end()) {
+            return it->second;
+        }
+        if (mode == PlannerMode::ESTIMATE || candidates.size() == 1) {
+            return estimate(n);
+        }
+    }
+
+    // candidates are timed without holding the mutex, so that other threads
+    // can plan meanwhile. Threads measuring the same key keep the last choice.
+    Algorithm best = estimate(n);
+    double best_time = 0;
+    for (Algorithm algo : candidates) {
+        std::unique_ptr<FourierTransform<T>> fft =
+            create(algo, gf, n, pkt_size);
+        const double time = measure(*fft, gf, pkt_size);
+        if (algo == candidates.front() || time < best_time) {
+            best = algo;
+            best_time = time;
+        }
+    }
+
+    std::lock_guard<std::mutex> guard(mutex);
+    wisdom[key] = best;
+    save_wisdom();
+
+    return best;
+}
+
+/** Get the transforms able to compute a DFT of length `n`
+ *
+ * `Radix2` needs a power of 2 and `GoodThomas` at least two coprime factors.
+ * `Naive` is only considered for lengths up to `PLANNER_NAIVE_MAX_LEN`.
+ * `Large` and `Single` are left out as they do not transform buffers, and
+ * `Size2` is used by `CooleyTukey` for its length-2 stages.
+ */
+template <typename T>
+std::vector<Algorithm> Planner<T>::get_candidates(int n)
+{
+    std::vector<Algorithm> candidates;
+    if (arith::is_power_of_2<T>(n)) {
+        candidates.push_back(Algorithm::RADIX2);
+    }
+    candidates.push_back(Algorithm::COOLEY_TUKEY);
+    if (arith::get_coprime_factors<T>(n).size() > 1) {
+        candidates.push_back(Algorithm::GOOD_THOMAS);
+    }
+    if (n <= PLANNER_NAIVE_MAX_LEN) {
+        candidates.push_back(Algorithm::NAIVE);
+    }
+    return candidates;
+}
+
+template <typename T>
+std::unique_ptr<FourierTransform<T>> Planner<T>::create(
+    Algorithm algo,
+    const gf::Field<T>& gf,
+    int n,
+    size_t pkt_size)
+{
+    switch (algo) {
+    case Algorithm::RADIX2:
+        return std::unique_ptr<FourierTransform<T>>(
+            new Radix2<T>(gf, n, 0, pkt_size));
+    case Algorithm::COOLEY_TUKEY:
+        return std::unique_ptr<FourierTransform<T>>(
+            new CooleyTukey<T>(gf, n, 0, nullptr, 0, pkt_size));
+    case Algorithm::GOOD_THOMAS:
+        return std::unique_ptr<FourierTransform<T>>(
+            new GoodThomas<T>(gf, n, 0, nullptr, 0, pkt_size));
+    case Algorithm::NAIVE:
+        return std::unique_ptr<FourierTransform<T>>(
+            new Naive<T>(gf, n, gf.get_nth_root(n), pkt_size));
+    }
+    throw LogicError("FFT planner: unknown algorithm");
+}
+
+/** Time a forward and an inverse transform on random inputs
+ *
+ * Inputs are drawn from a generator of the call, the one of `gf.rand()` being
+ * shared by all threads.
+ *
+ * @return the shortest time of `PLANNER_N_RUNS` runs, in seconds
+ */
+template <typename T>
+double Planner<T>::measure(
+    FourierTransform<T>& fft,
+    const gf::Field<T>& gf,
+    size_t pkt_size)
+{
+    const int n = fft.get_n();
+    const T card = gf.card();
+    std::mt19937 prng(n);
+    std::uniform_int_distribution<uint64_t> distribution;
+    auto rand = [&]() { return static_cast<T>(distribution(prng)) % card; };
+
+    if (pkt_size == 0) {
+        vec::Vector<T> input(gf, n);
+        vec::Vector<T> output(gf, n);
+        vec::Vector<T> inverse(gf, n);
+        for (int i = 0; i < n; ++i) {
+            input.set(i, rand());
+        }
+        return time_runs(fft, input, output, inverse);
+    }
+
+    vec::Buffers<T> input(n, pkt_size);
+    vec::Buffers<T> output(n, pkt_size);
+    vec::Buffers<T> inverse(n, pkt_size);
+    for (int i = 0; i < n; ++i) {
+        T* buf = input.get(i);
+        for (size_t j = 0; j < pkt_size; ++j) {
+            buf[j] = rand();
+        }
+    }
+    return time_runs(fft, input, output, inverse);
+}
+
+template <typename T>
+template <typename V>
+double Planner<T>::time_runs(
+    FourierTransform<T>& fft,
+    V& input,
+    V& output,
+    V& inverse)
+{
+    using Clock = std::chrono::steady_clock;
+
+    // the first run warms up caches and is not timed
+    fft.fft(output, input);
+    fft.ifft(inverse, output);
+
+    double best = 0;
+    for (int run = 0; run < PLANNER_N_RUNS; ++run) {
+        const Clock::time_point start = Clock::now();
+        fft.fft(output, input);
+        fft.ifft(inverse, output);
+        const std::chrono::duration<double> time = Clock::now() - start;
+        if (run == 0 || time.count() < best) {
+            best = time.count();
+        }
+    }
+    return best;
+}
+
+template <typename T>
+void Planner<T>::set_mode(PlannerMode mode)
+{
+    std::lock_guard<std::mutex> guard(mutex);
+    this->mode = mode;
+}
+
+template <typename T>
+PlannerMode Planner<T>::get_mode() const
+{
+    std::lock_guard<std::mutex> guard(mutex);
+    return mode;
+}
+
+/** Set the wisdom file of the planner
+ *
+ * The file is imported if it exists, and exported whenever a measure adds a
+ * choice to the wisdom.
+ */
+template <typename T>
+void Planner<T>::set_wisdom_path(const std::string& path)
+{
+    std::ifstream file(path);
+    if (file) {
+        import_wisdom(file);
+    }
+    std::lock_guard<std::mutex> guard(mutex);
+    wisdom_path = path;
+}
+
+/** Import wisdom, see `Planner` for its format
+ *
+ * Imported choices replace the ones of the same keys.
+ *
+ * @throw InvalidArgument if an entry is malformed
+ */
+template <typename T>
+void Planner<T>::import_wisdom(std::istream& is)
+{
+    std::map<std::string, Algorithm> imported;
+    std::string line;
+    while (std::getline(is, line)) {
+        if (line.empty() || line[0] == '#') {
+            continue;
+        }
+        std::istringstream entry(line);
+        std::string word_size, card, n, pkt_size, name, extra;
+        if (!(entry >> word_size >> card >> n >> pkt_size >> name)
+            || (entry >> extra)) {
+            throw InvalidArgument("FFT wisdom: malformed entry " + line);
+        }
+        imported[word_size + " " + card + " " + n + " " + pkt_size] =
+            parse_algorithm(name);
+    }
+
+    std::lock_guard<std::mutex> guard(mutex);
+    for (const auto& choice : imported) {
+        wisdom[choice.first] = choice.second;
+    }
+}
+
+template <typename T>
+void Planner<T>::export_wisdom(std::ostream& os) const
+{
+    std::lock_guard<std::mutex> guard(mutex);
+    for (const auto& choice : wisdom) {
+        os << choice.first << " " << algorithm_name(choice.second) << "\n";
+    }
+}
+
+template <typename T>
+void Planner<T>::forget_wisdom()
+{
+    std::lock_guard<std::mutex> guard(mutex);
+    wisdom.clear();
+}
+
+template <typename T>
+std::string
+Planner<T>::get_key(const gf::Field<T>& gf, int n, size_t pkt_size)
+{
+    std::ostringstream key;
+    key << sizeof(T) << " " << gf.card() << " " << n << " " << pkt_size;
+    return key.str();
+}
+
+template <typename T>
+Algorithm Planner<T>::estimate(int n)
+{
+    if (arith::is_power_of_2<T>(n)) {
+        return Algorithm::RADIX2;
+    }
+    return Algorithm::COOLEY_TUKEY;
+}
+
+/** Export the wisdom to its file, the mutex being held
+ *
+ * @throw InvalidArgument if the file cannot be written
+ */
+template <typename T>
+void Planner<T>::save_wisdom() const
+{
+    if (wisdom_path.empty()) {
+        return;
+    }
+    std::ofstream file(wisdom_path);
+    if (!file) {
+        throw InvalidArgument("FFT wisdom: cannot write " + wisdom_path);
+    }
+    for (const auto& choice : wisdom) {
+        file << choice.first << " " << algorithm_name(choice.second) << "\n";
+    }
+}
+
+} // namespace fft
+} // namespace quadiron
+
+#endif
@@ -0,0 +1,430 @@
+/* -*- mode: c++ -*- */
+/*
+ * Copyright 2017-2018 Scality
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its contributors
+ *    may be used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+#ifndef __QUAD_FFT_RADER_H__
+#define __QUAD_FFT_RADER_H__
+
+#include <algorithm>
+#include <memory>
+#include <vector>
+
+#include "arith.h"
+#include "exceptions.h"
+#include "fft_2n.h"
+#include "fft_base.h"
+#include "fft_naive.h"
+#include "gf_base.h"
+#include "vec_buffers.h"
+#include "vec_vector.h"
+
+namespace quadiron {
+namespace fft {
+
+/** Rader's algorithm for the DFT of a prime length.
+ *
+ * For a prime length \f$p\f$ and a generator \f$g\f$ of the multiplicative
+ * group modulo \f$p\f$, outputs are reindexed so that the DFT becomes a
+ * cyclic convolution of length \f$p - 1\f$:
+ * \f[
+ *   X_0 = \sum_j x_j, \quad
+ *   X_{g^{-q}} = x_0 + \sum_{s=0}^{p-2} x_{g^s} w^{g^{-(q-s)}}
+ * \f]
+ *
+ * The convolution is computed by a radix-2 FFT of length \f$N \geq 2p - 3\f$,
+ * the transform of the powers of \f$w\f$ being precomputed, hence the DFT
+ * costs \f$O(N \log N)\f$ instead of \f$O(p^2)\f$.
+ *
+ * It needs such a power of 2 \f$N\f$ dividing the order of the multiplicative
+ * group of the field, see `get_conv_len`: e.g. prime fields whose `p - 1` has
+ * a large power of 2.
+ */
+template <typename T>
+class Rader : public FourierTransform<T> {
+  public:
+    Rader(const gf::Field<T>& gf, int n, T w, size_t pkt_size = 0);
+    ~Rader() = default;
+    void fft(vec::Vector<T>& output, vec::Vector<T>& input) override;
+    void ifft(vec::Vector<T>& output, vec::Vector<T>& input) override;
+    void fft_inv(vec::Vector<T>& output, vec::Vector<T>& input) override;
+    void fft(vec::Buffers<T>& output, vec::Buffers<T>& input) override;
+    void ifft(vec::Buffers<T>& output, vec::Buffers<T>& input) override;
+    void fft_inv(vec::Buffers<T>& output, vec::Buffers<T>& input) override;
+    std::unique_ptr<Scratch<T>> make_scratch() const override;
+    void fft_ws(
+        vec::Buffers<T>& output,
+        vec::Buffers<T>& input,
+        Scratch<T>& scratch) override;
+    void ifft_ws(
+        vec::Buffers<T>& output,
+        vec::Buffers<T>& input,
+        Scratch<T>& scratch) override;
+    void fft_inv_ws(
+        vec::Buffers<T>& output,
+        vec::Buffers<T>& input,
+        Scratch<T>& scratch) override;
+
+    static int get_conv_len(const gf::Field<T>& gf, int n);
+
+  private:
+    /// Scratch memory of Buffers transforms
+    class RaderScratch : public Scratch<T> {
+      public:
+        RaderScratch(int conv_len, int fft_len, size_t pkt_size);
+
+        // transform of the convolution
+        vec::Buffers<T> bufs;
+        // last buffers of the output of the convolution, which are not
+        // wanted
+        vec::Buffers<T> tail_bufs;
+        // views on x_{g^s}, bound at each transform
+        std::unique_ptr<vec::Buffers<T>> a_bufs = nullptr;
+        // view on X_{g^{-q}} followed by `tail_bufs`, the former being
+        // bound at each transform
+        std::unique_ptr<vec::Buffers<T>> c_bufs = nullptr;
+    };
+
+    void compute_conv_coefs(vec::Vector<T>& _coefs, T _w);
+    void _fft(
+        vec::Vector<T>& output,
+        vec::Vector<T>& input,
+        vec::Vector<T>& _coefs);
+    void _fft(
+        vec::Buffers<T>& output,
+        vec::Buffers<T>& input,
+        vec::Vector<T>& _coefs,
+        Scratch<T>& scratch);
+
+    T w;
+    T inv_w;
+    size_t pkt_size;
+    // length of the cyclic convolution, i.e. `n - 1`
+    int conv_len;
+    // length of the FFT computing the convolution
+    int fft_len;
+    // perm[s] = g^s mod n
+    std::vector<int> perm;
+    // inv_perm[q] = g^(-q) mod n
+    std::vector<int> inv_perm;
+    std::unique_ptr<Radix2<T>> dft_conv = nullptr;
+    // FFT of the powers of w, respectively inv_w, divided by `fft_len`
+    std::unique_ptr<vec::Vector<T>> coefs = nullptr;
+    std::unique_ptr<vec::Vector<T>> inv_coefs = nullptr;
+    // scratch memory
+    std::unique_ptr<vec::Vector<T>> vec_a = nullptr;
+    std::unique_ptr<vec::Vector<T>> vec1 = nullptr;
+    std::unique_ptr<vec::Vector<T>> vec2 = nullptr;
+};
+
+/** Get the length of the FFT computing the convolution of a DFT of length n
+ *
+ * @param gf field of the DFT
+ * @param n a prime length
+ * @return the smallest power of 2 at least `2n - 3` that divides `p - 1`, `p`
+ * being the characteristic of `gf`, or 0 if there is none
+ */
+template <typename T>
+int Rader<T>::get_conv_len(const gf::Field<T>& gf, int n)
+{
+    if (n < 3) {
+        return 0;
+    }
+    const T order = gf.get_p() - 1;
+    const T len = arith::ceil2<T>(2 * n - 3);
+    if (order % len != 0) {
+        return 0;
+    }
+    return static_cast<int>(len);
+}
+
+/** Initialize the DFT
+ *
+ * @param n a prime length such that `get_conv_len` is not 0
+ * @param w n-th root of unity
+ * @param pkt_size size of packets of Buffers transforms, 0 if only vectors
+ * are transformed
+ */
+template <typename T>
+Rader<T>::Rader(const gf::Field<T>& gf, int n, T w, size_t pkt_size)
+    : FourierTransform<T>(gf, n)
+{
+    fft_len = get_conv_len(gf, n);
+    if (fft_len == 0 || !arith::is_prime<int>(n)) {
+        throw InvalidArgument("Rader: no convolution for this length");
+    }
+    this->w = w;
+    this->inv_w = gf.inv(w);
+    this->pkt_size = pkt_size;
+    conv_len = n - 1;
+
+    // smallest generator of the multiplicative group modulo n
+    const uint64_t order = conv_len;
+    const std::vector<uint64_t> factors =
+        arith::factor_distinct_prime<uint64_t>(order);
+    uint64_t g = 2;
+    for (;; g++) {
+        bool is_generator = true;
+        for (uint64_t factor : factors) {
+            if (arith::exp_mod<uint64_t>(g, order / factor, n) == 1) {
+                is_generator = false;
+                break;
+            }
+        }
+        if (is_generator) {
+            break;
+        }
+    }
+    perm.resize(conv_len);
+    inv_perm.resize(conv_len);
+    perm[0] = 1;
+    for (int s = 1; s < conv_len; s++) {
+        perm[s] = static_cast<int>((perm[s - 1] * g) % n);
+    }
+    for (int q = 0; q < conv_len; q++) {
+        inv_perm[q] = perm[(conv_len - q) % conv_len];
+    }
+
+    // the padding of `Radix2` needs a data length dividing `fft_len`
+    dft_conv = std::unique_ptr<Radix2<T>>(new Radix2<T>(
+        gf, fft_len, arith::ceil2<int>(conv_len), pkt_size));
+
+    vec_a = std::unique_ptr<vec::Vector<T>>(new vec::Vector<T>(gf, conv_len));
+    vec1 = std::unique_ptr<vec::Vector<T>>(new vec::Vector<T>(gf, fft_len));
+    vec2 = std::unique_ptr<vec::Vector<T>>(new vec::Vector<T>(gf, fft_len));
+    coefs = std::unique_ptr<vec::Vector<T>>(new vec::Vector<T>(gf, fft_len));
+    inv_coefs =
+        std::unique_ptr<vec::Vector<T>>(new vec::Vector<T>(gf, fft_len));
+    compute_conv_coefs(*coefs, w);
+    compute_conv_coefs(*inv_coefs, inv_w);
+}
+
+template <typename T>
+Rader<T>::RaderScratch::RaderScratch(
+    int conv_len,
+    int fft_len,
+    size_t pkt_size)
+    : bufs(fft_len, pkt_size), tail_bufs(fft_len - conv_len, pkt_size)
+{
+    a_bufs = make_view<T>(conv_len, pkt_size);
+    const std::unique_ptr<vec::Buffers<T>> c_head =
+        make_view<T>(conv_len, pkt_size);
+    c_bufs = std::make_unique<vec::Buffers<T>>(*c_head, tail_bufs);
+}
+
+template <typename T>
+std::unique_ptr<Scratch<T>> Rader<T>::make_scratch() const
+{
+    return std::make_unique<RaderScratch>(conv_len, fft_len, pkt_size);
+}
+
+/** Compute the FFT of the second operand of the convolution
+ *
+ * The powers \f$b_m = w^{g^{-m}}\f$ are stored at `m` and, but for `m` = 0,
+ * at `fft_len - conv_len + m` so that the cyclic convolution of length
+ * `fft_len` equals the one of length `conv_len` on its first outputs.
+ *
+ * @param _coefs output vector of `fft_len` elements
+ * @param _w n-th root of unity
+ */
+template <typename T>
+void Rader<T>::compute_conv_coefs(vec::Vector<T>& _coefs, T _w)
+{
+    vec1->zero_fill();
+    for (int m = 0; m < conv_len; m++) {
+        const T b = this->gf->exp(_w, inv_perm[m]);
+        vec1->set(m, b);
+        if (m > 0) {
+            vec1->set(fft_len - conv_len + m, b);
+        }
+    }
+    dft_conv->fft(_coefs, *vec1);
+    _coefs.mul_scalar(this->gf->get_inv_n_mod_p(fft_len));
+}
+
+template <typename T>
+void Rader<T>::_fft(
+    vec::Vector<T>& output,
+    vec::Vector<T>& input,
+    vec::Vector<T>& _coefs)
+{
+    const T x0 = input.get(0);
+    T sum = x0;
+    for (int s = 0; s < conv_len; s++) {
+        const T x = input.get(perm[s]);
+        vec_a->set(s, x);
+        sum = this->gf->add(sum, x);
+    }
+
+    dft_conv->fft(*vec1, *vec_a);
+    vec1->hadamard_mul(&_coefs);
+    dft_conv->fft_inv(*vec2, *vec1);
+
+    output.set(0, sum);
+    for (int q = 0; q < conv_len; q++) {
+        output.set(inv_perm[q], this->gf->add(x0, vec2->get(q)));
+    }
+}
+
+template <typename T>
+void Rader<T>::fft(vec::Vector<T>& output, vec::Vector<T>& input)
+{
+    _fft(output, input, *coefs);
+}
+
+/*
+ * This function performs an inverse DFT formular without a multiplication to
+ * the coefficient (n^(-1) mod p)
+ */
+template <typename T>
+void Rader<T>::fft_inv(vec::Vector<T>& output, vec::Vector<T>& input)
+{
+    _fft(output, input, *inv_coefs);
+}
+
+template <typename T>
+void Rader<T>::ifft(vec::Vector<T>& output, vec::Vector<T>& input)
+{
+    fft_inv(output, input);
+    if (this->inv_n_mod_p > 1)
+        output.mul_scalar(this->inv_n_mod_p);
+}
+
+template <typename T>
+void Rader<T>::_fft(
+    vec::Buffers<T>& output,
+    vec::Buffers<T>& input,
+    vec::Vector<T>& _coefs,
+    Scratch<T>& scratch)
+{
+    RaderScratch& rs = static_cast<RaderScratch&>(scratch);
+    vec::Buffers<T>& a_bufs = *rs.a_bufs;
+    vec::Buffers<T>& c_bufs = *rs.c_bufs;
+    const size_t size = this->pkt_size;
+    T* x0 = input.get(0);
+
+    // x_{g^s} are gathered by a view
+    for (int s = 0; s < conv_len; s++) {
+        a_bufs.set(s, input.get(perm[s]));
+    }
+
+    // the convolution is computed in place of X_{g^{-q}}
+    for (int q = 0; q < conv_len; q++) {
+        c_bufs.set(q, output.get(inv_perm[q]));
+    }
+
+    dft_conv->fft(rs.bufs, a_bufs);
+    // the field falls back to scalar products when its prime is not the
+    // Fermat prime of the vectorized kernels
+    this->gf->mul_vec_to_vecp(_coefs, rs.bufs, rs.bufs);
+    dft_conv->fft_inv(c_bufs, rs.bufs);
+
+    T* sum = output.get(0);
+    std::copy_n(x0, size, sum);
+    for (int s = 0; s < conv_len; s++) {
+        this->gf->add_two_bufs(a_bufs.get(s), sum, size);
+        this->gf->add_two_bufs(x0, c_bufs.get(s), size);
+    }
+}
+
+template <typename T>
+void Rader<T>::fft(vec::Buffers<T>& output, vec::Buffers<T>& input)
+{
+    fft_ws(output, input, this->get_scratch());
+}
+
+template <typename T>
+void Rader<T>::fft_inv(vec::Buffers<T>& output, vec::Buffers<T>& input)
+{
+    fft_inv_ws(output, input, this->get_scratch());
+}
+
+template <typename T>
+void Rader<T>::ifft(vec::Buffers<T>& output, vec::Buffers<T>& input)
+{
+    ifft_ws(output, input, this->get_scratch());
+}
+
+template <typename T>
+void Rader<T>::fft_ws(
+    vec::Buffers<T>& output,
+    vec::Buffers<T>& input,
+    Scratch<T>& scratch)
+{
+    _fft(output, input, *coefs, scratch);
+}
+
+template <typename T>
+void Rader<T>::fft_inv_ws(
+    vec::Buffers<T>& output,
+    vec::Buffers<T>& input,
+    Scratch<T>& scratch)
+{
+    _fft(output, input, *inv_coefs, scratch);
+}
+
+template <typename T>
+void Rader<T>::ifft_ws(
+    vec::Buffers<T>& output,
+    vec::Buffers<T>& input,
+    Scratch<T>& scratch)
+{
+    fft_inv_ws(output, input, scratch);
+
+    // We need to divide output to `N` for the inverse formular
+    this->gf->mul_vec_to_vecp(*(this->vec_inv_n), output, output);
+}
+
+/** Create the DFT of a leaf of mixed-radix FFTs
+ *
+ * Rader's algorithm is used for a prime length when its convolution needs
+ * fewer products than the naive DFT, i.e. for primes that are not too small.
+ *
+ * @param gf field of the DFT
+ * @param n length of the DFT
+ * @param w n-th root of unity
+ * @param pkt_size size of packets of Buffers transforms
+ * @return the DFT, owned by the caller
+ */
+template <typename T>
+FourierTransform<T>*
+create_leaf_dft(const gf::Field<T>& gf, int n, T w, size_t pkt_size = 0)
+{
+    const int len = Rader<T>::get_conv_len(gf, n);
+    // two FFTs and a Hadamard product against about n^2 products
+    if (len > 0 && len * (arith::log2<int>(len) + 1) < n * n
+        && arith::is_prime<int>(n)) {
+        return new Rader<T>(gf, n, w, pkt_size);
+    }
+    return new Naive<T>(gf, n, w, pkt_size);
+}
+
+} // namespace fft
+} // namespace quadiron
+
+#endif
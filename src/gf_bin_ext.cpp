@@ -0,0 +1,201 @@
+/*
+ * Copyright 2017-2018 Scality
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its contributors
+ *    may be used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <algorithm>
+
+#include "gf_bin_ext.h"
+
+#ifdef QUADIRON_USE_SIMD
+
+#include "simd.h"
+
+namespace quadiron {
+namespace gf {
+
+namespace {
+
+/** Minimal buffer length, in symbols, for the nibble lookup tables
+ *
+ * Filling the tables costs a few dozen operations per call, it is only
+ * amortized on buffers long enough.
+ */
+constexpr size_t MUL_TABLES_MIN_LEN = 64;
+
+/** Check if products by `a` can use the nibble lookup tables
+ *
+ * They are available for GF(2^8) and GF(2^16), except in the restricted case
+ * where elements fill the whole word, and worth it when the buffer is at least
+ * `MUL_TABLES_MIN_LEN` symbols long.
+ */
+template <typename T>
+bool use_mul_tables(const BinExtension<T>& gf, T a, size_t len)
+{
+    const unsigned n = gf.get_n();
+    return a > 1 && (n == 8 || n == 16) && n < 8 * sizeof(T)
+           && len >= std::max(MUL_TABLES_MIN_LEN, simd::vec_countof<T>());
+}
+
+/** Fill lookup tables to multiply by `a`
+ *
+ * Products are linear in the nibble: only the products by its 4 bits are
+ * computed, the other entries are XOR combinations of them.
+ */
+template <typename T>
+void init_mul_tables(
+    const BinExtension<T>& gf,
+    T a,
+    simd::Gf2nMulTables& tables)
+{
+    tables.nb_nibbles = gf.get_n() / 4;
+    for (unsigned i = 0; i < tables.nb_nibbles; i++) {
+        T prods[16];
+        prods[0] = 0;
+        for (unsigned b = 0; b < 4; b++) {
+            const unsigned bit = 1U << b;
+            prods[bit] = gf.mul(a, T(1) << (4 * i + b));
+            for (unsigned v = 1; v < bit; v++) {
+                prods[bit | v] = prods[bit] ^ prods[v];
+            }
+        }
+        for (unsigned v = 0; v < 16; v++) {
+            tables.lo_bytes[i][v] = prods[v] & 0xff;
+            tables.hi_bytes[i][v] = (prods[v] >> 8) & 0xff;
+        }
+    }
+}
+
+} // namespace
+
+template <>
+void BinExtension<uint16_t>::mul_coef_to_buf(
+    uint16_t a,
+    uint16_t* src,
+    uint16_t* dest,
+    size_t len) const
+{
+    if (!use_mul_tables(*this, a, len)) {
+        _mul_coef_to_buf(a, src, dest, len);
+        return;
+    }
+    simd::Gf2nMulTables tables;
+    init_mul_tables(*this, a, tables);
+    simd::kernels<uint16_t>().gf2n_mul_coef_to_buf(tables, src, dest, len);
+}
+
+template <>
+void BinExtension<uint32_t>::mul_coef_to_buf(
+    uint32_t a,
+    uint32_t* src,
+    uint32_t* dest,
+    size_t len) const
+{
+    if (!use_mul_tables(*this, a, len)) {
+        _mul_coef_to_buf(a, src, dest, len);
+        return;
+    }
+    simd::Gf2nMulTables tables;
+    init_mul_tables(*this, a, tables);
+    simd::kernels<uint32_t>().gf2n_mul_coef_to_buf(tables, src, dest, len);
+}
+
+template <>
+void BinExtension<uint16_t>::mul_coef_add_to_buf(
+    uint16_t a,
+    uint16_t* src,
+    uint16_t* dest,
+    size_t len) const
+{
+    if (!use_mul_tables(*this, a, len)) {
+        _mul_coef_add_to_buf(a, src, dest, len);
+        return;
+    }
+    simd::Gf2nMulTables tables;
+    init_mul_tables(*this, a, tables);
+    simd::kernels<uint16_t>().gf2n_mul_coef_add_to_buf(tables, src, dest, len);
+}
+
+template <>
+void BinExtension<uint32_t>::mul_coef_add_to_buf(
+    uint32_t a,
+    uint32_t* src,
+    uint32_t* dest,
+    size_t len) const
+{
+    if (!use_mul_tables(*this, a, len)) {
+        _mul_coef_add_to_buf(a, src, dest, len);
+        return;
+    }
+    simd::Gf2nMulTables tables;
+    init_mul_tables(*this, a, tables);
+    simd::kernels<uint32_t>().gf2n_mul_coef_add_to_buf(tables, src, dest, len);
+}
+
+template <>
+void BinExtension<uint16_t>::add_two_bufs(
+    uint16_t* src,
+    uint16_t* dest,
+    size_t len) const
+{
+    simd::kernels<uint16_t>().xor_two_bufs(src, dest, len);
+}
+
+template <>
+void BinExtension<uint32_t>::add_two_bufs(
+    uint32_t* src,
+    uint32_t* dest,
+    size_t len) const
+{
+    simd::kernels<uint32_t>().xor_two_bufs(src, dest, len);
+}
+
+template <>
+void BinExtension<uint16_t>::sub_two_bufs(
+    uint16_t* bufa,
+    uint16_t* bufb,
+    uint16_t* res,
+    size_t len) const
+{
+    simd::kernels<uint16_t>().xor_bufs(bufa, bufb, res, len);
+}
+
+template <>
+void BinExtension<uint32_t>::sub_two_bufs(
+    uint32_t* bufa,
+    uint32_t* bufb,
+    uint32_t* res,
+    size_t len) const
+{
+    simd::kernels<uint32_t>().xor_bufs(bufa, bufb, res, len);
+}
+
+} // namespace gf
+} // namespace quadiron
+
+#endif // #ifdef QUADIRON_USE_SIMD
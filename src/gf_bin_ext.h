@@ -31,6 +31,7 @@
 #ifndef __QUAD_GF_BIN_EXT_H__
 #define __QUAD_GF_BIN_EXT_H__
 
+#include <algorithm>
 #include <limits>
 
 #include "exceptions.h"
@@ -56,6 +57,16 @@ class BinExtension : public gf::Field<T> {
     T exp(T a, T b) const override;
     T log(T a, T b) const override;
     void hadamard_mul(int n, T* x, T* y) const override;
+    void mul_coef_to_buf(T a, T* src, T* dest, size_t len) const override;
+    void mul_coef_add_to_buf(T a, T* src, T* dest, size_t len) const override;
+    void mul_vec_to_vecp(
+        vec::Vector<T>& u,
+        vec::Buffers<T>& src,
+        vec::Buffers<T>& dest) const override;
+    void add_two_bufs(T* src, T* dest, size_t len) const override;
+    void sub_two_bufs(T* bufa, T* bufb, T* res, size_t len) const override;
+    using gf::Field<T>::neg;
+    void neg(size_t n, T* x) const override;
 
     BinExtension(BinExtension&&) = default;
 
@@ -80,6 +91,8 @@ class BinExtension : public gf::Field<T> {
     T _div_by_inv(T a, T b) const;
     T _inv_by_div(T a) const;
     T _inv_ext_gcd(T a) const;
+    void _mul_coef_to_buf(T a, T* src, T* dest, size_t len) const;
+    void _mul_coef_add_to_buf(T a, T* src, T* dest, size_t len) const;
     int mul_type;
     int div_type;
     int inv_type;
@@ -590,6 +603,200 @@ inline void BinExtension<T>::hadamard_mul(int n, T* x, T* y) const
     }
 }
 
+/** Multiply a buffer by a coefficient: for each i, dest[i] = a * src[i]
+ *
+ * @note SIMD builds use nibble lookup tables for GF(2^8) and GF(2^16)
+ */
+template <typename T>
+inline void
+BinExtension<T>::mul_coef_to_buf(T a, T* src, T* dest, size_t len) const
+{
+    _mul_coef_to_buf(a, src, dest, len);
+}
+
+/* The logarithm of `a` is looked up once for the whole buffer so that the
+ * inner loop costs two table lookups per symbol and no virtual call.
+ */
+template <typename T>
+inline void
+BinExtension<T>::_mul_coef_to_buf(T a, T* src, T* dest, size_t len) const
+{
+    size_t i;
+
+    if (a == 0) {
+        std::fill_n(dest, len, 0);
+        return;
+    }
+    if (a == 1) {
+        if (src != dest)
+            std::copy_n(src, len, dest);
+        return;
+    }
+    if (mul_type == MUL_LOG_TAB) {
+        const T log_a = gflog[a];
+        const T order = my_card - 1;
+        for (i = 0; i < len; i++) {
+            const T x = src[i];
+            if (x == 0) {
+                dest[i] = 0;
+            } else {
+                T sum_log = gflog[x] + log_a;
+                if (sum_log >= order)
+                    sum_log -= order;
+                dest[i] = gfilog[sum_log];
+            }
+        }
+    } else {
+        for (i = 0; i < len; i++) {
+            dest[i] = _mul_split(a, src[i]);
+        }
+    }
+}
+
+/** Multiply-accumulate a buffer: for each i, dest[i] = dest[i] + a * src[i]
+ */
+template <typename T>
+inline void
+BinExtension<T>::mul_coef_add_to_buf(T a, T* src, T* dest, size_t len) const
+{
+    _mul_coef_add_to_buf(a, src, dest, len);
+}
+
+template <typename T>
+inline void
+BinExtension<T>::_mul_coef_add_to_buf(T a, T* src, T* dest, size_t len) const
+{
+    size_t i;
+
+    if (a == 0) {
+        return;
+    }
+    if (a == 1) {
+        add_two_bufs(src, dest, len);
+        return;
+    }
+    if (mul_type == MUL_LOG_TAB) {
+        const T log_a = gflog[a];
+        const T order = my_card - 1;
+        for (i = 0; i < len; i++) {
+            const T x = src[i];
+            if (x != 0) {
+                T sum_log = gflog[x] + log_a;
+                if (sum_log >= order)
+                    sum_log -= order;
+                dest[i] ^= gfilog[sum_log];
+            }
+        }
+    } else {
+        for (i = 0; i < len; i++) {
+            dest[i] ^= _mul_split(a, src[i]);
+        }
+    }
+}
+
+/** Element-wise multiplication of buffers by coefficients of a vector
+ *
+ * Unlike in prime fields, `card - 1` is not the opposite of one in
+ * characteristic 2, hence only 0 and 1 are handled as special cases.
+ */
+template <typename T>
+inline void BinExtension<T>::mul_vec_to_vecp(
+    vec::Vector<T>& u,
+    vec::Buffers<T>& src,
+    vec::Buffers<T>& dest) const
+{
+    assert(u.get_n() == src.get_n());
+    const int n = u.get_n();
+    const size_t len = src.get_size();
+    const std::vector<T*>& src_mem = src.get_mem();
+    const std::vector<T*>& dest_mem = dest.get_mem();
+    for (int i = 0; i < n; i++) {
+        this->mul_coef_to_buf(u.get(i), src_mem[i], dest_mem[i], len);
+    }
+}
+
+template <typename T>
+inline void BinExtension<T>::add_two_bufs(T* src, T* dest, size_t len) const
+{
+    for (size_t i = 0; i < len; i++) {
+        dest[i] ^= src[i];
+    }
+}
+
+template <typename T>
+inline void
+BinExtension<T>::sub_two_bufs(T* bufa, T* bufb, T* res, size_t len) const
+{
+    for (size_t i = 0; i < len; i++) {
+        res[i] = bufa[i] ^ bufb[i];
+    }
+}
+
+// Every element is its own opposite in characteristic 2
+template <typename T>
+inline void BinExtension<T>::neg(size_t, T*) const
+{
+}
+
+#ifdef QUADIRON_USE_SIMD
+/* Operations are vectorized by SIMD */
+
+template <>
+void BinExtension<uint16_t>::mul_coef_to_buf(
+    uint16_t a,
+    uint16_t* src,
+    uint16_t* dest,
+    size_t len) const;
+
+template <>
+void BinExtension<uint32_t>::mul_coef_to_buf(
+    uint32_t a,
+    uint32_t* src,
+    uint32_t* dest,
+    size_t len) const;
+
+template <>
+void BinExtension<uint16_t>::mul_coef_add_to_buf(
+    uint16_t a,
+    uint16_t* src,
+    uint16_t* dest,
+    size_t len) const;
+
+template <>
+void BinExtension<uint32_t>::mul_coef_add_to_buf(
+    uint32_t a,
+    uint32_t* src,
+    uint32_t* dest,
+    size_t len) const;
+
+template <>
+void BinExtension<uint16_t>::add_two_bufs(
+    uint16_t* src,
+    uint16_t* dest,
+    size_t len) const;
+
+template <>
+void BinExtension<uint32_t>::add_two_bufs(
+    uint32_t* src,
+    uint32_t* dest,
+    size_t len) const;
+
+template <>
+void BinExtension<uint16_t>::sub_two_bufs(
+    uint16_t* bufa,
+    uint16_t* bufb,
+    uint16_t* res,
+    size_t len) const;
+
+template <>
+void BinExtension<uint32_t>::sub_two_bufs(
+    uint32_t* bufa,
+    uint32_t* bufb,
+    uint32_t* res,
+    size_t len) const;
+
+#endif // #ifdef QUADIRON_USE_SIMD
+
 } // namespace gf
 } // namespace quadiron
 
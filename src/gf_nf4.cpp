@@ -30,7 +30,7 @@
 
 #include "gf_nf4.h"
 
-#ifdef QUADIRON_USE_SIMD
+#if defined(QUADIRON_USE_SIMD) && defined(QUADIRON_SIMD_NF4)
 
 #include "simd.h"
 
@@ -40,66 +40,66 @@ namespace gf {
 template <>
 __uint128_t NF4<__uint128_t>::expand16(uint16_t* arr) const
 {
-    return simd::expand16(arr, this->n);
+    return simd::nf4_kernels().expand16(arr, this->n);
 }
 
 template <>
 __uint128_t NF4<__uint128_t>::expand32(uint32_t* arr) const
 {
-    return simd::expand32(arr, this->n);
+    return simd::nf4_kernels().expand32(arr, this->n);
 }
 
 template <>
 __uint128_t NF4<__uint128_t>::add(__uint128_t a, __uint128_t b) const
 {
-    __uint128_t c = simd::add(a, b);
+    __uint128_t c = simd::nf4_kernels().add(a, b);
     return c;
 }
 
 template <>
 __uint128_t NF4<__uint128_t>::sub(__uint128_t a, __uint128_t b) const
 {
-    return simd::sub(a, b);
+    return simd::nf4_kernels().sub(a, b);
 }
 
 template <>
 __uint128_t NF4<__uint128_t>::mul(__uint128_t a, __uint128_t b) const
 {
-    return simd::mul(a, b);
+    return simd::nf4_kernels().mul(a, b);
 }
 
 template <>
 void NF4<__uint128_t>::hadamard_mul(int n, __uint128_t* x, __uint128_t* y) const
 {
-    simd::hadamard_mul(n, x, y);
+    simd::nf4_kernels().hadamard_mul(n, x, y);
 }
 
 template <>
 GroupedValues<__uint128_t> NF4<__uint128_t>::unpack(__uint128_t a) const
 {
-    return simd::unpack(a);
+    return simd::nf4_kernels().unpack(a);
 }
 
 template <>
 void NF4<__uint128_t>::unpack(__uint128_t a, GroupedValues<__uint128_t>& b)
     const
 {
-    simd::unpack(a, b);
+    simd::nf4_kernels().unpack_to(a, b);
 }
 
 template <>
 __uint128_t NF4<__uint128_t>::pack(__uint128_t a) const
 {
-    return simd::pack(a);
+    return simd::nf4_kernels().pack(a);
 }
 
 template <>
 __uint128_t NF4<__uint128_t>::pack(__uint128_t a, uint32_t flag) const
 {
-    return simd::pack(a, flag);
+    return simd::nf4_kernels().pack_flag(a, flag);
 }
 
 } // namespace gf
 } // namespace quadiron
 
-#endif // #ifdef QUADIRON_USE_SIMD
+#endif // #if defined(QUADIRON_USE_SIMD) && defined(QUADIRON_SIMD_NF4)
@@ -488,7 +488,7 @@ inline void NF4<T>::hadamard_mul(int n, T* x, T* y) const
     }
 }
 
-#ifdef QUADIRON_USE_SIMD
+#if defined(QUADIRON_USE_SIMD) && defined(QUADIRON_SIMD_NF4)
 /* Operations are vectorized by SIMD */
 
 template <>
@@ -523,7 +523,7 @@ template <>
 void NF4<__uint128_t>::hadamard_mul(int n, __uint128_t* x, __uint128_t* y)
     const;
 
-#endif // #ifdef QUADIRON_USE_SIMD
+#endif // #if defined(QUADIRON_USE_SIMD) && defined(QUADIRON_SIMD_NF4)
 
 } // namespace gf
 } // namespace quadiron
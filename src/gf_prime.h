@@ -31,21 +31,42 @@
 #ifndef __QUAD_GF_PRIME_H__
 #define __QUAD_GF_PRIME_H__
 
+#include <type_traits>
+
 #include "gf_base.h"
 
 namespace quadiron {
 namespace gf {
 
-/** A Galois Field whose order is a prime number. */
+/** A Galois Field whose order is a prime number.
+ *
+ * Products are reduced by Barrett reduction instead of a division when the
+ * order is lower than a quarter of the range of `T`, see
+ * `arith::mul_barrett`.
+ *
+ * The class is final: operations called on a `Prime` object are not virtual
+ * calls, they can be inlined in loops, see `fft::Radix2::with_field`.
+ */
 template <typename T>
-class Prime : public gf::Field<T> {
+class Prime final : public gf::Field<T> {
   public:
     Prime(Prime&&) = default;
+    T mul(T a, T b) const override;
     T inv_exp(T a);
 
   private:
     explicit Prime(T p);
 
+    void init_barrett(std::true_type);
+    void init_barrett(std::false_type) {}
+    T mul_barrett(T a, T b, std::true_type) const;
+    T mul_barrett(T a, T b, std::false_type) const;
+
+    // parameters of the Barrett reduction, `barrett_len` is 0 if it is not
+    // used
+    unsigned barrett_len = 0;
+    T barrett_factor = 0;
+
     template <typename Class, typename... Args>
     friend Class create(Args... args);
 
@@ -56,6 +77,40 @@ class Prime : public gf::Field<T> {
 template <typename T>
 Prime<T>::Prime(T p) : gf::Field<T>(p, 1)
 {
+    init_barrett(arith::HasFastModMul<T>());
+}
+
+template <typename T>
+void Prime<T>::init_barrett(std::true_type)
+{
+    barrett_len = arith::barrett_len(this->p);
+    if (barrett_len > 0) {
+        barrett_factor = arith::barrett_factor(this->p);
+    }
+}
+
+template <typename T>
+inline T Prime<T>::mul(T a, T b) const
+{
+    if (barrett_len == 0) {
+        return gf::Field<T>::mul(a, b);
+    }
+    return mul_barrett(a, b, arith::HasFastModMul<T>());
+}
+
+template <typename T>
+inline T Prime<T>::mul_barrett(T a, T b, std::true_type) const
+{
+    assert(this->check(a));
+    assert(this->check(b));
+
+    return arith::mul_barrett(a, b, this->p, barrett_factor, barrett_len);
+}
+
+template <typename T>
+inline T Prime<T>::mul_barrett(T a, T b, std::false_type) const
+{
+    return gf::Field<T>::mul(a, b);
 }
 
 /// Inverse by exponentiation.
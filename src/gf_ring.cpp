@@ -34,19 +34,32 @@
 #include "simd.h"
 #include "simd/simd.h"
 
+/*
+ * Modular kernels are specialized for the Fermat prime fitting their lanes,
+ * other rings use scalar operations.
+ */
+
 namespace quadiron {
 namespace gf {
 
 template <>
 void RingModN<uint16_t>::neg(size_t n, uint16_t* x) const
 {
-    simd::neg(n, x, this->_card);
+    if (!simd::is_kernel_card(this->_card)) {
+        _neg(n, x);
+        return;
+    }
+    simd::kernels<uint16_t>().neg(n, x, this->_card);
 }
 
 template <>
 void RingModN<uint32_t>::neg(size_t n, uint32_t* x) const
 {
-    simd::neg(n, x, this->_card);
+    if (!simd::is_kernel_card(this->_card)) {
+        _neg(n, x);
+        return;
+    }
+    simd::kernels<uint32_t>().neg(n, x, this->_card);
 }
 
 template <>
@@ -56,14 +69,37 @@ void RingModN<uint32_t>::mul_coef_to_buf(
     uint32_t* dest,
     size_t len) const
 {
-    simd::mul_coef_to_buf(a, src, dest, len, this->_card);
+    if (!simd::is_kernel_card(this->_card)) {
+        _mul_coef_to_buf(a, src, dest, len);
+        return;
+    }
+    simd::kernels<uint32_t>().mul_coef_to_buf(a, src, dest, len, this->_card);
+}
+
+template <>
+void RingModN<uint32_t>::mul_coef_add_to_buf(
+    uint32_t a,
+    uint32_t* src,
+    uint32_t* dest,
+    size_t len) const
+{
+    if (!simd::is_kernel_card(this->_card)) {
+        _mul_coef_add_to_buf(a, src, dest, len);
+        return;
+    }
+    simd::kernels<uint32_t>().mul_coef_add_to_buf(
+        a, src, dest, len, this->_card);
 }
 
 template <>
 void RingModN<uint32_t>::add_two_bufs(uint32_t* src, uint32_t* dest, size_t len)
     const
 {
-    simd::add_two_bufs(src, dest, len, this->_card);
+    if (!simd::is_kernel_card(this->_card)) {
+        _add_two_bufs(src, dest, len);
+        return;
+    }
+    simd::kernels<uint32_t>().add_two_bufs(src, dest, len, this->_card);
 }
 
 template <>
@@ -73,7 +109,11 @@ void RingModN<uint32_t>::sub_two_bufs(
     uint32_t* res,
     size_t len) const
 {
-    simd::sub_two_bufs(bufa, bufb, res, len, this->_card);
+    if (!simd::is_kernel_card(this->_card)) {
+        _sub_two_bufs(bufa, bufb, res, len);
+        return;
+    }
+    simd::kernels<uint32_t>().sub_two_bufs(bufa, bufb, res, len, this->_card);
 }
 
 template <>
@@ -83,14 +123,37 @@ void RingModN<uint16_t>::mul_coef_to_buf(
     uint16_t* dest,
     size_t len) const
 {
-    simd::mul_coef_to_buf(a, src, dest, len, this->_card);
+    if (!simd::is_kernel_card(this->_card)) {
+        _mul_coef_to_buf(a, src, dest, len);
+        return;
+    }
+    simd::kernels<uint16_t>().mul_coef_to_buf(a, src, dest, len, this->_card);
+}
+
+template <>
+void RingModN<uint16_t>::mul_coef_add_to_buf(
+    uint16_t a,
+    uint16_t* src,
+    uint16_t* dest,
+    size_t len) const
+{
+    if (!simd::is_kernel_card(this->_card)) {
+        _mul_coef_add_to_buf(a, src, dest, len);
+        return;
+    }
+    simd::kernels<uint16_t>().mul_coef_add_to_buf(
+        a, src, dest, len, this->_card);
 }
 
 template <>
 void RingModN<uint16_t>::add_two_bufs(uint16_t* src, uint16_t* dest, size_t len)
     const
 {
-    simd::add_two_bufs(src, dest, len, this->_card);
+    if (!simd::is_kernel_card(this->_card)) {
+        _add_two_bufs(src, dest, len);
+        return;
+    }
+    simd::kernels<uint16_t>().add_two_bufs(src, dest, len, this->_card);
 }
 
 template <>
@@ -100,21 +163,33 @@ void RingModN<uint16_t>::sub_two_bufs(
     uint16_t* res,
     size_t len) const
 {
-    simd::sub_two_bufs(bufa, bufb, res, len, this->_card);
+    if (!simd::is_kernel_card(this->_card)) {
+        _sub_two_bufs(bufa, bufb, res, len);
+        return;
+    }
+    simd::kernels<uint16_t>().sub_two_bufs(bufa, bufb, res, len, this->_card);
 }
 
 template <>
 void RingModN<uint16_t>::hadamard_mul(int n, uint16_t* x_u16, uint16_t* y_u16)
     const
 {
-    simd::mul_two_bufs(y_u16, x_u16, n, this->_card);
+    if (!simd::is_kernel_card(this->_card)) {
+        _hadamard_mul(n, x_u16, y_u16);
+        return;
+    }
+    simd::kernels<uint16_t>().mul_two_bufs(y_u16, x_u16, n, this->_card);
 }
 
 template <>
 void RingModN<uint32_t>::hadamard_mul(int n, uint32_t* x_u32, uint32_t* y_u32)
     const
 {
-    simd::mul_two_bufs(y_u32, x_u32, n, this->_card);
+    if (!simd::is_kernel_card(this->_card)) {
+        _hadamard_mul(n, x_u32, y_u32);
+        return;
+    }
+    simd::kernels<uint32_t>().mul_two_bufs(y_u32, x_u32, n, this->_card);
 }
 
 } // namespace gf
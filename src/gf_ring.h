@@ -96,6 +96,7 @@ class RingModN {
     T log_naive(T base, T exponent) const;
     virtual T replicate(T a) const;
     virtual void mul_coef_to_buf(T a, T* src, T* dest, size_t len) const;
+    virtual void mul_coef_add_to_buf(T a, T* src, T* dest, size_t len) const;
     virtual void mul_vec_to_vecp(
         vec::Vector<T>& u,
         vec::Buffers<T>& src,
@@ -142,6 +143,14 @@ class RingModN {
     template <typename Base, typename Class, typename... Args>
     friend std::unique_ptr<Base> alloc(Args... args);
 
+    // scalar operations on buffers
+    void _mul_coef_to_buf(T a, T* src, T* dest, size_t len) const;
+    void _mul_coef_add_to_buf(T a, T* src, T* dest, size_t len) const;
+    void _add_two_bufs(T* src, T* dest, size_t len) const;
+    void _sub_two_bufs(T* bufa, T* bufb, T* res, size_t len) const;
+    void _hadamard_mul(int n, T* x, T* y) const;
+    void _neg(size_t n, T* x) const;
+
     T _card;
     T root;
     std::vector<T> primes;
@@ -362,6 +371,13 @@ inline T RingModN<T>::replicate(T a) const
 // For each i, dest[i] = a * src[i]
 template <typename T>
 inline void RingModN<T>::mul_coef_to_buf(T a, T* src, T* dest, size_t len) const
+{
+    _mul_coef_to_buf(a, src, dest, len);
+}
+
+template <typename T>
+inline void
+RingModN<T>::_mul_coef_to_buf(T a, T* src, T* dest, size_t len) const
 {
     size_t i;
     DoubleSizeVal<T> coef = DoubleSizeVal<T>(a);
@@ -371,6 +387,25 @@ inline void RingModN<T>::mul_coef_to_buf(T a, T* src, T* dest, size_t len) const
     }
 }
 
+// For each i, dest[i] = dest[i] + a * src[i]
+template <typename T>
+inline void
+RingModN<T>::mul_coef_add_to_buf(T a, T* src, T* dest, size_t len) const
+{
+    _mul_coef_add_to_buf(a, src, dest, len);
+}
+
+template <typename T>
+inline void
+RingModN<T>::_mul_coef_add_to_buf(T a, T* src, T* dest, size_t len) const
+{
+    size_t i;
+    for (i = 0; i < len; i++) {
+        // perform multiply-accumulate
+        dest[i] = add(dest[i], mul(a, src[i]));
+    }
+}
+
 template <typename T>
 inline void RingModN<T>::mul_vec_to_vecp(
     vec::Vector<T>& u,
@@ -402,6 +437,12 @@ inline void RingModN<T>::mul_vec_to_vecp(
 
 template <typename T>
 inline void RingModN<T>::add_two_bufs(T* src, T* dest, size_t len) const
+{
+    _add_two_bufs(src, dest, len);
+}
+
+template <typename T>
+inline void RingModN<T>::_add_two_bufs(T* src, T* dest, size_t len) const
 {
     size_t i;
     for (i = 0; i < len; i++) {
@@ -427,6 +468,13 @@ RingModN<T>::add_vecp_to_vecp(vec::Buffers<T>& src, vec::Buffers<T>& dest) const
 template <typename T>
 inline void
 RingModN<T>::sub_two_bufs(T* bufa, T* bufb, T* res, size_t len) const
+{
+    _sub_two_bufs(bufa, bufb, res, len);
+}
+
+template <typename T>
+inline void
+RingModN<T>::_sub_two_bufs(T* bufa, T* bufb, T* res, size_t len) const
 {
     size_t i;
     for (i = 0; i < len; i++) {
@@ -823,6 +871,12 @@ T RingModN<T>::get_code_len_high_compo(T n) const
 
 template <typename T>
 inline void RingModN<T>::hadamard_mul(int n, T* x, T* y) const
+{
+    _hadamard_mul(n, x, y);
+}
+
+template <typename T>
+inline void RingModN<T>::_hadamard_mul(int n, T* x, T* y) const
 {
     for (int i = 0; i < n; i++) {
         x[i] = mul(x[i], y[i]);
@@ -831,6 +885,12 @@ inline void RingModN<T>::hadamard_mul(int n, T* x, T* y) const
 
 template <typename T>
 inline void RingModN<T>::neg(size_t n, T* x) const
+{
+    _neg(n, x);
+}
+
+template <typename T>
+inline void RingModN<T>::_neg(size_t n, T* x) const
 {
     // add y to the first half of `x`
     for (size_t i = 0; i < n; i++) {
@@ -870,6 +930,20 @@ void RingModN<uint32_t>::mul_coef_to_buf(
     uint32_t* dest,
     size_t len) const;
 
+template <>
+void RingModN<uint16_t>::mul_coef_add_to_buf(
+    uint16_t a,
+    uint16_t* src,
+    uint16_t* dest,
+    size_t len) const;
+
+template <>
+void RingModN<uint32_t>::mul_coef_add_to_buf(
+    uint32_t a,
+    uint32_t* src,
+    uint32_t* dest,
+    size_t len) const;
+
 template <>
 void RingModN<uint16_t>::add_two_bufs(uint16_t* src, uint16_t* dest, size_t len)
     const;
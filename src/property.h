@@ -83,6 +83,14 @@ class Properties {
         props.clear();
     }
 
+    /**
+     * Append all pairs of another properties
+     */
+    inline void append(const Properties& other)
+    {
+        props.insert(props.end(), other.props.begin(), other.props.end());
+    }
+
     const std::vector<std::pair<size_t, uint32_t>>& get_map() const
     {
         return props;
@@ -201,6 +209,169 @@ class FntProperties : public Properties {
   public:
 };
 
+/** Marks of out-of-range symbols of a set of packets
+ *
+ * It is a compact form of the `OOR_MARK` properties, filled while packets
+ * are computed and converted into properties afterwards. Each packet has a
+ * bitmap holding a bit per byte: the symbol of index `j` is marked if one of
+ * the bits `j * word_size, ..., (j + 1) * word_size - 1` is set, so that a
+ * byte mask of vector comparisons can be stored as is.
+ *
+ * Only packets of indices in `[begin, end)` are tracked, e.g. the parities
+ * of a systematic codeword.
+ *
+ * Marks also keep the symbols that do not fit in packets of narrow symbols,
+ * see `fft::Radix2::fft_narrow`: such symbols are stored as 0 and marked.
+ *
+ * A window on the marks of a range of symbols of the packets can be built,
+ * e.g. for transforms computed on column tiles of packets.
+ */
+class OorMarks {
+  public:
+    OorMarks(unsigned begin, unsigned end, size_t pkt_size, unsigned word_size)
+        : begin(begin), end(end), word_size(word_size),
+          n_words((pkt_size * word_size + 63) / 64), stride(n_words),
+          masks((end - begin) * n_words, 0), data(masks.data())
+    {
+        assert(begin <= end);
+    }
+
+    /**
+     * Build a window on the marks of some symbols of the packets
+     *
+     * The window reads and writes the bitmaps of `marks`, which must outlive
+     * it.
+     *
+     * @param marks - marks of whole packets
+     * @param offset - index of the first symbol of the window, its bits must
+     * start a word of the bitmaps
+     * @param len - number of symbols of the window
+     */
+    OorMarks(OorMarks& marks, size_t offset, size_t len)
+        : begin(marks.begin), end(marks.end), word_size(marks.word_size),
+          n_words((len * word_size + 63) / 64), stride(marks.stride),
+          data(marks.data + offset * word_size / 64)
+    {
+        assert(offset * word_size % 64 == 0);
+    }
+
+    OorMarks(const OorMarks&) = delete;
+    OorMarks& operator=(const OorMarks&) = delete;
+
+    /// Unmark all symbols
+    inline void clear()
+    {
+        for (unsigned i = begin; i < end; ++i) {
+            clear(i);
+        }
+    }
+
+    /// Unmark all symbols of a packet
+    inline void clear(unsigned i)
+    {
+        std::fill_n(get(i), n_words, 0);
+    }
+
+    /// Copy the marks of the packet `j` of `other` to the packet `i`
+    inline void copy(unsigned i, OorMarks& other, unsigned j)
+    {
+        assert(other.n_words == n_words && other.word_size == word_size);
+        std::copy_n(other.get(j), n_words, get(i));
+    }
+
+    /// Check if the symbol `j` of a packet bitmap is marked
+    inline bool is_marked(const uint64_t* mask, size_t j) const
+    {
+        const size_t bit = j * word_size;
+        return (mask[bit / 64] >> (bit % 64)) & ((1ULL << word_size) - 1);
+    }
+
+    /// Mark or unmark the symbol `j` of a packet bitmap
+    inline void set_marked(uint64_t* mask, size_t j, bool marked) const
+    {
+        const size_t bit = j * word_size;
+        const uint64_t bits = ((1ULL << word_size) - 1) << (bit % 64);
+        if (marked) {
+            mask[bit / 64] |= bits;
+        } else {
+            mask[bit / 64] &= ~bits;
+        }
+    }
+
+    /**
+     * Get the bitmap of a packet
+     *
+     * @return the bitmap or nullptr if the packet is not tracked
+     */
+    inline uint64_t* get(unsigned i)
+    {
+        if (i < begin || i >= end) {
+            return nullptr;
+        }
+        return data + (i - begin) * stride;
+    }
+
+    /**
+     * Mark the symbols of a packet whose value is `threshold`
+     *
+     * @param i - index of the packet
+     * @param buf - symbols of the packet
+     * @param from - index of the first symbol to check
+     * @param to - index after the last symbol to check
+     * @param threshold - out-of-range value
+     */
+    template <typename T>
+    inline void
+    detect(unsigned i, const T* buf, size_t from, size_t to, T threshold)
+    {
+        uint64_t* mask = get(i);
+        if (mask == nullptr) {
+            return;
+        }
+        for (size_t j = from; j < to; ++j) {
+            if (buf[j] == threshold) {
+                const size_t bit = j * word_size;
+                mask[bit / 64] |= 1ULL << (bit % 64);
+            }
+        }
+    }
+
+    /**
+     * Add the marks of a packet to its properties
+     *
+     * @param i - index of the packet
+     * @param props - properties of the packet
+     * @param offset - location of the first symbol of the packet
+     */
+    inline void get_props(unsigned i, Properties& props, off_t offset)
+    {
+        const uint64_t* mask = get(i);
+        assert(mask != nullptr);
+        for (size_t k = 0; k < n_words; ++k) {
+            uint64_t bits = mask[k];
+            while (bits != 0) {
+                const size_t bit = k * 64 + __builtin_ctzll(bits);
+                const size_t j = bit / word_size;
+                props.add(offset + j, OOR_MARK);
+                // skip other bits of the symbol
+                const size_t next = (j + 1) * word_size - k * 64;
+                bits = (next >= 64) ? 0 : bits & (~0ULL << next);
+            }
+        }
+    }
+
+  private:
+    unsigned begin;
+    unsigned end;
+    unsigned word_size;
+    size_t n_words;
+    // distance between the bitmaps of two packets
+    size_t stride;
+    // empty for windows
+    std::vector<uint64_t> masks;
+    uint64_t* data;
+};
+
 } // namespace quadiron
 
 #endif
@@ -28,10 +28,60 @@
  * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
  * POSSIBILITY OF SUCH DAMAGE.
  */
+#include <algorithm>
+
 #include "property.h"
 #include "quadiron.h"
 #include "quadiron_c.h"
 
+namespace {
+
+/** Scratch memory of the C API for a given FNT FEC
+ *
+ * It gathers the workspace of the FEC and the vectors that describe the
+ * blocks of a call, so that they are allocated only once.
+ */
+struct Fnt32Workspace {
+    explicit Fnt32Workspace(quadiron::fec::RsFnt<uint32_t>& fec)
+        : ws(fec.make_workspace()), data_vec(fec.n_data),
+          parities_vec(fec.n_outputs), parities_props(fec.n_outputs),
+          missing_idxs_vec(fec.code_len), wanted_data_vec(fec.n_data),
+          wanted_idxs_vec(fec.n_outputs)
+    {
+    }
+
+    /** Prepare the vectors for a new call
+     *
+     * @param missing_idxs array of length code_len or nullptr
+     */
+    void reset(const int* missing_idxs)
+    {
+        std::fill(data_vec.begin(), data_vec.end(), nullptr);
+        std::fill(parities_vec.begin(), parities_vec.end(), nullptr);
+        for (auto& props : parities_props) {
+            props.clear();
+        }
+        if (missing_idxs != nullptr) {
+            std::copy(
+                missing_idxs,
+                missing_idxs + missing_idxs_vec.size(),
+                missing_idxs_vec.begin());
+        }
+        std::fill(wanted_data_vec.begin(), wanted_data_vec.end(), false);
+        std::fill(wanted_idxs_vec.begin(), wanted_idxs_vec.end(), false);
+    }
+
+    std::unique_ptr<quadiron::fec::Workspace<uint32_t>> ws;
+    std::vector<uint8_t*> data_vec;
+    std::vector<uint8_t*> parities_vec;
+    std::vector<quadiron::Properties> parities_props;
+    std::vector<int> missing_idxs_vec;
+    std::vector<bool> wanted_data_vec;
+    std::vector<bool> wanted_idxs_vec;
+};
+
+} // namespace
+
 extern "C" {
 
 struct QuadironFnt32*
@@ -70,6 +120,21 @@ int quadiron_fnt32_get_metadata_size(
     return ((block_size / 65536) + 16) * 4;
 }
 
+struct QuadironFnt32Workspace*
+quadiron_fnt32_workspace_new(struct QuadironFnt32* fecp)
+{
+    quadiron::fec::RsFnt<uint32_t>* fec =
+        reinterpret_cast<quadiron::fec::RsFnt<uint32_t>*>(fecp);
+
+    return reinterpret_cast<struct QuadironFnt32Workspace*>(
+        new Fnt32Workspace(*fec));
+}
+
+void quadiron_fnt32_workspace_delete(struct QuadironFnt32Workspace* wsp)
+{
+    delete reinterpret_cast<Fnt32Workspace*>(wsp);
+}
+
 int quadiron_fnt32_encode(
     struct QuadironFnt32* fecp,
     uint8_t** data,
@@ -79,10 +144,33 @@ int quadiron_fnt32_encode(
 {
     quadiron::fec::RsFnt<uint32_t>* fec =
         reinterpret_cast<quadiron::fec::RsFnt<uint32_t>*>(fecp);
-    std::vector<uint8_t*> data_vec(fec->n_data, nullptr);
-    std::vector<uint8_t*> parities_vec(fec->n_outputs, nullptr);
-    std::vector<quadiron::Properties> parities_props(fec->n_outputs);
-    std::vector<bool> wanted_idxs_vec(fec->n_outputs);
+    Fnt32Workspace ws(*fec);
+
+    return quadiron_fnt32_encode_ws(
+        fecp,
+        reinterpret_cast<struct QuadironFnt32Workspace*>(&ws),
+        data,
+        parity,
+        wanted_idxs,
+        block_size);
+}
+
+int quadiron_fnt32_encode_ws(
+    struct QuadironFnt32* fecp,
+    struct QuadironFnt32Workspace* wsp,
+    uint8_t** data,
+    uint8_t** parity,
+    int* wanted_idxs,
+    size_t block_size)
+{
+    quadiron::fec::RsFnt<uint32_t>* fec =
+        reinterpret_cast<quadiron::fec::RsFnt<uint32_t>*>(fecp);
+    Fnt32Workspace* ws = reinterpret_cast<Fnt32Workspace*>(wsp);
+    ws->reset(nullptr);
+    std::vector<uint8_t*>& data_vec = ws->data_vec;
+    std::vector<uint8_t*>& parities_vec = ws->parities_vec;
+    std::vector<quadiron::Properties>& parities_props = ws->parities_props;
+    std::vector<bool>& wanted_idxs_vec = ws->wanted_idxs_vec;
     int metadata_size = quadiron_fnt32_get_metadata_size(fecp, block_size);
 
     for (unsigned i = 0; i < fec->n_outputs; i++) {
@@ -107,7 +195,12 @@ int quadiron_fnt32_encode(
     }
 
     fec->encode_blocks_vertical(
-        data_vec, parities_vec, parities_props, wanted_idxs_vec, block_size);
+        data_vec,
+        parities_vec,
+        parities_props,
+        wanted_idxs_vec,
+        block_size,
+        *ws->ws);
 
     if (fec->type == quadiron::fec::FecType::SYSTEMATIC) {
         quadiron::Properties null_prop;
@@ -158,12 +251,35 @@ int quadiron_fnt32_decode(
 {
     quadiron::fec::RsFnt<uint32_t>* fec =
         reinterpret_cast<quadiron::fec::RsFnt<uint32_t>*>(fecp);
-    std::vector<uint8_t*> data_vec(fec->n_data, nullptr);
-    std::vector<uint8_t*> parities_vec(fec->n_outputs, nullptr);
-    std::vector<quadiron::Properties> parities_props(fec->n_outputs);
-    std::vector<int> missing_idxs_vec(
-        missing_idxs, missing_idxs + fec->code_len);
-    std::vector<bool> wanted_idxs_vec(fec->n_data, true);
+    Fnt32Workspace ws(*fec);
+
+    return quadiron_fnt32_decode_ws(
+        fecp,
+        reinterpret_cast<struct QuadironFnt32Workspace*>(&ws),
+        data,
+        parity,
+        missing_idxs,
+        block_size);
+}
+
+int quadiron_fnt32_decode_ws(
+    struct QuadironFnt32* fecp,
+    struct QuadironFnt32Workspace* wsp,
+    uint8_t** data,
+    uint8_t** parity,
+    int* missing_idxs,
+    size_t block_size)
+{
+    quadiron::fec::RsFnt<uint32_t>* fec =
+        reinterpret_cast<quadiron::fec::RsFnt<uint32_t>*>(fecp);
+    Fnt32Workspace* ws = reinterpret_cast<Fnt32Workspace*>(wsp);
+    ws->reset(missing_idxs);
+    std::vector<uint8_t*>& data_vec = ws->data_vec;
+    std::vector<uint8_t*>& parities_vec = ws->parities_vec;
+    std::vector<quadiron::Properties>& parities_props = ws->parities_props;
+    std::vector<int>& missing_idxs_vec = ws->missing_idxs_vec;
+    std::vector<bool>& wanted_idxs_vec = ws->wanted_data_vec;
+    std::fill(wanted_idxs_vec.begin(), wanted_idxs_vec.end(), true);
     int metadata_size = quadiron_fnt32_get_metadata_size(fecp, block_size);
     bool res;
 
@@ -211,7 +327,8 @@ int quadiron_fnt32_decode(
         parities_props,
         missing_idxs_vec,
         wanted_idxs_vec,
-        block_size);
+        block_size,
+        *ws->ws);
     if (!res)
         return -1;
 
@@ -238,15 +355,36 @@ int quadiron_fnt32_reconstruct(
 {
     quadiron::fec::RsFnt<uint32_t>* fec =
         reinterpret_cast<quadiron::fec::RsFnt<uint32_t>*>(fecp);
-    std::vector<uint8_t*> data_vec(fec->n_data);
-    std::vector<uint8_t*> parities_vec(fec->n_outputs);
-    std::vector<quadiron::Properties> parities_props(fec->n_outputs);
-    std::vector<int> missing_idxs_vec(
-        missing_idxs, missing_idxs + fec->code_len);
-    std::vector<bool> wanted_data_vec(fec->n_data, false);
-    std::vector<bool> wanted_idxs_vec(fec->n_outputs, false);
+    Fnt32Workspace ws(*fec);
+
+    return quadiron_fnt32_reconstruct_ws(
+        fecp,
+        reinterpret_cast<struct QuadironFnt32Workspace*>(&ws),
+        data,
+        parity,
+        missing_idxs,
+        destination_idx,
+        block_size);
+}
+
+int quadiron_fnt32_reconstruct_ws(
+    struct QuadironFnt32* fecp,
+    struct QuadironFnt32Workspace* wsp,
+    uint8_t** data,
+    uint8_t** parity,
+    int* missing_idxs,
+    unsigned int destination_idx,
+    size_t block_size)
+{
+    quadiron::fec::RsFnt<uint32_t>* fec =
+        reinterpret_cast<quadiron::fec::RsFnt<uint32_t>*>(fecp);
+    Fnt32Workspace* ws = reinterpret_cast<Fnt32Workspace*>(wsp);
+    ws->reset(missing_idxs);
+    std::vector<uint8_t*>& data_vec = ws->data_vec;
+    std::vector<uint8_t*>& parities_vec = ws->parities_vec;
+    std::vector<quadiron::Properties>& parities_props = ws->parities_props;
+    std::vector<int>& missing_idxs_vec = ws->missing_idxs_vec;
     int metadata_size = quadiron_fnt32_get_metadata_size(fecp, block_size);
-    bool res;
 
     if (fec->type == quadiron::fec::FecType::SYSTEMATIC) {
         for (unsigned i = 0; i < fec->n_data; i++) {
@@ -285,121 +423,42 @@ int quadiron_fnt32_reconstruct(
         }
     }
 
-    int need_decode = 0;
-
-    if (fec->type == quadiron::fec::FecType::SYSTEMATIC) {
-        /*
-         * Easy case where the target is a data then simply decode
-         */
-        if (destination_idx < fec->n_data) {
-            wanted_idxs_vec[destination_idx] = true;
-            res = fec->decode_blocks_vertical(
-                data_vec,
-                parities_vec,
-                parities_props,
-                missing_idxs_vec,
-                wanted_idxs_vec,
-                block_size);
-            if (!res) {
-                return -1;
-            }
-            for (unsigned i = 0; i < fec->n_data; i++) {
-                quadiron::Properties null_prop;
-
-                if (i == destination_idx) {
-                    uint32_t* metadata = reinterpret_cast<uint32_t*>(data[i]);
-                    int ret =
-                        null_prop.fnt_serialize(metadata, metadata_size / 4);
-                    if (ret == -1) {
-                        return -1;
-                    }
-                }
-            }
-            return 0;
-        }
+    const bool res = fec->repair_blocks_vertical(
+        data_vec,
+        parities_vec,
+        parities_props,
+        missing_idxs_vec,
+        destination_idx,
+        block_size,
+        *ws->ws);
+    if (!res) {
+        return -1;
     }
 
-    /*
-     * At this point we want a parity to be reconstructed
-     * If systematic we may need to decode if a data is missing.
-     * If non-systematic we always need to decode
-     */
-    std::vector<std::vector<uint8_t>> blocks(fec->n_data);
+    uint32_t* metadata;
+    quadiron::Properties null_prop;
+    quadiron::Properties* props;
     if (fec->type == quadiron::fec::FecType::SYSTEMATIC) {
-        for (unsigned i = 0; i < fec->n_data; i++) {
-            if (missing_idxs[i]) {
-                need_decode = 1;
-                wanted_data_vec[i] = true;
-                blocks.at(i).resize(block_size);
-                data_vec[i] = blocks.at(i).data();
-            }
+        if (destination_idx < fec->n_data) {
+            // data have no properties
+            metadata = reinterpret_cast<uint32_t*>(data[destination_idx]);
+            props = &null_prop;
+        } else {
+            const unsigned parity_idx = destination_idx - fec->n_data;
+            metadata = reinterpret_cast<uint32_t*>(parity[parity_idx]);
+            props = &parities_props[parity_idx];
         }
     } else {
-        need_decode = 1;
-        for (unsigned i = 0; i < fec->n_data; i++) {
-            wanted_data_vec[i] = true;
-            blocks.at(i).resize(block_size);
-            data_vec[i] = blocks.at(i).data();
-        }
-    }
-
-    if (need_decode) {
-        res = fec->decode_blocks_vertical(
-            data_vec,
-            parities_vec,
-            parities_props,
-            missing_idxs_vec,
-            wanted_data_vec,
-            block_size);
-        if (!res) {
-            return -1;
+        if (destination_idx < fec->n_data) {
+            metadata = reinterpret_cast<uint32_t*>(data[destination_idx]);
+        } else {
+            metadata = reinterpret_cast<uint32_t*>(
+                parity[destination_idx - fec->n_data]);
         }
+        props = &parities_props[destination_idx];
     }
-
-    /*
-     * At this point we have all data blocks.
-     */
-    if (fec->type == quadiron::fec::FecType::SYSTEMATIC) {
-        wanted_idxs_vec[destination_idx - fec->n_data] = true;
-    } else {
-        wanted_idxs_vec[destination_idx] = true;
-    }
-
-    fec->encode_blocks_vertical(
-        data_vec, parities_vec, parities_props, wanted_idxs_vec, block_size);
-
-    if (fec->type == quadiron::fec::FecType::SYSTEMATIC) {
-        for (unsigned i = 0; i < fec->n_parities; i++) {
-            if (i == destination_idx - fec->n_data) {
-                uint32_t* metadata = reinterpret_cast<uint32_t*>(parity[i]);
-                int ret = parities_props[i].fnt_serialize(
-                    metadata, metadata_size / 4);
-                if (ret == -1) {
-                    return -1;
-                }
-            }
-        }
-    } else {
-        for (unsigned i = 0; i < fec->n_data; i++) {
-            if (i == destination_idx) {
-                uint32_t* metadata = reinterpret_cast<uint32_t*>(data[i]);
-                int ret = parities_props[i].fnt_serialize(
-                    metadata, metadata_size / 4);
-                if (ret == -1) {
-                    return -1;
-                }
-            }
-        }
-        for (unsigned i = 0; i < fec->n_parities; i++) {
-            if (fec->n_data + i == destination_idx) {
-                uint32_t* metadata = reinterpret_cast<uint32_t*>(parity[i]);
-                int ret = parities_props[fec->n_data + i].fnt_serialize(
-                    metadata, metadata_size / 4);
-                if (ret == -1) {
-                    return -1;
-                }
-            }
-        }
+    if (props->fnt_serialize(metadata, metadata_size / 4) == -1) {
+        return -1;
     }
 
     return 0;
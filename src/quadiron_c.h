@@ -69,6 +69,27 @@ int quadiron_fnt32_get_metadata_size(
     struct QuadironFnt32* fecp,
     size_t block_size);
 
+/** Create a workspace for a FNT FEC
+ *
+ * A workspace holds the scratch memory needed by encode, decode and
+ * reconstruct. Passing it to the `_ws` variants of these functions avoids
+ * any allocation once the first call has been made.
+ *
+ * @note A workspace must not be shared by concurrent calls
+ *
+ * @param[in] fecp the FEC instance, it must outlive the workspace
+ *
+ * @return the workspace instance pointer
+ */
+struct QuadironFnt32Workspace*
+quadiron_fnt32_workspace_new(struct QuadironFnt32* fecp);
+
+/** Delete workspace
+ *
+ * @param[in,out] wsp the workspace instance pointer
+ */
+void quadiron_fnt32_workspace_delete(struct QuadironFnt32Workspace* wsp);
+
 /** Encode blocks
  *
  * @param[in] fecp the FEC instance
@@ -92,6 +113,20 @@ int quadiron_fnt32_encode(
     int* wanted_idxs,
     size_t block_size);
 
+/** Encode blocks using a workspace
+ *
+ * @see quadiron_fnt32_encode
+ *
+ * @param[in,out] wsp workspace created for fecp
+ */
+int quadiron_fnt32_encode_ws(
+    struct QuadironFnt32* fecp,
+    struct QuadironFnt32Workspace* wsp,
+    uint8_t** data,
+    uint8_t** parity,
+    int* wanted_idxs,
+    size_t block_size);
+
 /** Decode blocks
  *
  * @note For non-systematic codes parities must be provided as data and parities
@@ -121,6 +156,20 @@ int quadiron_fnt32_decode(
     int* missing_idxs,
     size_t block_size);
 
+/** Decode blocks using a workspace
+ *
+ * @see quadiron_fnt32_decode
+ *
+ * @param[in,out] wsp workspace created for fecp
+ */
+int quadiron_fnt32_decode_ws(
+    struct QuadironFnt32* fecp,
+    struct QuadironFnt32Workspace* wsp,
+    uint8_t** data,
+    uint8_t** parity,
+    int* missing_idxs,
+    size_t block_size);
+
 /** Reconstruct block
  *
  * @note For non-systematic codes parities must be provided as data and parities
@@ -148,6 +197,21 @@ int quadiron_fnt32_reconstruct(
     unsigned int destination_idx,
     size_t block_size);
 
+/** Reconstruct block using a workspace
+ *
+ * @see quadiron_fnt32_reconstruct
+ *
+ * @param[in,out] wsp workspace created for fecp
+ */
+int quadiron_fnt32_reconstruct_ws(
+    struct QuadironFnt32* fecp,
+    struct QuadironFnt32Workspace* wsp,
+    uint8_t** data,
+    uint8_t** parity,
+    int* missing_idxs,
+    unsigned int destination_idx,
+    size_t block_size);
+
 /** Dump a buffer on stderr (debug function)
  *
  * @param[in] buf the buffer
@@ -41,7 +41,7 @@ const unsigned F3 = 257;
 
 namespace quadiron {
 /** The namespace simd contains functions accelerated by
- *  using SIMD operations over 128bits and 256bits
+ *  using SIMD operations over 128bits and 256bits (x86) or 128bits (ARM)
  *
  *  It supports operations on 16-bit and 32-bit numbers
  */
@@ -52,11 +52,21 @@ namespace simd {
 } // namespace simd
 } // namespace quadiron
 
+// Include the kernels selected at runtime
+#include "simd_dispatch.h"
+
+// Kernels are only available to code built for an instruction set
+#ifdef QUADIRON_SIMD_ISA
+
 // Include essential operations that use SIMD functions
-#if defined(__AVX2__)
+#if defined(QUADIRON_SIMD_SWAR)
+#include "simd_swar.h"
+#elif defined(__AVX2__)
 #include "simd_256.h"
 #elif defined(__SSE4_1__)
 #include "simd_128.h"
+#elif defined(__ARM_NEON)
+#include "simd_neon.h"
 #endif
 
 // Include accelerated operations dedicated for FNT
@@ -65,11 +75,21 @@ namespace simd {
 // Include accelerated operations dedicated for RingModN
 #include "simd_ring.h"
 
+// Include accelerated operations dedicated for GF(2^n)
+#include "simd_gf2n.h"
+
 // Include accelerated operations dedicated for radix-2 FFT
 #include "simd_radix2_fft.h"
 
+// Include accelerated operations dedicated for GF(65537) on 16-bit lanes
+#include "simd_f4.h"
+
 // Include accelerated operations dedicated for NF4
+#ifdef QUADIRON_SIMD_NF4
 #include "simd_nf4.h"
+#endif
+
+#endif // #ifdef QUADIRON_SIMD_ISA
 
 #endif // #ifdef QUADIRON_USE_SIMD
 
@@ -52,8 +52,7 @@ namespace simd {
 template <typename T>
 inline bool addr_is_aligned(const T* addr)
 {
-    // Without SIMD, there is no specific alignment constraint.
-    if (INSTRUCTION_SET == InstructionSet::NONE) {
+    if (!ALIGNED_MEMORY) {
         return true;
     }
     const std::uintptr_t address = reinterpret_cast<std::uintptr_t>(addr);
@@ -85,8 +84,8 @@ class AlignedAllocator {
             throw std::bad_alloc();
         }
 
-        // No SIMD: default allocator is good enough!
-        if (INSTRUCTION_SET == InstructionSet::NONE) {
+        // No alignment constraint: default allocator is good enough!
+        if (!ALIGNED_MEMORY) {
             return static_cast<value_type*>(
                 ::operator new(count * sizeof(value_type)));
         }
@@ -115,8 +114,8 @@ class AlignedAllocator {
 
     void deallocate(value_type* ptr, std::size_t /* count */) noexcept
     {
-        // No SIMD: default allocator is good enough!
-        if (INSTRUCTION_SET == InstructionSet::NONE) {
+        // No alignment constraint: default allocator is good enough!
+        if (!ALIGNED_MEMORY) {
             ::operator delete(ptr);
             return;
         }
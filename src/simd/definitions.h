@@ -65,6 +65,7 @@ enum class InstructionSet {
     NONE, ///< No SIMD instruction (fallback).
     SSE,  ///< SSE4.1
     AVX,  ///< AVX2
+    NEON, ///< ARM Advanced SIMD (AArch64)
 };
 
 // Definitions for Intel AVX-256 {{{
@@ -79,6 +80,12 @@ using MaskType = __m256i;
 
 static constexpr InstructionSet INSTRUCTION_SET = InstructionSet::AVX;
 
+// Kernels are defined in a namespace named after the instruction set, so that
+// kernels built for several instruction sets can be linked together.
+#define QUADIRON_SIMD_ISA avx
+// NF4 kernels are not implemented for every instruction set.
+#define QUADIRON_SIMD_NF4
+
 // }}}
 // Definitions for Intel SSE {{{
 
@@ -89,6 +96,25 @@ using MaskType = __m128i;
 
 static constexpr InstructionSet INSTRUCTION_SET = InstructionSet::SSE;
 
+// Kernels built for SSE4.1 are gathered in their own namespace.
+#define QUADIRON_SIMD_ISA sse
+#define QUADIRON_SIMD_NF4
+
+// }}}
+// Definitions for ARM NEON {{{
+
+// We require AArch64 because we rely on some instructions (such as across
+// vector reductions and table lookups) that aren't available on ARMv7. As NEON
+// is always available on AArch64, it is only used if SIMD is enabled.
+#elif defined(QUADIRON_USE_SIMD) && defined(__ARM_NEON) && defined(__aarch64__)
+
+using RegisterType = uint32x4_t;
+using MaskType = uint32x4_t;
+
+static constexpr InstructionSet INSTRUCTION_SET = InstructionSet::NEON;
+
+#define QUADIRON_SIMD_ISA neon
+
 // }}}
 // Definitions for scalar fallback {{{
 
@@ -105,13 +131,31 @@ using MaskType = uint32_t;
 
 static constexpr InstructionSet INSTRUCTION_SET = InstructionSet::NONE;
 
+// Without vector instructions, kernels process elements packed into 64-bit
+// words (SIMD within a register).
+#ifdef QUADIRON_USE_SIMD
+#define QUADIRON_SIMD_SWAR
+#define QUADIRON_SIMD_ISA swar
+#define QUADIRON_SIMD_NF4
+#endif
+
 #endif
 
 // }}}
 // Portable definitions {{{
 
+#ifdef QUADIRON_SIMD_DISPATCH
+/// Alignment constraint (in bytes), suitable for every instruction set the
+/// kernels can be dispatched to.
+static constexpr std::size_t ALIGNMENT = 32;
+/// Memory must be aligned even if this translation unit does not use SIMD.
+static constexpr bool ALIGNED_MEMORY = true;
+#else
 /// Alignment constraint (in bytes).
 static constexpr std::size_t ALIGNMENT = alignof(RegisterType);
+/// Without SIMD, there is no specific alignment constraint.
+static constexpr bool ALIGNED_MEMORY = INSTRUCTION_SET != InstructionSet::NONE;
+#endif
 
 /// Register size (in bits).
 static constexpr std::size_t REG_BITSZ = sizeof(RegisterType) * CHAR_BIT;
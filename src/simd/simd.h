@@ -54,6 +54,71 @@ static constexpr std::size_t countof()
     return REG_BITSZ / (sizeof(T) * CHAR_BIT);
 }
 
+/// Return the number of element of type T that can fit into a register of
+/// the instruction set `set`.
+template <typename T>
+static constexpr std::size_t countof(InstructionSet set)
+{
+    if (set == InstructionSet::AVX) {
+        return 256 / (sizeof(T) * CHAR_BIT);
+    }
+    if (set == InstructionSet::SSE || set == InstructionSet::NEON) {
+        return 128 / (sizeof(T) * CHAR_BIT);
+    }
+    return 1;
+}
+
+/** Return the number of element of type T processed at once by the kernels
+ *  built for the instruction set `set`
+ *
+ * Without vector instructions, kernels process 64-bit words.
+ */
+template <typename T>
+static constexpr std::size_t kernel_countof(InstructionSet set)
+{
+    if (set == InstructionSet::NONE) {
+        return sizeof(T) < sizeof(uint64_t) ? sizeof(uint64_t) / sizeof(T) : 1;
+    }
+    return countof<T>(set);
+}
+
+#ifdef QUADIRON_USE_SIMD
+/** Return the instruction set of the kernels in use
+ *
+ * @see simd_dispatch.h
+ */
+InstructionSet get_instruction_set();
+#endif
+
+/** Return the number of element of type T processed at once by the kernels
+ *
+ * When kernels are dispatched at runtime, it depends on the instruction set
+ * selected for the machine rather than on the one targeted at compile time.
+ */
+template <typename T>
+inline std::size_t vec_countof()
+{
+#if defined(QUADIRON_SIMD_DISPATCH)
+    return kernel_countof<T>(get_instruction_set());
+#elif defined(QUADIRON_USE_SIMD)
+    return kernel_countof<T>(INSTRUCTION_SET);
+#else
+    return countof<T>();
+#endif
+}
+
+/** Check if the modular kernels on lanes of type T compute modulo `card`
+ *
+ * They are specialized for the Fermat prime fitting the lanes: 257 on 16-bit
+ * lanes and 65537 on 32-bit ones.
+ */
+template <typename T>
+inline bool is_kernel_card(T card)
+{
+    const uint64_t c = card;
+    return (sizeof(T) == 2 && c == 257) || (sizeof(T) == 4 && c == 65537);
+}
+
 } // namespace simd
 } // namespace quadiron
 
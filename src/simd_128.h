@@ -35,6 +35,7 @@
 
 namespace quadiron {
 namespace simd {
+inline namespace QUADIRON_SIMD_ISA {
 
 typedef __m128i VecType;
 
@@ -58,8 +59,11 @@ inline VecType zero()
     return _mm_setzero_si128();
 }
 
-// NOLINTNEXTLINE(cert-err58-cpp)
-const VecType MASK8_LO = _mm_set1_epi16(0x80);
+/// Mask of the low byte of each 16-bit word, for `BLEND8`
+inline VecType mask8_lo()
+{
+    return _mm_set1_epi16(0x80);
+}
 
 /* ============= Essential Operations for SSE w/ both u16 & u32 ============ */
 
@@ -80,6 +84,10 @@ inline VecType bit_xor(const VecType& x, const VecType& y)
 {
     return _mm_xor_si128(x, y);
 }
+inline VecType bit_or(const VecType& x, const VecType& y)
+{
+    return _mm_or_si128(x, y);
+}
 inline uint16_t msb8_mask(const VecType& x)
 {
     return _mm_movemask_epi8(x);
@@ -96,6 +104,9 @@ inline bool is_zero(const VecType& x)
 #define SHIFTR(x, imm8) (_mm_srli_si128(x, imm8))
 #define BLEND8(x, y, mask) (_mm_blendv_epi8(x, y, mask))
 #define BLEND16(x, y, imm8) (_mm_blend_epi16(x, y, imm8))
+#define SHIFTR16(x, imm8) (_mm_srli_epi16(x, imm8))
+#define SHIFTR32(x, imm8) (_mm_srli_epi32(x, imm8))
+#define SHIFTL16(x, imm8) (_mm_slli_epi16(x, imm8))
 
 /* ================= Essential Operations for SSE ================= */
 
@@ -107,6 +118,11 @@ inline VecType set_one(uint32_t val)
     return _mm_set1_epi32(val);
 }
 template <>
+inline VecType set_one(uint8_t val)
+{
+    return _mm_set1_epi8(val);
+}
+template <>
 inline VecType set_one(uint16_t val)
 {
     return _mm_set1_epi16(val);
@@ -151,6 +167,15 @@ inline VecType mul<uint16_t>(const VecType& x, const VecType& y)
     return _mm_mullo_epi16(x, y);
 }
 
+/// High half of the lane-wise product
+template <typename T>
+inline VecType mulhi(const VecType& x, const VecType& y);
+template <>
+inline VecType mulhi<uint16_t>(const VecType& x, const VecType& y)
+{
+    return _mm_mulhi_epu16(x, y);
+}
+
 template <typename T>
 inline VecType compare_eq(const VecType& x, const VecType& y);
 template <>
@@ -177,6 +202,22 @@ inline VecType min<uint16_t>(const VecType& x, const VecType& y)
     return _mm_min_epu16(x, y);
 }
 
+/** Look up each byte of `idx` in the 16-byte `table`
+ *
+ * @note indices must be lower than 16
+ */
+inline VecType lookup16(const VecType& table, const VecType& idx)
+{
+    return _mm_shuffle_epi8(table, idx);
+}
+
+/// Load a 16-byte lookup table into a register
+inline VecType load_table16(const uint8_t* table)
+{
+    return _mm_loadu_si128(reinterpret_cast<const __m128i*>(table));
+}
+
+} // namespace QUADIRON_SIMD_ISA
 } // namespace simd
 } // namespace quadiron
 
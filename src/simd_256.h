@@ -47,6 +47,7 @@ _mm256_storeu2_m128i(__m128i* const hi, __m128i* const lo, const __m256i a)
 
 namespace quadiron {
 namespace simd {
+inline namespace QUADIRON_SIMD_ISA {
 
 typedef __m256i VecType;
 typedef __m128i HalfVecType;
@@ -71,8 +72,11 @@ inline VecType zero()
     return _mm256_setzero_si256();
 }
 
-// NOLINTNEXTLINE(cert-err58-cpp)
-const VecType MASK8_LO = _mm256_set1_epi16(0x80);
+/// Mask of the low byte of each 16-bit word, for `BLEND8`
+inline VecType mask8_lo()
+{
+    return _mm256_set1_epi16(0x80);
+}
 
 /* ============= Essential Operations for AVX2 w/ both u16 & u32 ============ */
 
@@ -93,6 +97,10 @@ inline VecType bit_xor(const VecType& x, const VecType& y)
 {
     return _mm256_xor_si256(x, y);
 }
+inline VecType bit_or(const VecType& x, const VecType& y)
+{
+    return _mm256_or_si256(x, y);
+}
 inline uint32_t msb8_mask(const VecType& x)
 {
     return _mm256_movemask_epi8(x);
@@ -109,6 +117,9 @@ inline bool is_zero(const VecType& x)
 #define SHIFTR(x, imm8) (_mm256_srli_si256(x, imm8))
 #define BLEND8(x, y, mask) (_mm256_blendv_epi8(x, y, mask))
 #define BLEND16(x, y, imm8) (_mm256_blend_epi16(x, y, imm8))
+#define SHIFTR16(x, imm8) (_mm256_srli_epi16(x, imm8))
+#define SHIFTR32(x, imm8) (_mm256_srli_epi32(x, imm8))
+#define SHIFTL16(x, imm8) (_mm256_slli_epi16(x, imm8))
 
 /* ================= Essential Operations for AVX2 ================= */
 
@@ -120,6 +131,11 @@ inline VecType set_one(uint32_t val)
     return _mm256_set1_epi32(val);
 }
 template <>
+inline VecType set_one(uint8_t val)
+{
+    return _mm256_set1_epi8(val);
+}
+template <>
 inline VecType set_one(uint16_t val)
 {
     return _mm256_set1_epi16(val);
@@ -164,6 +180,15 @@ inline VecType mul<uint16_t>(const VecType& x, const VecType& y)
     return _mm256_mullo_epi16(x, y);
 }
 
+/// High half of the lane-wise product
+template <typename T>
+inline VecType mulhi(const VecType& x, const VecType& y);
+template <>
+inline VecType mulhi<uint16_t>(const VecType& x, const VecType& y)
+{
+    return _mm256_mulhi_epu16(x, y);
+}
+
 template <typename T>
 inline VecType compare_eq(const VecType& x, const VecType& y);
 template <>
@@ -190,6 +215,23 @@ inline VecType min<uint16_t>(const VecType& x, const VecType& y)
     return _mm256_min_epu16(x, y);
 }
 
+/** Look up each byte of `idx` in the 16-byte `table`
+ *
+ * @note indices must be lower than 16
+ */
+inline VecType lookup16(const VecType& table, const VecType& idx)
+{
+    return _mm256_shuffle_epi8(table, idx);
+}
+
+/// Load a 16-byte lookup table into both lanes of a register
+inline VecType load_table16(const uint8_t* table)
+{
+    return _mm256_broadcastsi128_si256(
+        _mm_loadu_si128(reinterpret_cast<const __m128i*>(table)));
+}
+
+} // namespace QUADIRON_SIMD_ISA
 } // namespace simd
 } // namespace quadiron
 
@@ -0,0 +1,197 @@
+/*
+ * Copyright 2017-2018 Scality
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its contributors
+ *    may be used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <atomic>
+#include <cstdlib>
+#include <string>
+
+#include "exceptions.h"
+#include "simd.h"
+
+/*
+ * The file selects the kernels run by the library among those built for
+ * several instruction sets.
+ */
+
+#ifdef QUADIRON_USE_SIMD
+
+namespace quadiron {
+namespace simd {
+
+namespace {
+
+/// Kernels built in the library, indexed by instruction set
+class Registry {
+  public:
+    Registry()
+    {
+#ifdef QUADIRON_SIMD_DISPATCH
+        load_kernels<InstructionSet::SSE>(tables[index(InstructionSet::SSE)]);
+        built[index(InstructionSet::SSE)] = true;
+        load_kernels<InstructionSet::AVX>(tables[index(InstructionSet::AVX)]);
+        built[index(InstructionSet::AVX)] = true;
+        // SWAR kernels of the baseline code, as a last resort
+        load_kernels<InstructionSet::NONE>(tables[index(InstructionSet::NONE)]);
+        built[index(InstructionSet::NONE)] = true;
+#else
+        load_kernels<INSTRUCTION_SET>(tables[index(INSTRUCTION_SET)]);
+        built[index(INSTRUCTION_SET)] = true;
+#endif
+    }
+
+    bool is_built(InstructionSet set) const
+    {
+        return built[index(set)];
+    }
+
+    const KernelTables& get(InstructionSet set) const
+    {
+        return tables[index(set)];
+    }
+
+  private:
+    static unsigned index(InstructionSet set)
+    {
+        return static_cast<unsigned>(set);
+    }
+
+    KernelTables tables[4] = {};
+    bool built[4] = {false, false, false, false};
+};
+
+const Registry& registry()
+{
+    static const Registry registry;
+    return registry;
+}
+
+bool cpu_supports(InstructionSet set)
+{
+    // SWAR kernels only need 64-bit integers
+    if (set == InstructionSet::NONE) {
+        return true;
+    }
+#if defined(__i386__) || defined(__x86_64__)
+    __builtin_cpu_init();
+    switch (set) {
+    case InstructionSet::SSE:
+        return __builtin_cpu_supports("sse4.1");
+    case InstructionSet::AVX:
+        return __builtin_cpu_supports("avx2");
+    case InstructionSet::NEON:
+    case InstructionSet::NONE:
+        return false;
+    }
+#elif defined(__aarch64__)
+    // Advanced SIMD is part of the base AArch64 architecture
+    return set == InstructionSet::NEON;
+#else
+    (void)set;
+#endif
+    return false;
+}
+
+InstructionSet parse_instruction_set(const std::string& name)
+{
+    if (name == "sse") {
+        return InstructionSet::SSE;
+    }
+    if (name == "avx") {
+        return InstructionSet::AVX;
+    }
+    if (name == "neon") {
+        return InstructionSet::NEON;
+    }
+    if (name == "swar") {
+        return InstructionSet::NONE;
+    }
+    throw InvalidArgument("QUADIRON_SIMD: unknown instruction set " + name);
+}
+
+/// Select the instruction set from the environment or from the processor
+InstructionSet select_instruction_set()
+{
+    const char* name = std::getenv("QUADIRON_SIMD");
+    if (name != nullptr && *name != '\0') {
+        const InstructionSet set = parse_instruction_set(name);
+        if (!is_supported(set)) {
+            throw InvalidArgument(
+                std::string("QUADIRON_SIMD: unsupported instruction set ")
+                + name);
+        }
+        return set;
+    }
+    for (InstructionSet set :
+         {InstructionSet::AVX,
+          InstructionSet::SSE,
+          InstructionSet::NEON,
+          InstructionSet::NONE}) {
+        if (is_supported(set)) {
+            return set;
+        }
+    }
+    throw LogicError("SIMD: no supported instruction set");
+}
+
+std::atomic<InstructionSet>& selected_instruction_set()
+{
+    static std::atomic<InstructionSet> selected(select_instruction_set());
+    return selected;
+}
+
+} // namespace
+
+bool is_supported(InstructionSet set)
+{
+    return registry().is_built(set) && cpu_supports(set);
+}
+
+InstructionSet get_instruction_set()
+{
+    return selected_instruction_set().load(std::memory_order_relaxed);
+}
+
+void set_instruction_set(InstructionSet set)
+{
+    if (!is_supported(set)) {
+        throw InvalidArgument("SIMD: unsupported instruction set");
+    }
+    selected_instruction_set().store(set, std::memory_order_relaxed);
+}
+
+const KernelTables& get_kernels()
+{
+    return registry().get(get_instruction_set());
+}
+
+} // namespace simd
+} // namespace quadiron
+
+#endif // #ifdef QUADIRON_USE_SIMD
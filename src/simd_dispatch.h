@@ -0,0 +1,287 @@
+/* -*- mode: c++ -*- */
+/*
+ * Copyright 2017-2018 Scality
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its contributors
+ *    may be used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+#ifndef __QUAD_SIMD_DISPATCH_H__
+#define __QUAD_SIMD_DISPATCH_H__
+
+#include <cstdint>
+#include <vector>
+
+#include <sys/types.h>
+
+#include "core.h"
+#include "property.h"
+#include "simd/simd.h"
+#include "vec_buffers.h"
+
+namespace quadiron {
+namespace simd {
+
+/** Lookup tables to multiply elements of GF(2<sup>8</sup>) or
+ *  GF(2<sup>16</sup>) by a constant `a`
+ *
+ * An element \f$x\f$ is split into nibbles \f$x_i\f$ so that
+ * \f$a \cdot x = \sum_i a \cdot (x_i << 4i)\f$. For each nibble `i`,
+ * `lo_bytes[i]` and `hi_bytes[i]` hold the low and high bytes of
+ * \f$a \cdot (v << 4i)\f$ for \f$v = 0, \ldots, 15\f$, so that products
+ * are computed by byte shuffles.
+ */
+struct Gf2nMulTables {
+    unsigned nb_nibbles; // 2 for GF(2^8), 4 for GF(2^16)
+    uint8_t lo_bytes[4][16];
+    uint8_t hi_bytes[4][16];
+};
+
+/** Kernels over 16-bit or 32-bit elements built for one instruction set
+ *
+ * Each member points to the function of the same name in the namespace of the
+ * instruction set, `len` being a number of registers for the butterflies and
+ * a number of elements otherwise.
+ */
+template <typename T>
+struct Kernels {
+    // RingModN
+    void (*neg)(size_t len, T* buf, T card);
+    void (*mul_coef_to_buf)(T a, T* src, T* dest, size_t len, T card);
+    void (*mul_coef_add_to_buf)(T a, T* src, T* dest, size_t len, T card);
+    void (*add_two_bufs)(T* src, T* dest, size_t len, T card);
+    void (*sub_two_bufs)(T* bufa, T* bufb, T* res, size_t len, T card);
+    void (*mul_two_bufs)(T* src, T* dest, size_t len, T card);
+
+    // Radix2 FFT
+    void (*butterfly_ct_two_layers_step)(
+        vec::Buffers<T>& buf,
+        T r1,
+        T r2,
+        T r3,
+        unsigned start,
+        unsigned m,
+        size_t len,
+        T card,
+        OorMarks* marks);
+    void (*butterfly_ct_layers_step)(
+        vec::Buffers<T>& buf,
+        const T* coefs,
+        unsigned depth,
+        unsigned start,
+        unsigned m,
+        size_t len,
+        T card,
+        OorMarks* marks);
+    void (*butterfly_ct_step)(
+        vec::Buffers<T>& buf,
+        T r,
+        unsigned start,
+        unsigned m,
+        unsigned step,
+        size_t len,
+        T card,
+        OorMarks* marks);
+    void (*butterfly_ct_step_top)(
+        vec::Buffers<T>& buf,
+        T r,
+        unsigned start,
+        unsigned m,
+        unsigned step,
+        size_t len,
+        T card,
+        OorMarks* marks);
+    void (*butterfly_gs_step)(
+        vec::Buffers<T>& buf,
+        T r,
+        unsigned start,
+        unsigned m,
+        unsigned step,
+        size_t len,
+        T card);
+    void (*butterfly_gs_layers_step)(
+        vec::Buffers<T>& buf,
+        const T* coefs,
+        unsigned depth,
+        unsigned start,
+        unsigned m,
+        size_t len,
+        T card);
+    void (*butterfly_gs_step_simple)(
+        vec::Buffers<T>& buf,
+        T r,
+        unsigned start,
+        unsigned m,
+        unsigned step,
+        size_t len,
+        T card);
+
+    // FNT
+    void (*encode_post_process)(
+        vec::Buffers<T>& output,
+        OorMarks& marks,
+        unsigned code_len,
+        T card,
+        size_t vecs_nb);
+
+    // GF(2^n)
+    void (*gf2n_mul_coef_to_buf)(
+        const Gf2nMulTables& tables,
+        T* src,
+        T* dest,
+        size_t len);
+    void (*gf2n_mul_coef_add_to_buf)(
+        const Gf2nMulTables& tables,
+        T* src,
+        T* dest,
+        size_t len);
+    void (*xor_two_bufs)(T* src, T* dest, size_t len);
+    void (*xor_bufs)(T* bufa, T* bufb, T* res, size_t len);
+};
+
+/** Kernels over elements of GF(65537) stored on 16-bit lanes
+ *
+ * Elements equal to 65536 are stored as 0 and marked in `marks`, `size`
+ * being a number of elements per buffer.
+ */
+struct F4Kernels {
+    void (*butterfly_ct_two_layers_step)(
+        vec::Buffers<uint16_t>& buf,
+        uint32_t r1,
+        uint32_t r2,
+        uint32_t r3,
+        unsigned start,
+        unsigned m,
+        size_t size,
+        OorMarks& marks);
+    void (*butterfly_ct_step)(
+        vec::Buffers<uint16_t>& buf,
+        uint32_t r,
+        unsigned start,
+        unsigned m,
+        unsigned step,
+        size_t size,
+        OorMarks& marks);
+    void (*butterfly_ct_step_top)(
+        vec::Buffers<uint16_t>& buf,
+        uint32_t r,
+        unsigned start,
+        unsigned m,
+        unsigned step,
+        size_t size,
+        OorMarks& marks);
+};
+
+/** Kernels over NF4 elements built for one instruction set */
+struct Nf4Kernels {
+    __uint128_t (*expand16)(uint16_t* arr, int n);
+    __uint128_t (*expand32)(uint32_t* arr, int n);
+    __uint128_t (*add)(__uint128_t a, __uint128_t b);
+    __uint128_t (*sub)(__uint128_t a, __uint128_t b);
+    __uint128_t (*mul)(__uint128_t a, __uint128_t b);
+    void (*hadamard_mul)(unsigned n, __uint128_t* x, __uint128_t* y);
+    GroupedValues<__uint128_t> (*unpack)(__uint128_t a);
+    void (*unpack_to)(__uint128_t a, GroupedValues<__uint128_t>& b);
+    __uint128_t (*pack)(__uint128_t a);
+    __uint128_t (*pack_flag)(__uint128_t a, uint32_t flag);
+};
+
+/** All the kernels built for one instruction set */
+struct KernelTables {
+    Kernels<uint16_t> u16;
+    Kernels<uint32_t> u32;
+    F4Kernels f4;
+    Nf4Kernels nf4;
+};
+
+/** Fill `tables` with the kernels built for the instruction set `I`
+ *
+ * It is defined by `simd_kernels.cpp`, which is built once for each
+ * instruction set supported by the library.
+ */
+template <InstructionSet I>
+void load_kernels(KernelTables& tables);
+
+/** Check if kernels of an instruction set are usable
+ *
+ * @param set an instruction set
+ *
+ * @return true if kernels have been built for `set` and the processor
+ * supports it
+ */
+bool is_supported(InstructionSet set);
+
+/** Select the instruction set of the kernels
+ *
+ * By default, the widest instruction set supported by the processor is
+ * selected at the first use of the kernels. It can be overridden by setting
+ * the environment variable `QUADIRON_SIMD` to `sse`, `avx`, `neon` or `swar`,
+ * the latter being the portable kernels working on 64-bit words.
+ *
+ * @note The number of elements processed at once, see `vec_countof`, is read
+ * when codes are built: the instruction set must not be changed while codes
+ * are alive.
+ *
+ * @param set an instruction set
+ *
+ * @throw InvalidArgument if `set` is not supported
+ */
+void set_instruction_set(InstructionSet set);
+
+/** Return the kernels of the selected instruction set */
+const KernelTables& get_kernels();
+
+/** Return the kernels over elements of type T */
+template <typename T>
+const Kernels<T>& kernels();
+
+template <>
+inline const Kernels<uint16_t>& kernels<uint16_t>()
+{
+    return get_kernels().u16;
+}
+
+template <>
+inline const Kernels<uint32_t>& kernels<uint32_t>()
+{
+    return get_kernels().u32;
+}
+
+/** Return the kernels over GF(65537) on 16-bit lanes */
+inline const F4Kernels& f4_kernels()
+{
+    return get_kernels().f4;
+}
+
+/** Return the kernels over NF4 elements */
+inline const Nf4Kernels& nf4_kernels()
+{
+    return get_kernels().nf4;
+}
+
+} // namespace simd
+} // namespace quadiron
+
+#endif
@@ -0,0 +1,458 @@
+/*
+ * Copyright 2017-2018 Scality
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its contributors
+ *    may be used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+#ifndef __QUAD_SIMD_F4_H__
+#define __QUAD_SIMD_F4_H__
+
+#include "property.h"
+#include "vec_buffers.h"
+
+namespace quadiron {
+namespace simd {
+inline namespace QUADIRON_SIMD_ISA {
+
+/*
+ * Elements of F4 = GF(65537) stored on 16-bit lanes, twice as many per
+ * register as on 32-bit lanes. The only element that does not fit, 65536, is
+ * stored as 0 and marked out of band in an `OorMarks` bitmap holding a bit
+ * per byte.
+ *
+ * Vectorized operations take lanes lower than 65536 and set in `oor` the
+ * lanes whose result is 65536. As it is rare, registers having such lanes or
+ * marked inputs are computed again element by element.
+ */
+
+/// Number of 16-bit lanes of a register
+constexpr size_t F4_LANES = sizeof(VecType) / sizeof(uint16_t);
+
+/* ================= Basic Operations ================= */
+
+/**
+ * Modular addition on 16-bit lanes
+ *
+ * @param x input register
+ * @param y input register
+ * @param oor lanes whose result is 65536 are set in it
+ * @return (x + y) mod 65537, 65536 being stored as 0
+ */
+inline VecType f4_add(const VecType& x, const VecType& y, VecType& oor)
+{
+    const VecType s = add<uint16_t>(x, y);
+    // lanes where `x + y` does not overflow, i.e. `s >= x`
+    const VecType no_carry = compare_eq<uint16_t>(min<uint16_t>(s, x), x);
+    // 2^16 = -1 so that a carry is subtracted, except for an overflow to 0
+    oor = bit_or(oor, compare_eq<uint16_t>(bit_or(s, no_carry), zero()));
+    return sub<uint16_t>(sub<uint16_t>(s, one<uint16_t>()), no_carry);
+}
+
+/**
+ * Modular subtraction on 16-bit lanes
+ *
+ * @param x input register
+ * @param y input register
+ * @param oor lanes whose result is 65536 are set in it
+ * @return (x - y) mod 65537, 65536 being stored as 0
+ */
+inline VecType f4_sub(const VecType& x, const VecType& y, VecType& oor)
+{
+    const VecType d = sub<uint16_t>(x, y);
+    // lanes where `x >= y`
+    const VecType no_borrow = compare_eq<uint16_t>(min<uint16_t>(x, y), y);
+    // a borrow is compensated by adding 65537 = 2^16 + 1
+    const VecType res =
+        add<uint16_t>(add<uint16_t>(d, one<uint16_t>()), no_borrow);
+    oor = bit_or(oor, compare_eq<uint16_t>(bit_or(res, no_borrow), zero()));
+    return res;
+}
+
+/**
+ * Modular multiplication on 16-bit lanes
+ *
+ * @param x input register
+ * @param y input register
+ * @param oor lanes whose result is 65536 are set in it
+ * @return (x * y) mod 65537, 65536 being stored as 0
+ */
+inline VecType f4_mul(const VecType& x, const VecType& y, VecType& oor)
+{
+    // x * y = hi * 2^16 + lo = lo - hi
+    return f4_sub(mul<uint16_t>(x, y), mulhi<uint16_t>(x, y), oor);
+}
+
+/**
+ * Butterfly Cooley-Tukey operation on 16-bit lanes
+ *
+ * x <- x + r * y
+ * y <- x - r * y
+ *
+ * @param ct_case coefficient case
+ * @param c a register stores coefficient `r`
+ * @param x working register
+ * @param y working register
+ * @param oor lanes whose result is 65536 are set in it
+ */
+inline void f4_butterfly_ct(
+    CtGsCase ct_case,
+    const VecType& c,
+    VecType& x,
+    VecType& y,
+    VecType& oor)
+{
+    VecType z = y;
+    switch (ct_case) {
+    case CtGsCase::SIMPLE:
+        y = f4_sub(x, z, oor);
+        x = f4_add(x, z, oor);
+        break;
+    case CtGsCase::EXTREME:
+        y = f4_add(x, z, oor);
+        x = f4_sub(x, z, oor);
+        break;
+    case CtGsCase::NORMAL:
+        z = f4_mul(c, y, oor);
+        y = f4_sub(x, z, oor);
+        x = f4_add(x, z, oor);
+        break;
+    }
+}
+
+/**
+ * Butterfly Cooley-Tukey operation on 16-bit lanes whose second output is not
+ * wanted
+ *
+ * x <- x + r * y
+ *
+ * @param ct_case coefficient case
+ * @param c a register stores coefficient `r`
+ * @param x working register
+ * @param y input register
+ * @param oor lanes whose result is 65536 are set in it
+ */
+inline void f4_butterfly_ct_top(
+    CtGsCase ct_case,
+    const VecType& c,
+    VecType& x,
+    const VecType& y,
+    VecType& oor)
+{
+    switch (ct_case) {
+    case CtGsCase::SIMPLE:
+        x = f4_add(x, y, oor);
+        break;
+    case CtGsCase::EXTREME:
+        x = f4_sub(x, y, oor);
+        break;
+    case CtGsCase::NORMAL:
+        x = f4_add(x, f4_mul(c, y, oor), oor);
+        break;
+    }
+}
+
+/* ================= Element by element Operations ================= */
+
+/// Marks of the lanes of the register `vec_id` of a packet bitmap
+inline uint64_t f4_marks(const uint64_t* mask, size_t vec_id)
+{
+    const size_t bit = vec_id * sizeof(VecType);
+    return (mask[bit / 64] >> (bit % 64)) & ((1ULL << sizeof(VecType)) - 1);
+}
+
+/// Element `j` of a packet
+inline uint32_t f4_get(
+    const OorMarks& marks,
+    const uint16_t* buf,
+    const uint64_t* mask,
+    size_t j)
+{
+    return marks.is_marked(mask, j) ? F4 - 1 : buf[j];
+}
+
+/// Set the element `j` of a packet
+inline void f4_set(
+    const OorMarks& marks,
+    uint16_t* buf,
+    uint64_t* mask,
+    size_t j,
+    uint32_t val)
+{
+    buf[j] = static_cast<uint16_t>(val);
+    marks.set_marked(mask, j, val == F4 - 1);
+}
+
+/**
+ * Butterfly CT operations on the elements `[from, to)` of a pair of packets
+ *
+ * @param marks - marks of the packets
+ * @param r - coefficient
+ * @param p - first packet
+ * @param mask_p - bitmap of `p`
+ * @param q - second packet
+ * @param mask_q - bitmap of `q`
+ * @param from - first element
+ * @param to - element following the last one
+ * @param top - if true, only `p` is computed
+ */
+inline void f4_butterfly_ct_elements(
+    const OorMarks& marks,
+    uint32_t r,
+    uint16_t* p,
+    uint64_t* mask_p,
+    uint16_t* q,
+    uint64_t* mask_q,
+    size_t from,
+    size_t to,
+    bool top)
+{
+    for (size_t j = from; j < to; ++j) {
+        const uint32_t x = f4_get(marks, p, mask_p, j);
+        const uint32_t y = f4_get(marks, q, mask_q, j);
+        const uint32_t z = static_cast<uint32_t>(uint64_t(r) * y % F4);
+        if (!top) {
+            f4_set(marks, q, mask_q, j, (x + F4 - z) % F4);
+        }
+        f4_set(marks, p, mask_p, j, (x + z) % F4);
+    }
+}
+
+/* ================= Vectorized Operations ================= */
+
+template <bool top>
+inline void do_f4_butterfly_ct_step(
+    vec::Buffers<uint16_t>& buf,
+    uint32_t r,
+    unsigned start,
+    unsigned m,
+    unsigned step,
+    size_t size,
+    OorMarks& marks)
+{
+    const CtGsCase ct_case = get_case<uint32_t>(r, F4);
+    // the coefficient is only used if it is lower than 65536
+    const VecType c = set_one(static_cast<uint16_t>(r));
+    const size_t len = size / F4_LANES;
+
+    const unsigned bufs_nb = buf.get_n();
+    const std::vector<uint16_t*>& mem = buf.get_mem();
+    for (unsigned i = start; i < bufs_nb; i += step) {
+        uint16_t* p = mem[i];
+        uint16_t* q = mem[i + m];
+        VecType* vec_p = reinterpret_cast<VecType*>(p);
+        VecType* vec_q = reinterpret_cast<VecType*>(q);
+        uint64_t* mask_p = marks.get(i);
+        uint64_t* mask_q = marks.get(i + m);
+
+        for (size_t j = 0; j < len; ++j) {
+            VecType x = load_to_reg(vec_p + j);
+            VecType y = load_to_reg(vec_q + j);
+            VecType oor = zero();
+
+            if (top) {
+                f4_butterfly_ct_top(ct_case, c, x, y, oor);
+            } else {
+                f4_butterfly_ct(ct_case, c, x, y, oor);
+            }
+
+            if ((f4_marks(mask_p, j) | f4_marks(mask_q, j)) == 0
+                && is_zero(oor)) {
+                store_to_mem(vec_p + j, x);
+                if (!top) {
+                    store_to_mem(vec_q + j, y);
+                }
+            } else {
+                f4_butterfly_ct_elements(
+                    marks,
+                    r,
+                    p,
+                    mask_p,
+                    q,
+                    mask_q,
+                    j * F4_LANES,
+                    (j + 1) * F4_LANES,
+                    top);
+            }
+        }
+        // last elements
+        f4_butterfly_ct_elements(
+            marks, r, p, mask_p, q, mask_q, len * F4_LANES, size, top);
+    }
+}
+
+/**
+ * Vectorized butterfly CT step on elements stored on 16 bits
+ *
+ * For each pair (P, Q) = (buf[i], buf[i + m]) for step = 2 * m and coef `r`
+ *      P = P + r * Q
+ *      Q = P - r * Q
+ *
+ * @param buf - working buffers
+ * @param r - coefficient
+ * @param start - index of buffer among `m` ones
+ * @param m - current group size
+ * @param step - next loop
+ * @param size - number of elements per buffer
+ * @param marks - marks of the buffers, inputs and outputs equal to 65536 are
+ * marked in it
+ */
+inline void f4_butterfly_ct_step(
+    vec::Buffers<uint16_t>& buf,
+    uint32_t r,
+    unsigned start,
+    unsigned m,
+    unsigned step,
+    size_t size,
+    OorMarks& marks)
+{
+    do_f4_butterfly_ct_step<false>(buf, r, start, m, step, size, marks);
+}
+
+/**
+ * Vectorized butterfly CT step on elements stored on 16 bits whose second
+ * output is not wanted
+ *
+ * For each pair (P, Q) = (buf[i], buf[i + m]) for step = 2 * m and coef `r`
+ *      P = P + r * Q
+ *
+ * @param buf - working buffers
+ * @param r - coefficient
+ * @param start - index of buffer among `m` ones
+ * @param m - current group size
+ * @param step - next loop
+ * @param size - number of elements per buffer
+ * @param marks - marks of the buffers, inputs and outputs equal to 65536 are
+ * marked in it
+ */
+inline void f4_butterfly_ct_step_top(
+    vec::Buffers<uint16_t>& buf,
+    uint32_t r,
+    unsigned start,
+    unsigned m,
+    unsigned step,
+    size_t size,
+    OorMarks& marks)
+{
+    do_f4_butterfly_ct_step<true>(buf, r, start, m, step, size, marks);
+}
+
+/**
+ * Vectorized butterfly CT on two-layers at a time on elements stored on 16
+ * bits
+ *
+ * See `butterfly_ct_two_layers_step` for the operations.
+ *
+ * @param buf - working buffers
+ * @param r1 - coefficient for the 1st layer
+ * @param r2 - 1st coefficient for the 2nd layer
+ * @param r3 - 2nd coefficient for the 2nd layer
+ * @param start - index of buffer among `m` ones
+ * @param m - current group size
+ * @param size - number of elements per buffer
+ * @param marks - marks of the buffers, inputs and outputs equal to 65536 are
+ * marked in it
+ */
+inline void f4_butterfly_ct_two_layers_step(
+    vec::Buffers<uint16_t>& buf,
+    uint32_t r1,
+    uint32_t r2,
+    uint32_t r3,
+    unsigned start,
+    unsigned m,
+    size_t size,
+    OorMarks& marks)
+{
+    const CtGsCase case1 = get_case<uint32_t>(r1, F4);
+    const CtGsCase case2 = get_case<uint32_t>(r2, F4);
+    const CtGsCase case3 = get_case<uint32_t>(r3, F4);
+    const VecType c1 = set_one(static_cast<uint16_t>(r1));
+    const VecType c2 = set_one(static_cast<uint16_t>(r2));
+    const VecType c3 = set_one(static_cast<uint16_t>(r3));
+    const size_t len = size / F4_LANES;
+
+    const unsigned step = m << 2;
+    const unsigned bufs_nb = buf.get_n();
+    const std::vector<uint16_t*>& mem = buf.get_mem();
+    for (unsigned i = start; i < bufs_nb; i += step) {
+        uint16_t* p = mem[i];
+        uint16_t* q = mem[i + m];
+        uint16_t* r = mem[i + 2 * m];
+        uint16_t* s = mem[i + 3 * m];
+        VecType* vec_p = reinterpret_cast<VecType*>(p);
+        VecType* vec_q = reinterpret_cast<VecType*>(q);
+        VecType* vec_r = reinterpret_cast<VecType*>(r);
+        VecType* vec_s = reinterpret_cast<VecType*>(s);
+        uint64_t* mask_p = marks.get(i);
+        uint64_t* mask_q = marks.get(i + m);
+        uint64_t* mask_r = marks.get(i + 2 * m);
+        uint64_t* mask_s = marks.get(i + 3 * m);
+
+        // operations on the elements `[from, to)`
+        const auto elements = [&](size_t from, size_t to) {
+            f4_butterfly_ct_elements(
+                marks, r1, p, mask_p, q, mask_q, from, to, false);
+            f4_butterfly_ct_elements(
+                marks, r1, r, mask_r, s, mask_s, from, to, false);
+            f4_butterfly_ct_elements(
+                marks, r2, p, mask_p, r, mask_r, from, to, false);
+            f4_butterfly_ct_elements(
+                marks, r3, q, mask_q, s, mask_s, from, to, false);
+        };
+
+        for (size_t j = 0; j < len; ++j) {
+            VecType x = load_to_reg(vec_p + j);
+            VecType y = load_to_reg(vec_q + j);
+            VecType u = load_to_reg(vec_r + j);
+            VecType v = load_to_reg(vec_s + j);
+            VecType oor = zero();
+
+            f4_butterfly_ct(case1, c1, x, y, oor);
+            f4_butterfly_ct(case1, c1, u, v, oor);
+            f4_butterfly_ct(case2, c2, x, u, oor);
+            f4_butterfly_ct(case3, c3, y, v, oor);
+
+            const uint64_t marked = f4_marks(mask_p, j) | f4_marks(mask_q, j)
+                                    | f4_marks(mask_r, j)
+                                    | f4_marks(mask_s, j);
+            if (marked == 0 && is_zero(oor)) {
+                store_to_mem(vec_p + j, x);
+                store_to_mem(vec_q + j, y);
+                store_to_mem(vec_r + j, u);
+                store_to_mem(vec_s + j, v);
+            } else {
+                elements(j * F4_LANES, (j + 1) * F4_LANES);
+            }
+        }
+        // last elements
+        elements(len * F4_LANES, size);
+    }
+}
+
+} // namespace QUADIRON_SIMD_ISA
+} // namespace simd
+} // namespace quadiron
+
+#endif
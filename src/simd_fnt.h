@@ -31,10 +31,9 @@
 #ifndef __QUAD_SIMD_FNT_H__
 #define __QUAD_SIMD_FNT_H__
 
-#include <x86intrin.h>
-
 namespace quadiron {
 namespace simd {
+inline namespace QUADIRON_SIMD_ISA {
 
 template <typename T>
 inline VecType card();
@@ -62,14 +61,59 @@ inline VecType card_minus_one<uint32_t>()
     return set_one<uint32_t>(65536);
 }
 
-const int I_MASK8_LO = 0b01010101;
-
 template <typename T>
 inline VecType get_low_half(const VecType& x);
+template <typename T>
+inline VecType get_high_half(const VecType& x);
+
+#if defined(QUADIRON_SIMD_SWAR)
+
+template <>
+inline VecType get_low_half<uint16_t>(const VecType& x)
+{
+    return x & set_one<uint16_t>(0xFF);
+}
+template <>
+inline VecType get_low_half<uint32_t>(const VecType& x)
+{
+    return x & set_one<uint32_t>(0xFFFF);
+}
+
+template <>
+inline VecType get_high_half<uint16_t>(const VecType& x)
+{
+    return (x >> 8) & set_one<uint16_t>(0xFF);
+}
+template <>
+inline VecType get_high_half<uint32_t>(const VecType& x)
+{
+    return (x >> 16) & set_one<uint32_t>(0xFFFF);
+}
+
+#else
+
+#if defined(__ARM_NEON)
+
+// NEON has no byte blend
 template <>
 inline VecType get_low_half<uint16_t>(const VecType& x)
 {
-    return BLEND8(zero(), x, MASK8_LO);
+    return bit_and(x, set_one<uint16_t>(0xFF));
+}
+template <>
+inline VecType get_low_half<uint32_t>(const VecType& x)
+{
+    return bit_and(x, set_one<uint32_t>(0xFFFF));
+}
+
+#else
+
+const int I_MASK8_LO = 0b01010101;
+
+template <>
+inline VecType get_low_half<uint16_t>(const VecType& x)
+{
+    return BLEND8(zero(), x, mask8_lo());
 }
 template <>
 inline VecType get_low_half<uint32_t>(const VecType& x)
@@ -77,19 +121,22 @@ inline VecType get_low_half<uint32_t>(const VecType& x)
     return BLEND16(zero(), x, I_MASK8_LO);
 }
 
-template <typename T>
-inline VecType get_high_half(const VecType& x);
+#endif
+
+// a logical shift by element keeps the high halves in one instruction
 template <>
 inline VecType get_high_half<uint16_t>(const VecType& x)
 {
-    return BLEND8(zero(), SHIFTR(x, 1), MASK8_LO);
+    return SHIFTR16(x, 8);
 }
 template <>
 inline VecType get_high_half<uint32_t>(const VecType& x)
 {
-    return BLEND16(zero(), SHIFTR(x, 2), I_MASK8_LO);
+    return SHIFTR32(x, 16);
 }
 
+#endif
+
 /* ================= Basic Operations ================= */
 
 /**
@@ -139,6 +186,11 @@ inline VecType mod_neg(const VecType& x)
  * @note We assume that at least `x` or `y` is less than `q-1` so it's
  * not necessary to verify overflow on multiplying elements
  *
+ * As q = 2^k + 1 and lanes have 2k bits, the product of x <= q - 2 and
+ * y <= q - 1 is at most (2^k - 1) * 2^k < 2^(2k): it fits in a lane, whose
+ * high half h and low half l verify x * y = h * 2^k + l = l - h mod q.
+ * Operands must be reduced though, y up to 2q could overflow.
+ *
  * @param x input register
  * @param y input register
  * @return (x * y) mod q
@@ -177,36 +229,7 @@ inline VecType mod_mul_safe(const VecType& x, const VecType& y)
     return add<T>(res, bit_and(one<T>(), cmp));
 }
 
-/**
- * Update property for a given register for packed unsigned 32-bit integers
- *
- * @param props properties bound to fragments
- * @param threshold register storing max value in its elements
- * @param mask a specific mask
- * @param symb input register
- * @param offset offset in the data fragments
- */
-template <typename T>
-inline void add_props(
-    Properties& props,
-    VecType threshold,
-    VecType mask,
-    VecType symb,
-    off_t offset,
-    T)
-{
-    const VecType b = compare_eq<T>(threshold, symb);
-    const VecType c = bit_and(mask, b);
-    auto d = msb8_mask(c);
-    const unsigned element_size = sizeof(T);
-    while (d > 0) {
-        const unsigned byte_idx = __builtin_ctz(d);
-        const size_t _offset = offset + byte_idx / element_size;
-        props.add(_offset, OOR_MARK);
-        d ^= 1 << byte_idx;
-    }
-}
-
+} // namespace QUADIRON_SIMD_ISA
 } // namespace simd
 } // namespace quadiron
 
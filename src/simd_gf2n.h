@@ -0,0 +1,272 @@
+/*
+ * Copyright 2017-2018 Scality
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its contributors
+ *    may be used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef __QUAD_SIMD_GF2N_H__
+#define __QUAD_SIMD_GF2N_H__
+
+#include "simd_dispatch.h"
+
+namespace quadiron {
+namespace simd {
+inline namespace QUADIRON_SIMD_ISA {
+
+/* ================= Operations for GF(2^n) ================= */
+
+#ifdef QUADIRON_SIMD_SWAR
+
+/** Lookup tables of `Gf2nMulTables`
+ *
+ * Without byte shuffles, tables are looked up element by element.
+ */
+struct Gf2nMulRegs {
+    const Gf2nMulTables* tables;
+};
+
+inline void load_gf2n_mul_tables(const Gf2nMulTables& tables, Gf2nMulRegs& regs)
+{
+    regs.tables = &tables;
+}
+
+#else
+
+/** Lookup tables of `Gf2nMulTables` loaded into registers */
+struct Gf2nMulRegs {
+    unsigned nb_nibbles;
+    VecType lo[4];
+    VecType hi[4];
+};
+
+/// Load byte tables of `tables` into registers
+inline void load_gf2n_mul_tables(const Gf2nMulTables& tables, Gf2nMulRegs& regs)
+{
+    regs.nb_nibbles = tables.nb_nibbles;
+    for (unsigned i = 0; i < tables.nb_nibbles; i++) {
+        regs.lo[i] = load_table16(tables.lo_bytes[i]);
+        regs.hi[i] = load_table16(tables.hi_bytes[i]);
+    }
+}
+
+#endif
+
+/** Multiply a scalar by the constant of `tables`
+ *
+ * It is used for trailing elements that do not fill a register.
+ */
+template <typename T>
+inline T gf2n_mul(const Gf2nMulTables& tables, T x)
+{
+    T res = 0;
+    for (unsigned i = 0; i < tables.nb_nibbles; i++) {
+        const unsigned v = (x >> (4 * i)) & 0xf;
+        res ^= tables.lo_bytes[i][v] | (T(tables.hi_bytes[i][v]) << 8);
+    }
+    return res;
+}
+
+#ifdef QUADIRON_SIMD_SWAR
+
+/** Multiply each element of a word by the constant of `regs`
+ *
+ * Elements of GF(2<sup>8</sup>) and GF(2<sup>16</sup>) are respectively looked
+ * up as 16-bit and 32-bit lanes, whatever the width of their words.
+ */
+inline VecType gf2n_mul(const Gf2nMulRegs& regs, const VecType& x)
+{
+    const unsigned bits = regs.tables->nb_nibbles == 2 ? 16 : 32;
+    const VecType mask = (VecType(1) << bits) - 1;
+    VecType res = 0;
+    for (unsigned i = 0; i < sizeof(VecType) * CHAR_BIT; i += bits) {
+        res |= gf2n_mul<uint64_t>(*regs.tables, (x >> i) & mask) << i;
+    }
+    return res;
+}
+
+#else
+
+/** Multiply each element of a register by the constant of `regs`
+ *
+ * Elements are 16-bit or 32-bit words containing a value of GF(2<sup>8</sup>)
+ * or GF(2<sup>16</sup>), their upper bytes are thus null. As the product of
+ * zero is zero, looking up these null bytes does not pollute the result.
+ */
+inline VecType gf2n_mul(const Gf2nMulRegs& regs, const VecType& x)
+{
+    const VecType mask_nibble = set_one<uint8_t>(0x0f);
+
+    if (regs.nb_nibbles == 2) {
+        const VecType lo = bit_and(x, mask_nibble);
+        const VecType hi = bit_and(SHIFTR16(x, 4), mask_nibble);
+        return bit_xor(lookup16(regs.lo[0], lo), lookup16(regs.lo[1], hi));
+    }
+
+    // separate both bytes of each 16-bit word
+    const VecType byte0 = bit_and(x, set_one<uint16_t>(0xff));
+    const VecType byte1 = SHIFTR16(x, 8);
+    const VecType nib0 = bit_and(byte0, mask_nibble);
+    const VecType nib1 = SHIFTR16(byte0, 4);
+    const VecType nib2 = bit_and(byte1, mask_nibble);
+    const VecType nib3 = SHIFTR16(byte1, 4);
+
+    VecType lo = bit_xor(
+        bit_xor(lookup16(regs.lo[0], nib0), lookup16(regs.lo[1], nib1)),
+        bit_xor(lookup16(regs.lo[2], nib2), lookup16(regs.lo[3], nib3)));
+    VecType hi = bit_xor(
+        bit_xor(lookup16(regs.hi[0], nib0), lookup16(regs.hi[1], nib1)),
+        bit_xor(lookup16(regs.hi[2], nib2), lookup16(regs.hi[3], nib3)));
+
+    return bit_or(lo, SHIFTL16(hi, 8));
+}
+
+#endif
+
+/** Multiply a buffer by the constant of `tables`, i.e.
+ *  `dest[i] = a * src[i]`
+ */
+template <typename T>
+inline void
+gf2n_mul_coef_to_buf(const Gf2nMulTables& tables, T* src, T* dest, size_t len)
+{
+    VecType* _src = reinterpret_cast<VecType*>(src);
+    VecType* _dest = reinterpret_cast<VecType*>(dest);
+    const unsigned ratio = sizeof(*_src) / sizeof(*src);
+    const size_t _len = len / ratio;
+    const size_t _last_len = len - _len * ratio;
+    Gf2nMulRegs regs;
+    load_gf2n_mul_tables(tables, regs);
+
+    size_t i = 0;
+    const size_t end = (_len > 1) ? _len - 1 : 0;
+    for (; i < end; i += 2) {
+        _dest[i] = gf2n_mul(regs, _src[i]);
+        _dest[i + 1] = gf2n_mul(regs, _src[i + 1]);
+    }
+    for (; i < _len; ++i) {
+        _dest[i] = gf2n_mul(regs, _src[i]);
+    }
+    if (_last_len > 0) {
+        for (i = _len * ratio; i < len; i++) {
+            dest[i] = gf2n_mul(tables, src[i]);
+        }
+    }
+}
+
+/** Multiply-accumulate a buffer by the constant of `tables`, i.e.
+ *  `dest[i] ^= a * src[i]`
+ */
+template <typename T>
+inline void gf2n_mul_coef_add_to_buf(
+    const Gf2nMulTables& tables,
+    T* src,
+    T* dest,
+    size_t len)
+{
+    VecType* _src = reinterpret_cast<VecType*>(src);
+    VecType* _dest = reinterpret_cast<VecType*>(dest);
+    const unsigned ratio = sizeof(*_src) / sizeof(*src);
+    const size_t _len = len / ratio;
+    const size_t _last_len = len - _len * ratio;
+    Gf2nMulRegs regs;
+    load_gf2n_mul_tables(tables, regs);
+
+    size_t i = 0;
+    const size_t end = (_len > 1) ? _len - 1 : 0;
+    for (; i < end; i += 2) {
+        _dest[i] = bit_xor(_dest[i], gf2n_mul(regs, _src[i]));
+        _dest[i + 1] = bit_xor(_dest[i + 1], gf2n_mul(regs, _src[i + 1]));
+    }
+    for (; i < _len; ++i) {
+        _dest[i] = bit_xor(_dest[i], gf2n_mul(regs, _src[i]));
+    }
+    if (_last_len > 0) {
+        for (i = _len * ratio; i < len; i++) {
+            dest[i] ^= gf2n_mul(tables, src[i]);
+        }
+    }
+}
+
+/** Add a buffer to another one, i.e. `dest[i] ^= src[i]`
+ *
+ * Addition and subtraction are both a XOR in characteristic 2.
+ */
+template <typename T>
+inline void xor_two_bufs(T* src, T* dest, size_t len)
+{
+    VecType* _src = reinterpret_cast<VecType*>(src);
+    VecType* _dest = reinterpret_cast<VecType*>(dest);
+    const unsigned ratio = sizeof(*_src) / sizeof(*src);
+    const size_t _len = len / ratio;
+    const size_t _last_len = len - _len * ratio;
+
+    size_t i = 0;
+    const size_t end = (_len > 3) ? _len - 3 : 0;
+    for (; i < end; i += 4) {
+        _dest[i] = bit_xor(_src[i], _dest[i]);
+        _dest[i + 1] = bit_xor(_src[i + 1], _dest[i + 1]);
+        _dest[i + 2] = bit_xor(_src[i + 2], _dest[i + 2]);
+        _dest[i + 3] = bit_xor(_src[i + 3], _dest[i + 3]);
+    }
+    for (; i < _len; ++i) {
+        _dest[i] = bit_xor(_src[i], _dest[i]);
+    }
+    if (_last_len > 0) {
+        for (i = _len * ratio; i < len; i++) {
+            dest[i] ^= src[i];
+        }
+    }
+}
+
+/** Sum two buffers into a third one, i.e. `res[i] = bufa[i] ^ bufb[i]`
+ */
+template <typename T>
+inline void xor_bufs(T* bufa, T* bufb, T* res, size_t len)
+{
+    VecType* _bufa = reinterpret_cast<VecType*>(bufa);
+    VecType* _bufb = reinterpret_cast<VecType*>(bufb);
+    VecType* _res = reinterpret_cast<VecType*>(res);
+    const unsigned ratio = sizeof(*_bufa) / sizeof(*bufa);
+    const size_t _len = len / ratio;
+    const size_t _last_len = len - _len * ratio;
+
+    size_t i;
+    for (i = 0; i < _len; i++) {
+        _res[i] = bit_xor(_bufa[i], _bufb[i]);
+    }
+    if (_last_len > 0) {
+        for (i = _len * ratio; i < len; i++) {
+            res[i] = bufa[i] ^ bufb[i];
+        }
+    }
+}
+
+} // namespace QUADIRON_SIMD_ISA
+} // namespace simd
+} // namespace quadiron
+
+#endif
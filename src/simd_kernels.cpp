@@ -0,0 +1,111 @@
+/*
+ * Copyright 2017-2018 Scality
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its contributors
+ *    may be used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "simd.h"
+
+/*
+ * The file fills the tables of kernels for the instruction set it is built
+ * for. It is built once for each instruction set the kernels can be
+ * dispatched to, see `simd_dispatch.h`.
+ */
+
+#if defined(QUADIRON_USE_SIMD) && defined(QUADIRON_SIMD_ISA)
+
+namespace quadiron {
+namespace simd {
+
+namespace {
+
+template <typename T>
+void load_kernels(Kernels<T>& kernels)
+{
+    kernels.neg = neg<T>;
+    kernels.mul_coef_to_buf = mul_coef_to_buf<T>;
+    kernels.mul_coef_add_to_buf = mul_coef_add_to_buf<T>;
+    kernels.add_two_bufs = add_two_bufs<T>;
+    kernels.sub_two_bufs = sub_two_bufs<T>;
+    kernels.mul_two_bufs = mul_two_bufs<T>;
+
+    kernels.butterfly_ct_two_layers_step = butterfly_ct_two_layers_step<T>;
+    kernels.butterfly_ct_layers_step = butterfly_ct_layers_step<T>;
+    kernels.butterfly_ct_step = butterfly_ct_step<T>;
+    kernels.butterfly_ct_step_top = butterfly_ct_step_top<T>;
+    kernels.butterfly_gs_step = butterfly_gs_step<T>;
+    kernels.butterfly_gs_layers_step = butterfly_gs_layers_step<T>;
+    kernels.butterfly_gs_step_simple = butterfly_gs_step_simple<T>;
+
+    kernels.encode_post_process = encode_post_process<T>;
+
+    kernels.gf2n_mul_coef_to_buf = gf2n_mul_coef_to_buf<T>;
+    kernels.gf2n_mul_coef_add_to_buf = gf2n_mul_coef_add_to_buf<T>;
+    kernels.xor_two_bufs = xor_two_bufs<T>;
+    kernels.xor_bufs = xor_bufs<T>;
+}
+
+void load_kernels(F4Kernels& kernels)
+{
+    kernels.butterfly_ct_two_layers_step = f4_butterfly_ct_two_layers_step;
+    kernels.butterfly_ct_step = f4_butterfly_ct_step;
+    kernels.butterfly_ct_step_top = f4_butterfly_ct_step_top;
+}
+
+#ifdef QUADIRON_SIMD_NF4
+void load_kernels(Nf4Kernels& kernels)
+{
+    kernels.expand16 = expand16;
+    kernels.expand32 = expand32;
+    kernels.add = add;
+    kernels.sub = sub;
+    kernels.mul = mul;
+    kernels.hadamard_mul = hadamard_mul;
+    kernels.unpack = unpack;
+    kernels.unpack_to = unpack;
+    kernels.pack = pack;
+    kernels.pack_flag = pack;
+}
+#endif // #ifdef QUADIRON_SIMD_NF4
+
+} // namespace
+
+template <>
+void load_kernels<INSTRUCTION_SET>(KernelTables& tables)
+{
+    load_kernels(tables.u16);
+    load_kernels(tables.u32);
+    load_kernels(tables.f4);
+#ifdef QUADIRON_SIMD_NF4
+    load_kernels(tables.nf4);
+#endif
+}
+
+} // namespace simd
+} // namespace quadiron
+
+#endif // #if defined(QUADIRON_USE_SIMD) && defined(QUADIRON_SIMD_ISA)
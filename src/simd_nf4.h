@@ -31,12 +31,131 @@
 #ifndef __QUAD_SIMD_NF4_H__
 #define __QUAD_SIMD_NF4_H__
 
-#include <x86intrin.h>
-
 #include <simd/simd.h>
 
+#ifdef QUADIRON_SIMD_SWAR
+
+namespace quadiron {
+namespace simd {
+inline namespace QUADIRON_SIMD_ISA {
+
+/* ============== Operations for NF4 on 64-bit words =============== */
+
+/*
+ * An element of NF4 holds up to four 32-bit lanes, it is processed as two
+ * words of two lanes.
+ */
+
+inline VecType low_word(__uint128_t a)
+{
+    return static_cast<VecType>(a);
+}
+
+inline VecType high_word(__uint128_t a)
+{
+    return static_cast<VecType>(a >> 64);
+}
+
+inline __uint128_t from_words(VecType lo, VecType hi)
+{
+    return (static_cast<__uint128_t>(hi) << 64) | lo;
+}
+
+inline __uint128_t expand16(uint16_t* arr, int n)
+{
+    __uint128_t b = 0;
+    for (int i = n - 1; i >= 0; --i) {
+        b = (b << 16) | arr[i];
+    }
+    return b;
+}
+
+inline __uint128_t expand32(uint32_t* arr, int n)
+{
+    __uint128_t b = 0;
+    for (int i = n - 1; i >= 0; --i) {
+        b = (b << 32) | arr[i];
+    }
+    return b;
+}
+
+inline void unpack(__uint128_t a, GroupedValues<__uint128_t>& b)
+{
+    uint64_t values = 0;
+    uint32_t flag = 0;
+    for (unsigned i = 0; i < 4; ++i) {
+        const uint32_t ai = static_cast<uint32_t>(a >> (32 * i));
+        // 65536 is the only value having a bit in the upper half
+        flag |= (ai >> 16) << i;
+        values |= static_cast<uint64_t>(ai & 0xffff) << (16 * i);
+    }
+    b.flag = flag;
+    b.values = values;
+}
+
+inline GroupedValues<__uint128_t> unpack(__uint128_t a)
+{
+    GroupedValues<__uint128_t> b;
+    unpack(a, b);
+    return b;
+}
+
+inline __uint128_t pack(__uint128_t a, uint32_t flag)
+{
+    __uint128_t b = 0;
+    for (unsigned i = 0; i < 4; ++i) {
+        const uint32_t ai = (flag >> i) & 1
+                                ? 65536
+                                : static_cast<uint32_t>(a >> (16 * i)) & 0xffff;
+        b |= static_cast<__uint128_t>(ai) << (32 * i);
+    }
+    return b;
+}
+
+inline __uint128_t pack(__uint128_t a)
+{
+    return pack(a, 0);
+}
+
+inline __uint128_t add(__uint128_t a, __uint128_t b)
+{
+    return from_words(
+        mod_add<uint32_t>(low_word(a), low_word(b)),
+        mod_add<uint32_t>(high_word(a), high_word(b)));
+}
+
+inline __uint128_t sub(__uint128_t a, __uint128_t b)
+{
+    return from_words(
+        mod_sub<uint32_t>(low_word(a), low_word(b)),
+        mod_sub<uint32_t>(high_word(a), high_word(b)));
+}
+
+inline __uint128_t mul(__uint128_t a, __uint128_t b)
+{
+    return from_words(
+        mod_mul_safe<uint32_t>(low_word(a), low_word(b)),
+        mod_mul_safe<uint32_t>(high_word(a), high_word(b)));
+}
+
+inline void hadamard_mul(unsigned n, __uint128_t* x, __uint128_t* y)
+{
+    for (unsigned i = 0; i < n; ++i) {
+        x[i] = mul(x[i], y[i]);
+    }
+}
+
+} // namespace QUADIRON_SIMD_ISA
+} // namespace simd
+} // namespace quadiron
+
+#else // #ifdef QUADIRON_SIMD_SWAR
+
+#include <x86intrin.h>
+
 namespace quadiron {
 namespace simd {
+inline namespace QUADIRON_SIMD_ISA {
 
 typedef uint32_t aint32 __attribute__((aligned(ALIGNMENT)));
 
@@ -364,7 +483,10 @@ inline void hadamard_mul(unsigned n, __uint128_t* _x, __uint128_t* _y)
     }
 }
 
+} // namespace QUADIRON_SIMD_ISA
 } // namespace simd
 } // namespace quadiron
 
+#endif // #ifdef QUADIRON_SIMD_SWAR
+
 #endif
@@ -31,12 +31,14 @@
 #ifndef __QUAD_SIMD_RADIX2_FFT_H__
 #define __QUAD_SIMD_RADIX2_FFT_H__
 
-#include <x86intrin.h>
+#include <utility>
 
+#include "property.h"
 #include "vec_buffers.h"
 
 namespace quadiron {
 namespace simd {
+inline namespace QUADIRON_SIMD_ISA {
 
 enum class CtGsCase {
     SIMPLE,
@@ -64,13 +66,19 @@ constexpr CtGsCase get_case(T r, T q)
  * x <- x + r * y
  * y <- x - r * y
  *
+ * Outputs are fully reduced. Lazy reduction, i.e. keeping symbols in
+ * [0, 2q) between layers as with Harvey's butterflies, does not pay for
+ * Fermat primes: `mod_mul` needs reduced operands to fit in lanes, and
+ * `mod_add` and `mod_sub` already reduce by a single `min`, which is the
+ * cost of the conditional subtraction that lazy butterflies would defer.
+ *
  * @param ct_case coefficient case
  * @param c a register stores coefficient `r`
  * @param x working register
  * @param y working register
  */
 template <typename T>
-inline void
+inline void __attribute__((__always_inline__))
 butterfly_ct(CtGsCase ct_case, const VecType& c, VecType& x, VecType& y)
 {
     VecType z = y;
@@ -103,7 +111,7 @@ butterfly_ct(CtGsCase ct_case, const VecType& c, VecType& x, VecType& y)
  * @param y working register
  */
 template <typename T>
-inline void
+inline void __attribute__((__always_inline__))
 butterfly_gs(CtGsCase gs_case, const VecType& c, VecType& x, VecType& y)
 {
     VecType add = mod_add<T>(x, y);
@@ -146,6 +154,47 @@ inline void butterfly_simple_gs(CtGsCase gs_case, const VecType& c, VecType& x)
         break;
     }
 }
+/**
+ * Detection of out-of-range symbols in registers written by the last layer
+ *
+ * A symbol is out of range if it equals `card - 1`. As symbols are lower
+ * than `card` that is a power of 2 plus 1, it is the only one having the bit
+ * of `card - 1` set.
+ */
+template <typename T>
+class OorDetector {
+  public:
+    explicit OorDetector(T card)
+        : threshold(set_one(static_cast<T>(card - 1))),
+          mask_hi(set_one(static_cast<T>(1U << (sizeof(T) * CHAR_BIT - 1))))
+    {
+    }
+
+    /**
+     * Mark out-of-range symbols of a register
+     *
+     * @param mask - bitmap of the packet, see `OorMarks`, or nullptr
+     * @param vec_id - index of the register in the packet
+     * @param x - register
+     */
+    inline void __attribute__((__always_inline__))
+    mark(uint64_t* mask, size_t vec_id, const VecType& x) const
+    {
+        if (mask == nullptr || and_is_zero(x, threshold)) {
+            return;
+        }
+        // a bit per byte, only the highest byte of symbols is kept
+        const uint64_t d =
+            msb8_mask(bit_and(mask_hi, compare_eq<T>(threshold, x)));
+        const size_t bit = vec_id * sizeof(VecType);
+        mask[bit / 64] |= d << (bit % 64);
+    }
+
+  private:
+    const VecType threshold;
+    const VecType mask_hi;
+};
+
 /**
  * Vectorized butterfly CT step
  *
@@ -160,6 +209,7 @@ inline void butterfly_simple_gs(CtGsCase gs_case, const VecType& c, VecType& x)
  * @param step - next loop
  * @param len - number of vectors per buffer
  * @param card - modulo cardinal
+ * @param marks - if not nullptr, out-of-range outputs are marked in it
  */
 template <typename T>
 inline void butterfly_ct_step(
@@ -169,10 +219,12 @@ inline void butterfly_ct_step(
     unsigned m,
     unsigned step,
     size_t len,
-    T card)
+    T card,
+    OorMarks* marks)
 {
     const CtGsCase ct_case = get_case<T>(r, card);
     const VecType c = set_one(r);
+    const OorDetector<T> detector(card);
 
     const size_t end = (len > 1) ? len - 1 : 0;
     const unsigned bufs_nb = buf.get_n();
@@ -180,6 +232,8 @@ inline void butterfly_ct_step(
     for (unsigned i = start; i < bufs_nb; i += step) {
         VecType* p = reinterpret_cast<VecType*>(mem[i]);
         VecType* q = reinterpret_cast<VecType*>(mem[i + m]);
+        uint64_t* mask_p = marks ? marks->get(i) : nullptr;
+        uint64_t* mask_q = marks ? marks->get(i + m) : nullptr;
 
         size_t j = 0;
         for (; j < end; j += 2) {
@@ -193,6 +247,11 @@ inline void butterfly_ct_step(
 
             butterfly_ct<T>(ct_case, c, x2, y2);
 
+            detector.mark(mask_p, j, x1);
+            detector.mark(mask_p, j + 1, x2);
+            detector.mark(mask_q, j, y1);
+            detector.mark(mask_q, j + 1, y2);
+
             // Store back to memory
             store_to_mem(p++, x1);
             store_to_mem(p++, x2);
@@ -205,6 +264,9 @@ inline void butterfly_ct_step(
 
             butterfly_ct<T>(ct_case, c, x1, y1);
 
+            detector.mark(mask_p, j, x1);
+            detector.mark(mask_q, j, y1);
+
             // Store back to memory
             store_to_mem(p++, x1);
             store_to_mem(q++, y1);
@@ -212,6 +274,66 @@ inline void butterfly_ct_step(
     }
 }
 
+/**
+ * Vectorized butterfly CT step whose second output is not wanted
+ *
+ * For each pair (P, Q) = (buf[i], buf[i + m]) for step = 2 * m and coef `r`
+ *      P = P + r * Q
+ *
+ * @param buf - working buffers
+ * @param r - coefficient
+ * @param start - index of buffer among `m` ones
+ * @param m - current group size
+ * @param step - next loop
+ * @param len - number of vectors per buffer
+ * @param card - modulo cardinal
+ * @param marks - if not nullptr, out-of-range outputs are marked in it
+ */
+template <typename T>
+inline void butterfly_ct_step_top(
+    vec::Buffers<T>& buf,
+    T r,
+    unsigned start,
+    unsigned m,
+    unsigned step,
+    size_t len,
+    T card,
+    OorMarks* marks)
+{
+    const CtGsCase ct_case = get_case<T>(r, card);
+    const VecType c = set_one(r);
+    const OorDetector<T> detector(card);
+
+    const unsigned bufs_nb = buf.get_n();
+    const std::vector<T*>& mem = buf.get_mem();
+    for (unsigned i = start; i < bufs_nb; i += step) {
+        VecType* p = reinterpret_cast<VecType*>(mem[i]);
+        VecType* q = reinterpret_cast<VecType*>(mem[i + m]);
+        uint64_t* mask_p = marks ? marks->get(i) : nullptr;
+
+        for (size_t j = 0; j < len; ++j) {
+            const VecType x = load_to_reg(p);
+            const VecType y = load_to_reg(q++);
+
+            VecType res;
+            switch (ct_case) {
+            case CtGsCase::SIMPLE:
+                res = mod_add<T>(x, y);
+                break;
+            case CtGsCase::EXTREME:
+                res = mod_sub<T>(x, y);
+                break;
+            case CtGsCase::NORMAL:
+            default:
+                res = mod_add<T>(x, mod_mul<T>(c, y));
+                break;
+            }
+            detector.mark(mask_p, j, res);
+            store_to_mem(p++, res);
+        }
+    }
+}
+
 template <typename T>
 inline void do_butterfly_ct_2_layers(
     const std::vector<T*>& mem,
@@ -221,7 +343,8 @@ inline void do_butterfly_ct_2_layers(
     unsigned start,
     unsigned m,
     size_t len,
-    T card)
+    T card,
+    OorMarks* marks)
 {
     const CtGsCase case1 = get_case<T>(r1, card);
     const CtGsCase case2 = get_case<T>(r2, card);
@@ -230,11 +353,16 @@ inline void do_butterfly_ct_2_layers(
     VecType c1 = set_one(r1);
     VecType c2 = set_one(r2);
     VecType c3 = set_one(r3);
+    const OorDetector<T> detector(card);
 
     VecType* p = reinterpret_cast<VecType*>(mem[start]);
     VecType* q = reinterpret_cast<VecType*>(mem[start + m]);
     VecType* r = reinterpret_cast<VecType*>(mem[start + 2 * m]);
     VecType* s = reinterpret_cast<VecType*>(mem[start + 3 * m]);
+    uint64_t* mask_p = marks ? marks->get(start) : nullptr;
+    uint64_t* mask_q = marks ? marks->get(start + m) : nullptr;
+    uint64_t* mask_r = marks ? marks->get(start + 2 * m) : nullptr;
+    uint64_t* mask_s = marks ? marks->get(start + 3 * m) : nullptr;
 
     size_t j = 0;
     const size_t end = (len > 1) ? len - 1 : 0;
@@ -259,6 +387,15 @@ inline void do_butterfly_ct_2_layers(
         butterfly_ct<T>(case2, c2, x2, u2);
         butterfly_ct<T>(case3, c3, y2, v2);
 
+        detector.mark(mask_p, j, x1);
+        detector.mark(mask_p, j + 1, x2);
+        detector.mark(mask_q, j, y1);
+        detector.mark(mask_q, j + 1, y2);
+        detector.mark(mask_r, j, u1);
+        detector.mark(mask_r, j + 1, u2);
+        detector.mark(mask_s, j, v1);
+        detector.mark(mask_s, j + 1, v2);
+
         store_to_mem(p++, x1);
         store_to_mem(p++, x2);
         store_to_mem(q++, y1);
@@ -281,6 +418,11 @@ inline void do_butterfly_ct_2_layers(
         butterfly_ct<T>(case2, c2, x1, u1);
         butterfly_ct<T>(case3, c3, y1, v1);
 
+        detector.mark(mask_p, j, x1);
+        detector.mark(mask_q, j, y1);
+        detector.mark(mask_r, j, u1);
+        detector.mark(mask_s, j, v1);
+
         store_to_mem(p++, x1);
         store_to_mem(q++, y1);
         store_to_mem(r++, u1);
@@ -315,6 +457,8 @@ inline void do_butterfly_ct_2_layers(
  * @param m - current group size
  * @param len - number of vectors per buffer
  * @param card - modulo cardinal
+ * @param marks - if not nullptr, out-of-range outputs of the second layer are
+ * marked in it
  */
 template <typename T>
 inline void butterfly_ct_two_layers_step(
@@ -325,7 +469,8 @@ inline void butterfly_ct_two_layers_step(
     unsigned start,
     unsigned m,
     size_t len,
-    T card)
+    T card,
+    OorMarks* marks)
 {
     if (len == 0) {
         return;
@@ -335,7 +480,305 @@ inline void butterfly_ct_two_layers_step(
 
     const std::vector<T*>& mem = buf.get_mem();
     for (unsigned i = start; i < bufs_nb; i += step) {
-        do_butterfly_ct_2_layers(mem, r1, r2, r3, i, m, len, card);
+        do_butterfly_ct_2_layers(mem, r1, r2, r3, i, m, len, card, marks);
+    }
+}
+
+/**
+ * Cases of the butterflies of a codelet
+ *
+ * Coefficients of codelets of `Radix2` are 1 for the first butterfly of each
+ * layer of the first group, and generic ones otherwise: cases are then known
+ * at compile time.
+ */
+enum class CodeletCases {
+    FIRST,
+    NORMAL,
+    ANY,
+};
+
+/// Coefficients and cases of the butterflies of a codelet
+template <typename T, unsigned N>
+struct CodeletCoefs {
+    CodeletCoefs(const T* coefs, T card)
+    {
+        bool first = true;
+        bool normal = true;
+        for (unsigned t = 0; t < N - 1; ++t) {
+            cases[t] = get_case<T>(coefs[t], card);
+            c[t] = set_one(coefs[t]);
+            // first butterflies of layers are `t = 2^l - 1`
+            const bool is_first = ((t + 1) & t) == 0;
+            first &= cases[t]
+                     == (is_first ? CtGsCase::SIMPLE : CtGsCase::NORMAL);
+            normal &= cases[t] == CtGsCase::NORMAL;
+        }
+        kind = normal ? CodeletCases::NORMAL
+                      : (first ? CodeletCases::FIRST : CodeletCases::ANY);
+    }
+
+    /// Case of the butterfly `t`
+    template <CodeletCases K>
+    inline CtGsCase get(unsigned t) const
+    {
+        if (K == CodeletCases::ANY) {
+            return cases[t];
+        }
+        if (K == CodeletCases::FIRST && ((t + 1) & t) == 0) {
+            return CtGsCase::SIMPLE;
+        }
+        return CtGsCase::NORMAL;
+    }
+
+    CodeletCases kind;
+    CtGsCase cases[N - 1];
+    VecType c[N - 1];
+};
+
+/// Call `f(0), ..., f(N - 1)` in straight-line code
+template <typename F, unsigned... Ks>
+inline void unroll(F f, std::integer_sequence<unsigned, Ks...>)
+{
+    const int calls[] = {(f(Ks), 0)...};
+    (void)calls;
+}
+
+template <unsigned N, typename F>
+inline void unroll(F f)
+{
+    unroll(f, std::make_integer_sequence<unsigned, N>());
+}
+
+/**
+ * Layer of butterflies of a codelet on pairs of registers `(k, k + h)`
+ *
+ * The butterfly `b` of the layer is on `k = b / h * 2h + b % h`, with the
+ * coefficient `h - 1 + b % h`.
+ */
+template <typename T, unsigned N, CodeletCases K, bool CT>
+inline void
+codelet_layer(const CodeletCoefs<T, N>& coefs, unsigned h, VecType* x)
+{
+    unroll<N / 2>([&](unsigned b) {
+        const unsigned k = b / h * 2 * h + b % h;
+        const unsigned t = h - 1 + b % h;
+        const CtGsCase butterfly_case = coefs.template get<K>(t);
+        if (CT) {
+            butterfly_ct<T>(butterfly_case, coefs.c[t], x[k], x[k + h]);
+        } else {
+            butterfly_gs<T>(butterfly_case, coefs.c[t], x[k], x[k + h]);
+        }
+    });
+}
+
+// Codelets are flattened so that registers of all buffers of a group stay
+// in variables, see `unroll`
+template <typename T, unsigned D, CodeletCases K>
+inline void __attribute__((__flatten__)) butterfly_ct_codelets(
+    vec::Buffers<T>& buf,
+    const CodeletCoefs<T, 1U << D>& coefs,
+    unsigned start,
+    unsigned m,
+    size_t len,
+    T card,
+    OorMarks* marks)
+{
+    constexpr unsigned N = 1U << D;
+    const OorDetector<T> detector(card);
+    const unsigned bufs_nb = buf.get_n();
+    const std::vector<T*>& mem = buf.get_mem();
+
+    for (unsigned i = start; i < bufs_nb; i += m << D) {
+        VecType* p[N];
+        uint64_t* masks[N];
+        unroll<N>([&](unsigned k) {
+            p[k] = reinterpret_cast<VecType*>(mem[i + k * m]);
+            masks[k] = marks ? marks->get(i + k * m) : nullptr;
+        });
+
+        for (size_t j = 0; j < len; ++j) {
+            VecType x[N];
+            unroll<N>([&](unsigned k) { x[k] = load_to_reg(p[k] + j); });
+            unroll<D>([&](unsigned l) {
+                codelet_layer<T, N, K, true>(coefs, 1U << l, x);
+            });
+            unroll<N>([&](unsigned k) {
+                detector.mark(masks[k], j, x[k]);
+                store_to_mem(p[k] + j, x[k]);
+            });
+        }
+    }
+}
+
+template <typename T, unsigned D, CodeletCases K>
+inline void __attribute__((__flatten__)) butterfly_gs_codelets(
+    vec::Buffers<T>& buf,
+    const CodeletCoefs<T, 1U << D>& coefs,
+    unsigned start,
+    unsigned m,
+    size_t len)
+{
+    constexpr unsigned N = 1U << D;
+    const unsigned bufs_nb = buf.get_n();
+    const std::vector<T*>& mem = buf.get_mem();
+
+    for (unsigned i = start; i < bufs_nb; i += m << D) {
+        VecType* p[N];
+        unroll<N>([&](unsigned k) {
+            p[k] = reinterpret_cast<VecType*>(mem[i + k * m]);
+        });
+
+        for (size_t j = 0; j < len; ++j) {
+            VecType x[N];
+            unroll<N>([&](unsigned k) { x[k] = load_to_reg(p[k] + j); });
+            unroll<D>([&](unsigned l) {
+                codelet_layer<T, N, K, false>(coefs, N >> (l + 1), x);
+            });
+            unroll<N>([&](unsigned k) { store_to_mem(p[k] + j, x[k]); });
+        }
+    }
+}
+
+template <typename T, unsigned D>
+inline void butterfly_ct_codelets(
+    vec::Buffers<T>& buf,
+    const T* coefs,
+    unsigned start,
+    unsigned m,
+    size_t len,
+    T card,
+    OorMarks* marks)
+{
+    const CodeletCoefs<T, 1U << D> codelet(coefs, card);
+    switch (codelet.kind) {
+    case CodeletCases::FIRST:
+        butterfly_ct_codelets<T, D, CodeletCases::FIRST>(
+            buf, codelet, start, m, len, card, marks);
+        break;
+    case CodeletCases::NORMAL:
+        butterfly_ct_codelets<T, D, CodeletCases::NORMAL>(
+            buf, codelet, start, m, len, card, marks);
+        break;
+    case CodeletCases::ANY:
+        butterfly_ct_codelets<T, D, CodeletCases::ANY>(
+            buf, codelet, start, m, len, card, marks);
+        break;
+    }
+}
+
+template <typename T, unsigned D>
+inline void butterfly_gs_codelets(
+    vec::Buffers<T>& buf,
+    const T* coefs,
+    unsigned start,
+    unsigned m,
+    size_t len,
+    T card)
+{
+    const CodeletCoefs<T, 1U << D> codelet(coefs, card);
+    switch (codelet.kind) {
+    case CodeletCases::FIRST:
+        butterfly_gs_codelets<T, D, CodeletCases::FIRST>(
+            buf, codelet, start, m, len);
+        break;
+    case CodeletCases::NORMAL:
+        butterfly_gs_codelets<T, D, CodeletCases::NORMAL>(
+            buf, codelet, start, m, len);
+        break;
+    case CodeletCases::ANY:
+        butterfly_gs_codelets<T, D, CodeletCases::ANY>(
+            buf, codelet, start, m, len);
+        break;
+    }
+}
+
+/**
+ * Vectorized butterfly CT on `depth` layers at a time
+ *
+ * For each group of buffers (buf[i + k * m]) for k < 2^depth, a register of
+ * each buffer is loaded, goes through the `depth` layers of a radix-2^depth
+ * sub-transform and is stored back, i.e. a codelet. The layer of butterflies
+ * on pairs (buf[i + k * m], buf[i + (k + h) * m]) uses the coefficient
+ * `coefs[h - 1 + k % h]`, as `butterfly_ct_two_layers_step` does with
+ * `coefs = {r1, r2, r3}`.
+ *
+ * @param buf - working buffers
+ * @param coefs - coefficients of the `2^depth - 1` butterflies, by layer
+ * @param depth - number of layers, from 2 to 4; depths 3 and 4 are
+ * unreachable from `fft::Radix2` at the current `FFT_MAX_CODELET_DEPTH`
+ * @param start - index of buffer among `m` ones
+ * @param m - group size of the first layer
+ * @param len - number of vectors per buffer
+ * @param card - modulo cardinal
+ * @param marks - if not nullptr, out-of-range outputs of the last layer are
+ * marked in it
+ */
+template <typename T>
+inline void butterfly_ct_layers_step(
+    vec::Buffers<T>& buf,
+    const T* coefs,
+    unsigned depth,
+    unsigned start,
+    unsigned m,
+    size_t len,
+    T card,
+    OorMarks* marks)
+{
+    if (len == 0) {
+        return;
+    }
+    switch (depth) {
+    case 2:
+        butterfly_ct_codelets<T, 2>(buf, coefs, start, m, len, card, marks);
+        break;
+    case 3:
+        butterfly_ct_codelets<T, 3>(buf, coefs, start, m, len, card, marks);
+        break;
+    default:
+        butterfly_ct_codelets<T, 4>(buf, coefs, start, m, len, card, marks);
+        break;
+    }
+}
+
+/**
+ * Vectorized butterfly GS on `depth` layers at a time
+ *
+ * It is the inverse of `butterfly_ct_layers_step`: layers are performed from
+ * pairs (buf[i + k * m], buf[i + (k + 2^(depth-1)) * m]) down to pairs
+ * (buf[i + k * m], buf[i + (k + 1) * m]), with the same layout of `coefs`.
+ *
+ * @param buf - working buffers
+ * @param coefs - coefficients of the `2^depth - 1` butterflies, by layer
+ * @param depth - number of layers, from 2 to 4, see
+ * `butterfly_ct_layers_step`
+ * @param start - index of buffer among `m` ones
+ * @param m - group size of the last layer
+ * @param len - number of vectors per buffer
+ * @param card - modulo cardinal
+ */
+template <typename T>
+inline void butterfly_gs_layers_step(
+    vec::Buffers<T>& buf,
+    const T* coefs,
+    unsigned depth,
+    unsigned start,
+    unsigned m,
+    size_t len,
+    T card)
+{
+    if (len == 0) {
+        return;
+    }
+    switch (depth) {
+    case 2:
+        butterfly_gs_codelets<T, 2>(buf, coefs, start, m, len, card);
+        break;
+    case 3:
+        butterfly_gs_codelets<T, 3>(buf, coefs, start, m, len, card);
+        break;
+    default:
+        butterfly_gs_codelets<T, 4>(buf, coefs, start, m, len, card);
+        break;
     }
 }
 
@@ -350,6 +793,7 @@ inline void butterfly_ct_two_layers_step(
  * @param r - coefficient
  * @param start - index of buffer among `m` ones
  * @param m - current group size
+ * @param step - next loop
  * @param len - number of vectors per buffer
  * @param card - modulo cardinal
  */
@@ -359,13 +803,13 @@ inline void butterfly_gs_step(
     T r,
     unsigned start,
     unsigned m,
+    unsigned step,
     size_t len,
     T card)
 {
     if (len == 0) {
         return;
     }
-    const unsigned step = m << 1;
     const CtGsCase gs_case = get_case<T>(r, card);
     VecType c = set_one(r);
 
@@ -397,6 +841,7 @@ inline void butterfly_gs_step(
  * @param r - coefficient
  * @param start - index of buffer among `m` ones
  * @param m - current group size
+ * @param step - next loop
  * @param len - number of vectors per buffer
  * @param card - modulo cardinal
  */
@@ -406,13 +851,13 @@ inline void butterfly_gs_step_simple(
     T r,
     unsigned start,
     unsigned m,
+    unsigned step,
     size_t len,
     T card)
 {
     if (len == 0) {
         return;
     }
-    const unsigned step = m << 1;
     const CtGsCase gs_case = get_case<T>(r, card);
     VecType c = set_one(r);
 
@@ -432,23 +877,29 @@ inline void butterfly_gs_step_simple(
     }
 }
 
+/**
+ * Mark out-of-range symbols of packets
+ *
+ * @param output - packets
+ * @param marks - marks of the packets, one bit per byte, see `OorMarks`
+ * @param code_len - number of packets
+ * @param card - modulo cardinal, out-of-range symbols are `card - 1`
+ * @param vecs_nb - number of vectors per packet
+ */
 template <typename T>
 inline void encode_post_process(
     vec::Buffers<T>& output,
-    std::vector<Properties>& props,
-    off_t offset,
+    OorMarks& marks,
     unsigned code_len,
-    T threshold,
+    T card,
     size_t vecs_nb)
 {
-    const unsigned vec_size = countof<T>();
-    const T max = 1U << (sizeof(T) * CHAR_BIT - 1);
-    const VecType _threshold = set_one(threshold);
-    const VecType mask_hi = set_one(max);
+    const OorDetector<T> detector(card);
 
     const std::vector<T*>& mem = output.get_mem();
     for (unsigned frag_id = 0; frag_id < code_len; ++frag_id) {
         VecType* buf = reinterpret_cast<VecType*>(mem[frag_id]);
+        uint64_t* mask = marks.get(frag_id);
 
         size_t vec_id = 0;
         size_t end = (vecs_nb > 3) ? vecs_nb - 3 : 0;
@@ -458,38 +909,18 @@ inline void encode_post_process(
             VecType a3 = load_to_reg(buf + vec_id + 2);
             VecType a4 = load_to_reg(buf + vec_id + 3);
 
-            if (!and_is_zero(a1, _threshold)) {
-                const off_t curr_offset = offset + vec_id * vec_size;
-                add_props(
-                    props[frag_id], _threshold, mask_hi, a1, curr_offset, max);
-            }
-            if (!and_is_zero(a2, _threshold)) {
-                const off_t curr_offset = offset + (vec_id + 1) * vec_size;
-                add_props(
-                    props[frag_id], _threshold, mask_hi, a2, curr_offset, max);
-            }
-            if (!and_is_zero(a3, _threshold)) {
-                const off_t curr_offset = offset + (vec_id + 2) * vec_size;
-                add_props(
-                    props[frag_id], _threshold, mask_hi, a3, curr_offset, max);
-            }
-            if (!and_is_zero(a4, _threshold)) {
-                const off_t curr_offset = offset + (vec_id + 3) * vec_size;
-                add_props(
-                    props[frag_id], _threshold, mask_hi, a4, curr_offset, max);
-            }
+            detector.mark(mask, vec_id, a1);
+            detector.mark(mask, vec_id + 1, a2);
+            detector.mark(mask, vec_id + 2, a3);
+            detector.mark(mask, vec_id + 3, a4);
         }
         for (; vec_id < vecs_nb; ++vec_id) {
-            VecType a = load_to_reg(buf + vec_id);
-            if (!and_is_zero(a, _threshold)) {
-                const off_t curr_offset = offset + vec_id * vec_size;
-                add_props(
-                    props[frag_id], _threshold, mask_hi, a, curr_offset, max);
-            }
+            detector.mark(mask, vec_id, load_to_reg(buf + vec_id));
         }
     }
 }
 
+} // namespace QUADIRON_SIMD_ISA
 } // namespace simd
 } // namespace quadiron
 
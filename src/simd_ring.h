@@ -31,10 +31,11 @@
 #ifndef __QUAD_SIMD_RING_H__
 #define __QUAD_SIMD_RING_H__
 
-#include <x86intrin.h>
+#include "arith.h"
 
 namespace quadiron {
 namespace simd {
+inline namespace QUADIRON_SIMD_ISA {
 
 /* ==================== Operations for RingModN =================== */
 /** Perform a multiplication of a coefficient `a` to each element of `src` and
@@ -121,6 +122,52 @@ inline void sub_two_bufs(T* bufa, T* bufb, T* res, size_t len, T card)
     }
 }
 
+/** Perform a multiplication of a coefficient `a` to each element of `src` and
+ *  add result to correspondent element of `dest`
+ */
+template <typename T>
+inline void mul_coef_add_to_buf(const T a, T* src, T* dest, size_t len, T card)
+{
+    if (a == 0) {
+        return;
+    } else if (a == 1) {
+        add_two_bufs(src, dest, len, card);
+        return;
+    } else if (a == card - 1) {
+        sub_two_bufs(dest, src, dest, len, card);
+        return;
+    }
+
+    const VecType coef = set_one(a);
+
+    VecType* _src = reinterpret_cast<VecType*>(src);
+    VecType* _dest = reinterpret_cast<VecType*>(dest);
+    const unsigned ratio = sizeof(*_src) / sizeof(*src);
+    const size_t _len = len / ratio;
+    const size_t _last_len = len - _len * ratio;
+
+    size_t i = 0;
+    const size_t end = (_len > 3) ? _len - 3 : 0;
+    for (; i < end; i += 4) {
+        _dest[i] = mod_add<T>(_dest[i], mod_mul<T>(coef, _src[i]));
+        _dest[i + 1] = mod_add<T>(_dest[i + 1], mod_mul<T>(coef, _src[i + 1]));
+        _dest[i + 2] = mod_add<T>(_dest[i + 2], mod_mul<T>(coef, _src[i + 2]));
+        _dest[i + 3] = mod_add<T>(_dest[i + 3], mod_mul<T>(coef, _src[i + 3]));
+    }
+    for (; i < _len; ++i) {
+        _dest[i] = mod_add<T>(_dest[i], mod_mul<T>(coef, _src[i]));
+    }
+
+    if (_last_len > 0) {
+        const DoubleSizeVal<T> coef_double = DoubleSizeVal<T>(a);
+        for (size_t i = _len * ratio; i < len; i++) {
+            const T tmp = static_cast<T>((coef_double * src[i]) % card);
+            dest[i] = (dest[i] >= card - tmp) ? dest[i] - (card - tmp)
+                                               : dest[i] + tmp;
+        }
+    }
+}
+
 template <typename T>
 inline void mul_two_bufs(T* src, T* dest, size_t len, T card)
 {
@@ -165,6 +212,7 @@ inline void neg(size_t len, T* buf, T card)
     }
 }
 
+} // namespace QUADIRON_SIMD_ISA
 } // namespace simd
 } // namespace quadiron
 
@@ -0,0 +1,197 @@
+/*
+ * Copyright 2017-2018 Scality
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its contributors
+ *    may be used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef __QUAD_SIMD_SWAR_H__
+#define __QUAD_SIMD_SWAR_H__
+
+#include <cstdint>
+
+namespace quadiron {
+namespace simd {
+inline namespace QUADIRON_SIMD_ISA {
+
+/** A 64-bit word holding 16-bit or 32-bit lanes (SIMD within a register)
+ *
+ * Lanes are processed at once by plain integer instructions: carries and
+ * borrows are kept inside lanes by handling their most significant bit
+ * apart. As vector types, it may alias buffers of any type.
+ */
+typedef uint64_t __attribute__((__may_alias__)) VecType;
+
+/// Word whose lanes of type T are set to 1
+template <typename T>
+constexpr VecType lanes_lsb()
+{
+    return ~VecType(0) / ((VecType(1) << (sizeof(T) * CHAR_BIT)) - 1);
+}
+
+/// Word whose lanes of type T have only their most significant bit set
+template <typename T>
+constexpr VecType lanes_msb()
+{
+    return lanes_lsb<T>() << (sizeof(T) * CHAR_BIT - 1);
+}
+
+/// Expand the most significant bit of each lane to the whole lane
+template <typename T>
+inline VecType lanes_expand_msb(const VecType& x)
+{
+    const VecType msb = x & lanes_msb<T>();
+    return (msb - (msb >> (sizeof(T) * CHAR_BIT - 1))) | msb;
+}
+
+/* ============= Constant variable  ============ */
+
+template <typename T>
+inline VecType one()
+{
+    return lanes_lsb<T>();
+}
+
+inline VecType zero()
+{
+    return 0;
+}
+
+/* ============ Essential Operations for SWAR w/ both u16 & u32 ============ */
+
+inline VecType load_to_reg(VecType* address)
+{
+    return *address;
+}
+inline void store_to_mem(VecType* address, VecType reg)
+{
+    *address = reg;
+}
+
+inline VecType bit_and(const VecType& x, const VecType& y)
+{
+    return x & y;
+}
+inline VecType bit_xor(const VecType& x, const VecType& y)
+{
+    return x ^ y;
+}
+inline VecType bit_or(const VecType& x, const VecType& y)
+{
+    return x | y;
+}
+
+/** Gather the most significant bit of each byte, as `_mm_movemask_epi8`
+ *
+ * The multiplication moves the MSB of the byte `i` to the bit `56 + i`
+ * without any carry.
+ */
+inline uint16_t msb8_mask(const VecType& x)
+{
+    const VecType msb = x & lanes_msb<uint8_t>();
+    return static_cast<uint16_t>((msb * 0x0002040810204081ULL) >> 56);
+}
+inline bool and_is_zero(const VecType& x, const VecType& y)
+{
+    return (x & y) == 0;
+}
+inline bool is_zero(const VecType& x)
+{
+    return x == 0;
+}
+
+/* ================= Essential Operations for SWAR ================= */
+
+template <typename T>
+inline VecType set_one(T val)
+{
+    return lanes_lsb<T>() * val;
+}
+
+template <typename T>
+inline VecType add(const VecType& x, const VecType& y)
+{
+    const VecType msb = lanes_msb<T>();
+    return ((x & ~msb) + (y & ~msb)) ^ ((x ^ y) & msb);
+}
+
+template <typename T>
+inline VecType sub(const VecType& x, const VecType& y)
+{
+    const VecType msb = lanes_msb<T>();
+    return ((x | msb) - (y & ~msb)) ^ ((x ^ ~y) & msb);
+}
+
+/// Lane-wise product, lanes are multiplied one by one
+template <typename T>
+inline VecType mul(const VecType& x, const VecType& y)
+{
+    constexpr unsigned bits = sizeof(T) * CHAR_BIT;
+    VecType res = 0;
+    for (unsigned i = 0; i < sizeof(VecType) / sizeof(T); ++i) {
+        const VecType prod = VecType(T(x >> (i * bits))) * T(y >> (i * bits));
+        res |= VecType(T(prod)) << (i * bits);
+    }
+    return res;
+}
+
+/// High half of the lane-wise product, lanes are multiplied one by one
+template <typename T>
+inline VecType mulhi(const VecType& x, const VecType& y)
+{
+    constexpr unsigned bits = sizeof(T) * CHAR_BIT;
+    VecType res = 0;
+    for (unsigned i = 0; i < sizeof(VecType) / sizeof(T); ++i) {
+        const VecType prod = VecType(T(x >> (i * bits))) * T(y >> (i * bits));
+        res |= VecType(T(prod >> bits)) << (i * bits);
+    }
+    return res;
+}
+
+template <typename T>
+inline VecType compare_eq(const VecType& x, const VecType& y)
+{
+    const VecType msb = lanes_msb<T>();
+    const VecType diff = x ^ y;
+    // the MSB of non-null lanes is set
+    const VecType non_zero = (((diff & ~msb) + ~msb) | diff) & msb;
+    return lanes_expand_msb<T>(non_zero ^ msb);
+}
+
+template <typename T>
+inline VecType min(const VecType& x, const VecType& y)
+{
+    // the MSB of lanes where `x < y` is set, it is the borrow of `x - y`
+    const VecType borrow = (~x & y) | (~(x ^ y) & sub<T>(x, y));
+    const VecType lower = lanes_expand_msb<T>(borrow);
+    return (x & lower) | (y & ~lower);
+}
+
+} // namespace QUADIRON_SIMD_ISA
+} // namespace simd
+} // namespace quadiron
+
+#endif
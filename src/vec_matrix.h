@@ -34,6 +34,7 @@
 #include <iostream>
 
 #include "gf_ring.h"
+#include "vec_buffers.h"
 #include "vec_vector.h"
 
 namespace quadiron {
@@ -65,6 +66,7 @@ class Matrix {
     virtual const T& get(int i, int j);
     void inv(void);
     void mul(vec::Vector<T>* output, vec::Vector<T>* v);
+    void mul(vec::Buffers<T>* output, vec::Buffers<T>* v);
     void vandermonde(void);
     void vandermonde_suitable_for_ec(void);
     void cauchy(void);
@@ -403,6 +405,49 @@ void Matrix<T>::mul(vec::Vector<T>* output, vec::Vector<T>* v)
     }
 }
 
+/** Multiply the matrix by a vector of buffers
+ *
+ * Each buffer of `output` is the linear combination of the buffers of `v`
+ * weighted by the corresponding row of the matrix, i.e.
+ * \f$output_i = \sum_j matrix_{i, j} \cdot v_j\f$ computed over the whole
+ * buffers.
+ *
+ * @param output vector of `n_rows` buffers
+ * @param v vector of `n_cols` buffers of the same size as `output` ones
+ */
+template <typename T>
+void Matrix<T>::mul(vec::Buffers<T>* output, vec::Buffers<T>* v)
+{
+    int i, j;
+
+    assert(get_n_cols() == v->get_n());
+    assert(get_n_rows() == output->get_n());
+    assert(output->get_size() == v->get_size());
+
+    const size_t len = v->get_size();
+    const std::vector<T*>& src = v->get_mem();
+    const std::vector<T*>& dest = output->get_mem();
+
+    for (i = 0; i < n_rows; i++) {
+        bool first = true;
+        for (j = 0; j < n_cols; j++) {
+            const T coef = get(i, j);
+            if (coef == 0) {
+                continue;
+            }
+            if (first) {
+                rn->mul_coef_to_buf(coef, src[j], dest[i], len);
+                first = false;
+            } else {
+                rn->mul_coef_add_to_buf(coef, src[j], dest[i], len);
+            }
+        }
+        if (first) {
+            output->fill(i, 0);
+        }
+    }
+}
+
 template <typename T>
 void Matrix<T>::cauchy()
 {
@@ -417,14 +462,16 @@ void Matrix<T>::cauchy()
     /* do optimise */
     // convert 1st row to all 1s
     for (j = 0; j < n_cols; j++) {
+        const T factor = get(0, j);
         for (i = 0; i < n_rows; i++) {
-            set(i, j, rn->div(get(i, j), get(0, j)));
+            set(i, j, rn->div(get(i, j), factor));
         }
     }
     // convert 1st element of each row to 1
     for (i = 1; i < n_rows; i++) {
+        const T factor = get(i, 0);
         for (j = 0; j < n_cols; j++) {
-            set(i, j, rn->div(get(i, j), get(i, 0)));
+            set(i, j, rn->div(get(i, j), factor));
         }
     }
 }
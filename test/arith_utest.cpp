@@ -327,6 +327,46 @@ TYPED_TEST(ArithTestNo128, TestExtendedGcd) // NOLINT
     ASSERT_TRUE(bezout[0] == -7 && bezout[1] == 34);
 }
 
+TYPED_TEST(ArithTestNo128, TestModMulReduction) // NOLINT
+{
+    const unsigned bits = 8 * sizeof(TypeParam);
+    // largest primes supported by the Barrett and the Shoup reductions
+    const TypeParam large_barrett =
+        sizeof(TypeParam) == 4 ? 1073741789 : 2305843009213693951; // 2^61-1
+    const TypeParam large_shoup =
+        sizeof(TypeParam) == 4 ? 2147483647 : 9223372036854775783ULL;
+    const std::vector<TypeParam> moduli = {
+        2, 3, 32, 257, 65537, large_barrett, large_shoup};
+
+    ASSERT_EQ(arith::barrett_len<TypeParam>(large_shoup), 0);
+
+    for (const TypeParam q : moduli) {
+        std::uniform_int_distribution<TypeParam> dis(0, q - 1);
+        const unsigned len = arith::barrett_len<TypeParam>(q);
+        const TypeParam factor =
+            len > 0 ? arith::barrett_factor<TypeParam>(q) : 0;
+
+        for (int i = 0; i < 1000; i++) {
+            const TypeParam a = i == 0 ? q - 1 : dis(quadiron::prng());
+            const TypeParam w = i < 2 ? q - 1 - i : dis(quadiron::prng());
+            const TypeParam expected = static_cast<TypeParam>(
+                (quadiron::DoubleSizeVal<TypeParam>(a) * w) % q);
+
+            if (len > 0) {
+                ASSERT_EQ(arith::mul_barrett(a, w, q, factor, len), expected);
+            }
+            const TypeParam w_shoup = arith::shoup_companion(w, q);
+            ASSERT_EQ(arith::mul_shoup(a, w, w_shoup, q), expected);
+            // the Shoup reduction also supports any first operand
+            const TypeParam x = a + (static_cast<TypeParam>(1) << (bits - 1));
+            ASSERT_EQ(
+                arith::mul_shoup(x, w, w_shoup, q),
+                static_cast<TypeParam>(
+                    (quadiron::DoubleSizeVal<TypeParam>(x) * w) % q));
+        }
+    }
+}
+
 // Schönhage-Strassen algorithm (example taken from Pierre Meunier's book).
 TEST(ArithTest, TestBignumMultiplication) // NOLINT
 {
@@ -27,6 +27,11 @@
  * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
  * POSSIBILITY OF SUCH DAMAGE.
  */
+#include <algorithm>
+#include <numeric>
+#include <random>
+#include <thread>
+
 #include <gtest/gtest.h>
 
 #include "quadiron.h"
@@ -93,6 +98,116 @@ class FecTestCommon : public ::testing::Test {
             ASSERT_EQ(copied_data_frags, decoded_frags);
         }
     }
+
+    /** Encode and decode blocks of a non-systematic code
+     *
+     * The first `n_parities` fragments are lost.
+     */
+    void run_test_blocks(fec::FecCode<T>& fec, size_t word_size)
+    {
+        // not a multiple of the packet size to cover the trailing packet
+        const size_t block_size = 1001 * word_size;
+        const unsigned n_outputs = fec.n_outputs;
+        std::mt19937 prng(n_data);
+        std::uniform_int_distribution<int> dis(0, 255);
+
+        std::vector<std::vector<uint8_t>> data(
+            n_data, std::vector<uint8_t>(block_size));
+        std::vector<uint8_t*> data_bufs(n_data);
+        for (unsigned i = 0; i < n_data; i++) {
+            for (auto& byte : data[i]) {
+                byte = static_cast<uint8_t>(dis(prng));
+            }
+            data_bufs[i] = data[i].data();
+        }
+        std::vector<std::vector<uint8_t>> parities(
+            n_outputs, std::vector<uint8_t>(block_size));
+        std::vector<uint8_t*> parities_bufs(n_outputs);
+        for (unsigned i = 0; i < n_outputs; i++) {
+            parities_bufs[i] = parities[i].data();
+        }
+        std::vector<quadiron::Properties> props(n_outputs);
+        std::vector<bool> wanted_parities(n_outputs, true);
+        fec.encode_blocks_vertical(
+            data_bufs, parities_bufs, props, wanted_parities, block_size);
+
+        std::vector<std::vector<uint8_t>> repaired(
+            n_data, std::vector<uint8_t>(block_size));
+        std::vector<uint8_t*> repaired_bufs(n_data);
+        for (unsigned i = 0; i < n_data; i++) {
+            repaired_bufs[i] = repaired[i].data();
+        }
+        std::vector<int> missing_idxs(n_outputs, 0);
+        for (unsigned i = 0; i < n_parities; i++) {
+            parities_bufs[i] = nullptr;
+            missing_idxs[i] = 1;
+        }
+        std::vector<bool> wanted_data(n_data, true);
+        ASSERT_TRUE(fec.decode_blocks_vertical(
+            repaired_bufs,
+            parities_bufs,
+            props,
+            missing_idxs,
+            wanted_data,
+            block_size));
+        ASSERT_EQ(repaired, data);
+    }
+
+    /** Check that blocks encoded by several threads are the same as the ones
+     * encoded by a single thread
+     */
+    void run_test_blocks_threads(fec::FecCode<T>& fec, size_t block_size)
+    {
+        const unsigned n_outputs = fec.n_outputs;
+        std::mt19937 prng(n_data);
+        std::uniform_int_distribution<int> dis(0, 255);
+
+        std::vector<std::vector<uint8_t>> data(
+            fec.n_data, std::vector<uint8_t>(block_size));
+        std::vector<uint8_t*> data_bufs(fec.n_data);
+        for (unsigned i = 0; i < fec.n_data; i++) {
+            for (auto& byte : data[i]) {
+                byte = static_cast<uint8_t>(dis(prng));
+            }
+            data_bufs[i] = data[i].data();
+        }
+        std::vector<bool> wanted_idxs(n_outputs, true);
+
+        std::vector<std::vector<uint8_t>> ref_parities(
+            n_outputs, std::vector<uint8_t>(block_size));
+        std::vector<uint8_t*> ref_parities_bufs(n_outputs);
+        std::vector<quadiron::Properties> ref_props(n_outputs);
+        for (unsigned i = 0; i < n_outputs; i++) {
+            ref_parities_bufs[i] = ref_parities[i].data();
+        }
+        fec.encode_blocks_vertical(
+            data_bufs, ref_parities_bufs, ref_props, wanted_idxs, block_size);
+
+        std::unique_ptr<fec::Workspace<T>> ws = fec.make_workspace();
+        for (unsigned nb_threads : {2, 3, 4}) {
+            fec.set_nb_threads(nb_threads);
+
+            std::vector<std::vector<uint8_t>> parities(
+                n_outputs, std::vector<uint8_t>(block_size));
+            std::vector<uint8_t*> parities_bufs(n_outputs);
+            std::vector<quadiron::Properties> props(n_outputs);
+            for (unsigned i = 0; i < n_outputs; i++) {
+                parities_bufs[i] = parities[i].data();
+            }
+            fec.encode_blocks_vertical(
+                data_bufs,
+                parities_bufs,
+                props,
+                wanted_idxs,
+                block_size,
+                *ws);
+
+            for (unsigned i = 0; i < n_outputs; i++) {
+                ASSERT_EQ(parities[i], ref_parities[i]);
+                ASSERT_EQ(props[i].get_map(), ref_props[i].get_map());
+            }
+        }
+    }
 };
 
 using AllTypes = ::testing::Types<uint32_t, uint64_t, __uint128_t>;
@@ -116,9 +231,18 @@ TYPED_TEST(FecTestCommon, TestGf2nFft) // NOLINT
         fec::RsGf2nFft<TypeParam> fec(wordsize, this->n_data, this->n_parities);
 
         this->run_test(fec);
+        this->run_test_blocks(fec, wordsize);
     }
 }
 
+TYPED_TEST(FecTestCommon, TestGf2nFftThreads) // NOLINT
+{
+    const size_t word_size = 2;
+    // a code of length 15, encoded by a mixed-radix FFT
+    fec::RsGf2nFft<TypeParam> fec(word_size, 5, 4);
+    this->run_test_blocks_threads(fec, 20001 * word_size);
+}
+
 TYPED_TEST(FecTestCommon, TestGf2nFftAdd) // NOLINT
 {
     for (size_t wordsize = 1; wordsize <= sizeof(TypeParam); wordsize *= 2) {
@@ -126,9 +250,17 @@ TYPED_TEST(FecTestCommon, TestGf2nFftAdd) // NOLINT
             wordsize, this->n_data, this->n_parities);
 
         this->run_test(fec);
+        this->run_test_blocks(fec, wordsize);
     }
 }
 
+TYPED_TEST(FecTestCommon, TestGf2nFftAddThreads) // NOLINT
+{
+    const size_t word_size = 2;
+    fec::RsGf2nFftAdd<TypeParam> fec(word_size, 5, 4);
+    this->run_test_blocks_threads(fec, 20001 * word_size);
+}
+
 template <typename T>
 class FecTestFnt : public FecTestCommon<T> {
 };
@@ -138,13 +270,13 @@ TYPED_TEST_CASE(FecTestFnt, FntType);
 
 TYPED_TEST(FecTestFnt, TestFnt) // NOLINT
 {
-    const size_t word_size = sizeof(TypeParam) / 2;
-    fec::RsFnt<TypeParam> fec(
-        fec::FecType::NON_SYSTEMATIC,
-        word_size,
-        this->n_data,
-        this->n_parities);
-    this->run_test(fec, true);
+    // smaller words compute modulo a prime other than the one of the lanes
+    for (size_t ws = 1; ws <= sizeof(TypeParam) / 2; ws *= 2) {
+        fec::RsFnt<TypeParam> fec(
+            fec::FecType::NON_SYSTEMATIC, ws, this->n_data, this->n_parities);
+        this->run_test(fec, true);
+        this->run_test_blocks(fec, ws);
+    }
 }
 
 TYPED_TEST(FecTestFnt, TestFntSys) // NOLINT
@@ -155,6 +287,495 @@ TYPED_TEST(FecTestFnt, TestFntSys) // NOLINT
     this->run_test(fec, true);
 }
 
+TYPED_TEST(FecTestFnt, TestEncodeBlocksThreads) // NOLINT
+{
+    const size_t word_size = sizeof(TypeParam) / 2;
+    const size_t pkt_size = 64;
+
+    for (auto type : {fec::FecType::SYSTEMATIC, fec::FecType::NON_SYSTEMATIC}) {
+        fec::RsFnt<TypeParam> fec(
+            type, word_size, this->n_data, this->n_parities, pkt_size);
+        // not a multiple of the packet size to cover the trailing packet
+        this->run_test_blocks_threads(fec, 100002);
+    }
+}
+
+TYPED_TEST(FecTestFnt, TestOorMarks) // NOLINT
+{
+    const size_t word_size = sizeof(TypeParam) / 2;
+    // not a multiple of the number of elements in a register
+    const size_t pkt_size = 100;
+    const size_t block_size = 100002;
+    std::mt19937 prng(this->n_data);
+    std::uniform_int_distribution<int> dis(0, 255);
+    std::uniform_int_distribution<TypeParam> dis_word(
+        0, (1ULL << (8 * word_size)) - 1);
+
+    // the last layer of the FFT is done alone, along with the previous one,
+    // or there is no layer at all
+    const std::vector<std::pair<unsigned, unsigned>> params = {
+        {3, 3}, {4, 4}, {1, 2}};
+    for (const auto& param : params) {
+        const unsigned n_data = param.first;
+        for (auto type :
+             {fec::FecType::SYSTEMATIC, fec::FecType::NON_SYSTEMATIC}) {
+            fec::RsFnt<TypeParam> fec(
+                type, word_size, n_data, param.second, pkt_size);
+            const unsigned n_outputs = fec.n_outputs;
+
+            // marks set by the FFT equal the ones found by a pass over the
+            // outputs
+            vec::Buffers<TypeParam> words(n_data, pkt_size);
+            vec::Buffers<TypeParam> output(n_outputs, pkt_size);
+            for (off_t offset = 0; offset < 10000; offset += pkt_size) {
+                for (unsigned i = 0; i < n_data; i++) {
+                    for (size_t j = 0; j < pkt_size; j++) {
+                        words.get(i)[j] = dis_word(prng);
+                    }
+                }
+                std::vector<quadiron::Properties> props(n_outputs);
+                std::vector<quadiron::Properties> ref_props(n_outputs);
+                fec.encode(output, props, offset, words);
+                fec.encode_post_process(output, ref_props, offset);
+                for (unsigned i = 0; i < n_outputs; i++) {
+                    ASSERT_EQ(props[i].get_map(), ref_props[i].get_map());
+                }
+            }
+
+            // marks of a pruned FFT
+            std::vector<std::vector<uint8_t>> data(
+                n_data, std::vector<uint8_t>(block_size));
+            std::vector<uint8_t*> data_bufs(n_data);
+            for (unsigned i = 0; i < n_data; i++) {
+                for (auto& byte : data[i]) {
+                    byte = static_cast<uint8_t>(dis(prng));
+                }
+                data_bufs[i] = data[i].data();
+            }
+            std::vector<std::vector<uint8_t>> parities(
+                n_outputs, std::vector<uint8_t>(block_size));
+            std::vector<uint8_t*> parities_bufs(n_outputs);
+            for (unsigned i = 0; i < n_outputs; i++) {
+                parities_bufs[i] = parities[i].data();
+            }
+            std::vector<bool> wanted_idxs(n_outputs, true);
+            std::vector<quadiron::Properties> ref_props(n_outputs);
+            fec.encode_blocks_vertical(
+                data_bufs, parities_bufs, ref_props, wanted_idxs, block_size);
+
+            for (unsigned i = 0; i < n_outputs; i++) {
+                std::fill(wanted_idxs.begin(), wanted_idxs.end(), false);
+                wanted_idxs[i] = true;
+                std::vector<quadiron::Properties> props(n_outputs);
+                fec.encode_blocks_vertical(
+                    data_bufs, parities_bufs, props, wanted_idxs, block_size);
+                ASSERT_EQ(props[i].get_map(), ref_props[i].get_map());
+            }
+        }
+    }
+}
+
+#ifdef QUADIRON_USE_SIMD
+TYPED_TEST(FecTestFnt, TestSimdDispatch) // NOLINT
+{
+    namespace simd = quadiron::simd;
+
+    const size_t word_size = sizeof(TypeParam) / 2;
+    // not a multiple of the number of elements in a register
+    const size_t pkt_size = 100;
+    const size_t block_size = 20002;
+    std::mt19937 prng(this->n_data);
+    std::uniform_int_distribution<int> dis(0, 255);
+
+    std::vector<simd::InstructionSet> sets;
+    for (auto set :
+         {simd::InstructionSet::SSE,
+          simd::InstructionSet::AVX,
+          simd::InstructionSet::NEON,
+          simd::InstructionSet::NONE}) {
+        if (simd::is_supported(set)) {
+            sets.push_back(set);
+        }
+    }
+    ASSERT_FALSE(sets.empty());
+    const simd::InstructionSet default_set = simd::get_instruction_set();
+    ASSERT_TRUE(simd::is_supported(default_set));
+
+    std::vector<std::vector<uint8_t>> data(
+        this->n_data, std::vector<uint8_t>(block_size));
+    std::vector<uint8_t*> data_bufs(this->n_data);
+    for (unsigned i = 0; i < this->n_data; i++) {
+        for (auto& byte : data[i]) {
+            byte = static_cast<uint8_t>(dis(prng));
+        }
+        data_bufs[i] = data[i].data();
+    }
+
+    for (auto type : {fec::FecType::SYSTEMATIC, fec::FecType::NON_SYSTEMATIC}) {
+        std::vector<std::vector<uint8_t>> ref_parities;
+        std::vector<quadiron::Properties> ref_props;
+
+        for (auto set : sets) {
+            simd::set_instruction_set(set);
+            ASSERT_EQ(simd::get_instruction_set(), set);
+            ASSERT_EQ(
+                simd::vec_countof<TypeParam>(),
+                simd::kernel_countof<TypeParam>(set));
+
+            fec::RsFnt<TypeParam> fec(
+                type, word_size, this->n_data, this->n_parities, pkt_size);
+            const unsigned n_outputs = fec.n_outputs;
+
+            std::vector<bool> wanted_idxs(n_outputs, true);
+            std::vector<std::vector<uint8_t>> parities(
+                n_outputs, std::vector<uint8_t>(block_size));
+            std::vector<uint8_t*> parities_bufs(n_outputs);
+            std::vector<quadiron::Properties> props(n_outputs);
+            for (unsigned i = 0; i < n_outputs; i++) {
+                parities_bufs[i] = parities[i].data();
+            }
+            fec.encode_blocks_vertical(
+                data_bufs, parities_bufs, props, wanted_idxs, block_size);
+
+            // every instruction set gives the same fragments
+            if (ref_parities.empty()) {
+                ref_parities = parities;
+                ref_props = props;
+                continue;
+            }
+            for (unsigned i = 0; i < n_outputs; i++) {
+                ASSERT_EQ(parities[i], ref_parities[i]);
+                ASSERT_EQ(props[i].get_map(), ref_props[i].get_map());
+            }
+        }
+    }
+
+    simd::set_instruction_set(default_set);
+}
+#endif
+
+TYPED_TEST(FecTestFnt, TestSharedCode) // NOLINT
+{
+    const size_t word_size = sizeof(TypeParam) / 2;
+    const size_t pkt_size = 64;
+    const size_t block_size = 10002;
+    const unsigned nb_threads = 4;
+    std::mt19937 prng(this->n_data);
+    std::uniform_int_distribution<int> dis(0, 255);
+
+    for (auto type : {fec::FecType::SYSTEMATIC, fec::FecType::NON_SYSTEMATIC}) {
+        fec::RsFnt<TypeParam> fec(
+            type, word_size, this->n_data, this->n_parities, pkt_size);
+        const unsigned n_outputs = fec.n_outputs;
+        const bool systematic = type == fec::FecType::SYSTEMATIC;
+
+        std::vector<std::vector<std::vector<uint8_t>>> data(nb_threads);
+        for (auto& blocks : data) {
+            blocks.assign(this->n_data, std::vector<uint8_t>(block_size));
+            for (auto& block : blocks) {
+                for (auto& byte : block) {
+                    byte = static_cast<uint8_t>(dis(prng));
+                }
+            }
+        }
+        // not a vector of bool, whose elements share words written by threads
+        std::vector<char> success(nb_threads, false);
+
+        // each thread encodes its own blocks then decodes them after having
+        // lost the first parity and all data but the last one
+        auto run = [&](unsigned t) {
+            std::unique_ptr<fec::Workspace<TypeParam>> ws =
+                fec.make_workspace();
+            std::vector<uint8_t*> data_bufs(this->n_data);
+            for (unsigned i = 0; i < this->n_data; i++) {
+                data_bufs[i] = data[t][i].data();
+            }
+            std::vector<std::vector<uint8_t>> parities(
+                n_outputs, std::vector<uint8_t>(block_size));
+            std::vector<uint8_t*> parities_bufs(n_outputs);
+            for (unsigned i = 0; i < n_outputs; i++) {
+                parities_bufs[i] = parities[i].data();
+            }
+            std::vector<quadiron::Properties> props(n_outputs);
+            std::vector<bool> wanted_idxs(n_outputs, true);
+
+            for (int round = 0; round < 10; round++) {
+                fec.encode_blocks_vertical(
+                    data_bufs,
+                    parities_bufs,
+                    props,
+                    wanted_idxs,
+                    block_size,
+                    *ws);
+
+                std::vector<std::vector<uint8_t>> repaired(
+                    this->n_data, std::vector<uint8_t>(block_size));
+                std::vector<uint8_t*> avail_data_bufs(this->n_data, nullptr);
+                std::vector<uint8_t*> avail_parities_bufs(n_outputs);
+                std::vector<int> missing_idxs(
+                    this->n_data + this->n_parities, 1);
+                std::vector<bool> wanted_data(this->n_data, true);
+                for (unsigned i = 0; i < this->n_data; i++) {
+                    avail_data_bufs[i] = repaired[i].data();
+                }
+                if (systematic) {
+                    avail_data_bufs[this->n_data - 1] =
+                        data_bufs[this->n_data - 1];
+                    missing_idxs[this->n_data - 1] = 0;
+                    wanted_data[this->n_data - 1] = false;
+                }
+                for (unsigned i = 0; i < n_outputs; i++) {
+                    const unsigned idx = systematic ? this->n_data + i : i;
+                    const bool lost =
+                        idx + 1 < this->n_data || idx == this->n_data;
+                    avail_parities_bufs[i] = lost ? nullptr : parities_bufs[i];
+                    missing_idxs[idx] = lost ? 1 : 0;
+                }
+
+                if (!fec.decode_blocks_vertical(
+                        avail_data_bufs,
+                        avail_parities_bufs,
+                        props,
+                        missing_idxs,
+                        wanted_data,
+                        block_size,
+                        *ws)) {
+                    return;
+                }
+                for (unsigned i = 0; i < this->n_data; i++) {
+                    if (wanted_data[i] && repaired[i] != data[t][i]) {
+                        return;
+                    }
+                }
+            }
+            success[t] = true;
+        };
+
+        std::vector<std::thread> threads;
+        for (unsigned t = 0; t < nb_threads; t++) {
+            threads.emplace_back(run, t);
+        }
+        for (auto& thread : threads) {
+            thread.join();
+        }
+        for (unsigned t = 0; t < nb_threads; t++) {
+            ASSERT_TRUE(success[t]);
+        }
+    }
+}
+
+TYPED_TEST(FecTestFnt, TestContextCache) // NOLINT
+{
+    const size_t word_size = sizeof(TypeParam) / 2;
+    const size_t pkt_size = 64;
+    const size_t block_size = 1002;
+    std::mt19937 prng(this->n_data);
+    std::uniform_int_distribution<int> dis(0, 255);
+
+    fec::RsFnt<TypeParam> fec(
+        fec::FecType::SYSTEMATIC,
+        word_size,
+        this->n_data,
+        this->n_parities,
+        pkt_size);
+    fec::ContextCache<TypeParam>& cache = fec.get_context_cache();
+    cache.set_capacity(2);
+
+    std::vector<std::vector<uint8_t>> data(
+        this->n_data, std::vector<uint8_t>(block_size));
+    std::vector<uint8_t*> data_bufs(this->n_data);
+    for (unsigned i = 0; i < this->n_data; i++) {
+        for (auto& byte : data[i]) {
+            byte = static_cast<uint8_t>(dis(prng));
+        }
+        data_bufs[i] = data[i].data();
+    }
+    std::vector<std::vector<uint8_t>> parities(
+        this->n_parities, std::vector<uint8_t>(block_size));
+    std::vector<uint8_t*> parities_bufs(this->n_parities);
+    for (unsigned i = 0; i < this->n_parities; i++) {
+        parities_bufs[i] = parities[i].data();
+    }
+    std::vector<quadiron::Properties> props(this->n_parities);
+    std::vector<bool> wanted_parities(this->n_parities, true);
+    fec.encode_blocks_vertical(
+        data_bufs, parities_bufs, props, wanted_parities, block_size);
+
+    std::unique_ptr<fec::Workspace<TypeParam>> ws = fec.make_workspace();
+    // decode after losing a data fragment and a parity fragment
+    auto decode = [&](unsigned lost_data, unsigned lost_parity) {
+        std::vector<uint8_t> repaired(block_size);
+        std::vector<uint8_t*> avail_data_bufs(data_bufs);
+        std::vector<uint8_t*> avail_parities_bufs(parities_bufs);
+        std::vector<int> missing_idxs(this->n_data + this->n_parities, 0);
+        std::vector<bool> wanted_data(this->n_data, false);
+        avail_data_bufs[lost_data] = repaired.data();
+        avail_parities_bufs[lost_parity] = nullptr;
+        missing_idxs[lost_data] = 1;
+        missing_idxs[this->n_data + lost_parity] = 1;
+        wanted_data[lost_data] = true;
+
+        ASSERT_TRUE(fec.decode_blocks_vertical(
+            avail_data_bufs,
+            avail_parities_bufs,
+            props,
+            missing_idxs,
+            wanted_data,
+            block_size,
+            *ws));
+        ASSERT_EQ(repaired, data[lost_data]);
+    };
+
+    decode(0, 0);
+    decode(0, 0);
+    ASSERT_EQ(cache.get_hits(), 1u);
+    ASSERT_EQ(cache.get_misses(), 1u);
+
+    // the first pattern is evicted by the third one
+    decode(1, 0);
+    decode(1, 1);
+    ASSERT_EQ(cache.size(), 2u);
+    decode(0, 0);
+    ASSERT_EQ(cache.get_hits(), 1u);
+    ASSERT_EQ(cache.get_misses(), 4u);
+
+    // the most recently used patterns are kept
+    decode(1, 1);
+    decode(0, 0);
+    ASSERT_EQ(cache.get_hits(), 3u);
+    ASSERT_EQ(cache.get_misses(), 4u);
+
+    cache.set_capacity(0);
+    ASSERT_EQ(cache.size(), 0u);
+}
+
+TYPED_TEST(FecTestFnt, TestRepairBlocks) // NOLINT
+{
+    const size_t word_size = sizeof(TypeParam) / 2;
+    const size_t pkt_size = 64;
+    const size_t block_size = 1002;
+    std::mt19937 prng(this->n_data);
+    std::uniform_int_distribution<int> dis(0, 255);
+
+    for (auto type : {fec::FecType::SYSTEMATIC, fec::FecType::NON_SYSTEMATIC}) {
+        fec::RsFnt<TypeParam> fec(
+            type, word_size, this->n_data, this->n_parities, pkt_size);
+        const bool systematic = type == fec::FecType::SYSTEMATIC;
+        const unsigned n_data = this->n_data;
+        const unsigned n_outputs = fec.n_outputs;
+        const unsigned code_len = fec.code_len;
+
+        std::vector<std::vector<uint8_t>> data(
+            n_data, std::vector<uint8_t>(block_size));
+        std::vector<uint8_t*> data_bufs(n_data);
+        for (unsigned i = 0; i < n_data; i++) {
+            for (auto& byte : data[i]) {
+                byte = static_cast<uint8_t>(dis(prng));
+            }
+            data_bufs[i] = data[i].data();
+        }
+        std::vector<std::vector<uint8_t>> parities(
+            n_outputs, std::vector<uint8_t>(block_size));
+        std::vector<uint8_t*> parities_bufs(n_outputs);
+        for (unsigned i = 0; i < n_outputs; i++) {
+            parities_bufs[i] = parities[i].data();
+        }
+        std::vector<quadiron::Properties> props(n_outputs);
+        std::vector<bool> wanted_idxs(n_outputs, true);
+        fec.encode_blocks_vertical(
+            data_bufs, parities_bufs, props, wanted_idxs, block_size);
+
+        std::unique_ptr<fec::Workspace<TypeParam>> ws = fec.make_workspace();
+        // repair each fragment after losing it and the next one
+        for (unsigned dest = 0; dest < code_len; ++dest) {
+            const unsigned lost = (dest + 1) % code_len;
+            std::vector<int> missing_idxs(code_len, 0);
+            missing_idxs[dest] = 1;
+            missing_idxs[lost] = 1;
+
+            std::vector<uint8_t> repaired(block_size);
+            std::vector<uint8_t*> avail_data_bufs(data_bufs);
+            std::vector<uint8_t*> avail_parities_bufs(parities_bufs);
+            std::vector<quadiron::Properties> avail_props(props);
+            const std::vector<uint8_t>* expected;
+            const quadiron::Properties* expected_props = nullptr;
+            if (systematic && dest < n_data) {
+                avail_data_bufs[dest] = repaired.data();
+                expected = &data[dest];
+            } else {
+                const unsigned i = systematic ? dest - n_data : dest;
+                avail_parities_bufs[i] = repaired.data();
+                avail_props[i].clear();
+                expected = &parities[i];
+                expected_props = &props[i];
+            }
+            if (systematic && lost < n_data) {
+                avail_data_bufs[lost] = nullptr;
+            } else {
+                avail_parities_bufs[systematic ? lost - n_data : lost] =
+                    nullptr;
+            }
+
+            ASSERT_TRUE(fec.repair_blocks_vertical(
+                avail_data_bufs,
+                avail_parities_bufs,
+                avail_props,
+                missing_idxs,
+                dest,
+                block_size,
+                *ws));
+            ASSERT_EQ(repaired, *expected);
+            if (expected_props != nullptr) {
+                const unsigned i = systematic ? dest - n_data : dest;
+                ASSERT_EQ(avail_props[i].get_map(), expected_props->get_map());
+            }
+        }
+    }
+}
+
+TYPED_TEST(FecTestFnt, TestDecodeContextPoly) // NOLINT
+{
+    const size_t word_size = sizeof(TypeParam) / 2;
+    const unsigned n_data = 100;
+    std::mt19937 prng(n_data);
+
+    // few missing fragments use the complement form, many use the subproduct
+    // tree
+    for (unsigned n_parities : {28, 100}) {
+        fec::RsFnt<TypeParam> fec(
+            fec::FecType::NON_SYSTEMATIC, word_size, n_data, n_parities);
+        const quadiron::gf::Field<TypeParam>& gf = fec.get_gf();
+        const TypeParam r = gf.get_nth_root(fec.n);
+
+        std::vector<TypeParam> ids(n_data + n_parities);
+        std::iota(ids.begin(), ids.end(), 0);
+        std::shuffle(ids.begin(), ids.end(), prng);
+        std::sort(ids.begin(), ids.begin() + n_data);
+        vec::Vector<TypeParam> fragments_ids(gf, n_data);
+        for (unsigned i = 0; i < n_data; ++i) {
+            fragments_ids.set(i, ids[i]);
+        }
+
+        std::vector<quadiron::Properties> props(n_data);
+        std::unique_ptr<fec::DecodeContext<TypeParam>> context =
+            fec.init_context_dec(fragments_ids, props);
+        const vec::Poly<TypeParam>& A = context->get_poly(fec::CtxPoly::A);
+
+        vec::Poly<TypeParam> expected(gf, fec.n);
+        expected.zero_fill();
+        expected.set(0, 1);
+        for (unsigned i = 0; i < n_data; ++i) {
+            expected.mul_to_x_plus_coef(
+                gf.sub(0, gf.exp(r, fragments_ids.get(i))));
+        }
+
+        ASSERT_EQ(A.get_deg(), static_cast<int>(n_data));
+        for (unsigned i = 0; i < fec.n; ++i) {
+            ASSERT_EQ(A.get(i), expected.get(i));
+        }
+    }
+}
+
 template <typename T>
 class FecTestNo128 : public FecTestCommon<T> {
 };
@@ -164,7 +785,18 @@ TYPED_TEST_CASE(FecTestNo128, No128);
 
 TYPED_TEST(FecTestNo128, TestGfpFft) // NOLINT
 {
-    const size_t word_size = sizeof(TypeParam) / 2;
-    fec::RsGfpFft<TypeParam> fec(word_size, this->n_data, this->n_parities);
-    this->run_test(fec, true);
+    // smaller words compute modulo a prime other than the one of the lanes
+    for (size_t ws = 1; ws <= sizeof(TypeParam) / 2; ws *= 2) {
+        fec::RsGfpFft<TypeParam> fec(ws, this->n_data, this->n_parities);
+        this->run_test(fec, true);
+        this->run_test_blocks(fec, ws);
+    }
+}
+
+TYPED_TEST(FecTestNo128, TestGfpFftThreads) // NOLINT
+{
+    for (size_t ws = 1; ws <= sizeof(TypeParam) / 2; ws *= 2) {
+        fec::RsGfpFft<TypeParam> fec(ws, 5, 4);
+        this->run_test_blocks_threads(fec, 20001 * ws);
+    }
 }
@@ -27,18 +27,26 @@
  * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
  * POSSIBILITY OF SUCH DAMAGE.
  */
+#include <algorithm>
+#include <sstream>
+#include <vector>
+
 #include <gtest/gtest.h>
 
+#include "exceptions.h"
 #include "fft_2n.h"
 #include "fft_add.h"
 #include "fft_ct.h"
 #include "fft_gt.h"
 #include "fft_large.h"
 #include "fft_naive.h"
+#include "fft_planner.h"
+#include "fft_rader.h"
 #include "fft_single.h"
 #include "gf_bin_ext.h"
 #include "gf_prime.h"
 #include "misc.h"
+#include "property.h"
 #include "vec_poly.h"
 
 namespace fft = quadiron::fft;
@@ -158,6 +166,43 @@ class FftTest : public ::testing::Test {
         }
     }
 
+    /** Check Buffers transforms against the ones of vectors
+     *
+     * Each column of the buffers is transformed as a vector.
+     */
+    void test_fft_bufs(
+        const gf::Field<T>& gf,
+        fft::FourierTransform<T>* fft,
+        int n_data,
+        size_t size)
+    {
+        const int n = fft->get_n();
+        vec::Buffers<T> input(n_data, size);
+        for (int i = 0; i < n_data; i++) {
+            T* mem = input.get(i);
+            for (size_t u = 0; u < size; u++) {
+                mem[u] = gf.rand();
+            }
+        }
+        vec::Buffers<T> output(n, size);
+        vec::Buffers<T> inv(n, size);
+        fft->fft(output, input);
+        fft->ifft(inv, output);
+
+        vec::Vector<T> v(gf, n);
+        vec::Vector<T> _v(gf, n);
+        for (size_t u = 0; u < size; u++) {
+            for (int i = 0; i < n; i++) {
+                v.set(i, (i < n_data) ? input.get(i)[u] : 0);
+            }
+            fft->fft(_v, v);
+            for (int i = 0; i < n; i++) {
+                ASSERT_EQ(output.get(i)[u], _v.get(i));
+                ASSERT_EQ(inv.get(i)[u], v.get(i));
+            }
+        }
+    }
+
     /** Convert a number into a vector of digits padded with zeros
      *
      * @param vec destination vector
@@ -331,6 +376,24 @@ TYPED_TEST(FftTest, TestFft2kVec) // NOLINT
     }
 }
 
+// butterfly operations of vectors that are not plain vectors are performed
+// on a copy of their elements
+TYPED_TEST(FftTest, TestFft2kVecSlice) // NOLINT
+{
+    auto gf(gf::create<gf::Prime<TypeParam>>(this->q));
+    const unsigned n = gf.get_code_len(this->code_lengths.back());
+    fft::Radix2<TypeParam> fft(gf, n);
+
+    vec::Vector<TypeParam> v(this->random_vec(gf, n, n));
+    vec::Vector<TypeParam> expected(gf, n);
+    vec::Vector<TypeParam> base(gf, n + 3);
+    vec::Slice<TypeParam> output(&base, n, 3);
+
+    fft.fft(expected, v);
+    fft.fft(output, v);
+    ASSERT_EQ(output, expected);
+}
+
 TYPED_TEST(FftTest, TestFft2kVecp) // NOLINT
 {
     auto gf(gf::create<gf::Prime<TypeParam>>(this->q));
@@ -420,6 +483,305 @@ TYPED_TEST(FftTest, TestNaiveVsFft2kVecp) // NOLINT
     }
 }
 
+TYPED_TEST(FftTest, TestFft2kTruncated) // NOLINT
+{
+    auto gf(gf::create<gf::Prime<TypeParam>>(this->q));
+    const unsigned n = 64;
+    const size_t size = 40;
+
+    for (unsigned data_len = 2; data_len <= n; data_len *= 2) {
+        fft::Radix2<TypeParam> fft_full(gf, n, data_len, size);
+        for (unsigned out_len : {1u, 5u, 17u, 32u, 33u, 50u, 63u, 64u}) {
+            fft::Radix2<TypeParam> fft(gf, n, data_len, size, out_len);
+
+            // vectors
+            vec::Vector<TypeParam> v(this->random_vec(gf, data_len, data_len));
+            vec::Vector<TypeParam> fft1(gf, n);
+            vec::Vector<TypeParam> fft2(gf, n);
+            fft_full.fft(fft1, v);
+            fft.fft(fft2, v);
+            for (unsigned i = 0; i < out_len; ++i) {
+                ASSERT_EQ(fft1.get(i), fft2.get(i));
+            }
+
+            vec::Vector<TypeParam> ifft1(gf, n);
+            vec::Vector<TypeParam> ifft2(gf, n);
+            fft_full.ifft(ifft1, fft1);
+            fft.ifft(ifft2, fft1);
+            for (unsigned i = 0; i < data_len; ++i) {
+                ASSERT_EQ(ifft1.get(i), ifft2.get(i));
+            }
+
+            // buffers
+            vec::Buffers<TypeParam> bufs(data_len, size);
+            for (unsigned i = 0; i < data_len; ++i) {
+                TypeParam* mem = bufs.get(i);
+                for (size_t u = 0; u < size; u++) {
+                    mem[u] = gf.rand();
+                }
+            }
+            vec::Buffers<TypeParam> bufs_fft1(n, size);
+            vec::Buffers<TypeParam> bufs_fft2(n, size);
+            fft_full.fft(bufs_fft1, bufs);
+            fft.fft(bufs_fft2, bufs);
+            for (unsigned i = 0; i < out_len; ++i) {
+                ASSERT_TRUE(std::equal(
+                    bufs_fft1.get(i), bufs_fft1.get(i) + size, bufs_fft2.get(i)));
+            }
+
+            // inverse of a vector having zeros beyond the `out_len` first
+            // elements
+            vec::Buffers<TypeParam> bufs_in(bufs_fft1, 0, out_len);
+            vec::Buffers<TypeParam> bufs_ifft1(n, size);
+            vec::Buffers<TypeParam> bufs_ifft2(n, size);
+            fft_full.fft_inv(bufs_ifft1, bufs_in);
+            fft.fft_inv(bufs_ifft2, bufs_in);
+            for (unsigned i = 0; i < data_len; ++i) {
+                ASSERT_TRUE(std::equal(
+                    bufs_ifft1.get(i),
+                    bufs_ifft1.get(i) + size,
+                    bufs_ifft2.get(i)));
+            }
+        }
+    }
+}
+
+TYPED_TEST(FftTest, TestFft2kPruned) // NOLINT
+{
+    auto gf(gf::create<gf::Prime<TypeParam>>(this->q));
+    const unsigned n = 64;
+    const size_t size = 40;
+
+    for (unsigned data_len = 2; data_len <= n; data_len *= 2) {
+        fft::Radix2<TypeParam> fft(gf, n, data_len, size);
+        // truncated inverse transform
+        fft::Radix2<TypeParam> fft_trunc(gf, n, data_len, size, n);
+
+        vec::Buffers<TypeParam> bufs(data_len, size);
+        for (unsigned i = 0; i < data_len; ++i) {
+            TypeParam* mem = bufs.get(i);
+            for (size_t u = 0; u < size; u++) {
+                mem[u] = gf.rand();
+            }
+        }
+        vec::Buffers<TypeParam> bufs_fft1(n, size);
+        fft.fft(bufs_fft1, bufs);
+
+        // a single output, a range of outputs, and random ones
+        std::vector<std::vector<bool>> wanted_sets;
+        for (unsigned o : {0u, 1u, 17u, 63u}) {
+            std::vector<bool> wanted(n, false);
+            wanted[o] = true;
+            wanted_sets.push_back(wanted);
+        }
+        std::vector<bool> range(n, false);
+        std::fill(range.begin() + 20, range.begin() + 50, true);
+        wanted_sets.push_back(range);
+        for (unsigned modulo : {2u, 8u}) {
+            std::vector<bool> wanted(n);
+            for (unsigned i = 0; i < n; ++i) {
+                wanted[i] = gf.rand() % modulo == 0;
+            }
+            wanted_sets.push_back(wanted);
+        }
+
+        for (const std::vector<bool>& wanted : wanted_sets) {
+            std::vector<bool> pruning(2 * n, false);
+            std::copy(wanted.begin(), wanted.end(), pruning.begin() + n);
+            fft.init_pruning(pruning);
+
+            vec::Buffers<TypeParam> bufs_fft2(n, size);
+            fft.fft_pruned(bufs_fft2, bufs, pruning);
+            for (unsigned i = 0; i < n; ++i) {
+                if (wanted[i]) {
+                    ASSERT_TRUE(std::equal(
+                        bufs_fft1.get(i),
+                        bufs_fft1.get(i) + size,
+                        bufs_fft2.get(i)));
+                }
+            }
+        }
+
+        // inverse of sparse vectors
+        for (unsigned modulo : {1u, 2u, 4u, 16u, n}) {
+            std::vector<bool> nonzero(n);
+            vec::Buffers<TypeParam> bufs_in(n, size);
+            for (unsigned i = 0; i < n; ++i) {
+                nonzero[i] = gf.rand() % modulo == 0;
+                if (!nonzero[i]) {
+                    std::fill_n(bufs_in.get(i), size, 0);
+                } else {
+                    std::copy_n(bufs_fft1.get(i), size, bufs_in.get(i));
+                }
+            }
+            for (auto* f : {&fft, &fft_trunc}) {
+                const unsigned out_len = (f == &fft) ? n : data_len;
+                std::vector<bool> mask(nonzero);
+                vec::Buffers<TypeParam> bufs_ifft1(n, size);
+                vec::Buffers<TypeParam> bufs_ifft2(n, size);
+                fft.fft_inv(bufs_ifft1, bufs_in);
+                f->fft_inv_sparse(bufs_ifft2, bufs_in, mask);
+                for (unsigned i = 0; i < out_len; ++i) {
+                    ASSERT_TRUE(std::equal(
+                        bufs_ifft1.get(i),
+                        bufs_ifft1.get(i) + size,
+                        bufs_ifft2.get(i)));
+                }
+            }
+        }
+    }
+}
+
+TYPED_TEST(FftTest, TestFft2kInvScaled) // NOLINT
+{
+    auto gf(gf::create<gf::Prime<TypeParam>>(this->q));
+    const unsigned n = 64;
+    const size_t size = 40;
+
+    for (unsigned data_len : {5u, 32u, n}) {
+        fft::Radix2<TypeParam> fft(gf, n, n, size);
+
+        vec::Buffers<TypeParam> bufs(data_len, size);
+        vec::Vector<TypeParam> coefs(gf, data_len);
+        for (unsigned i = 0; i < data_len; ++i) {
+            TypeParam* mem = bufs.get(i);
+            for (size_t u = 0; u < size; u++) {
+                mem[u] = gf.rand();
+            }
+            // include the coefficients handled apart, i.e. 0, 1 and -1
+            coefs.set(i, (i < 3) ? gf.sub(i, 1) : gf.rand());
+        }
+        vec::Buffers<TypeParam> bufs_ifft1(n, size);
+        vec::Buffers<TypeParam> bufs_ifft2(n, size);
+        fft.fft_inv_scaled(bufs_ifft1, bufs, coefs);
+
+        vec::Buffers<TypeParam> bufs_scaled(data_len, size);
+        gf.mul_vec_to_vecp(coefs, bufs, bufs_scaled);
+        fft.fft_inv(bufs_ifft2, bufs_scaled);
+        ASSERT_EQ(bufs_ifft1, bufs_ifft2);
+    }
+}
+
+TYPED_TEST(FftTest, TestFft2kTiled) // NOLINT
+{
+    auto gf(gf::create<gf::Prime<TypeParam>>(this->q));
+    const unsigned n = 64;
+    // two tiles and a shorter one
+    const size_t tile_len = 256;
+    const size_t size = 2 * tile_len + 24;
+    const TypeParam max = this->q - 1;
+
+    for (unsigned data_len : {2u, 16u, n}) {
+        fft::Radix2<TypeParam> fft(gf, n, data_len, size, 0, tile_len);
+
+        vec::Buffers<TypeParam> bufs(data_len, size);
+        for (unsigned i = 0; i < data_len; ++i) {
+            TypeParam* mem = bufs.get(i);
+            for (size_t u = 0; u < size; u++) {
+                mem[u] = gf.rand();
+            }
+        }
+        // all outputs of the columns around the end of the first tile are
+        // out of range
+        for (unsigned i = 0; i < data_len; ++i) {
+            std::fill_n(bufs.get(i) + tile_len - 8, 16, i == 0 ? max : 0);
+        }
+
+        quadiron::OorMarks marks(0, n, size, sizeof(TypeParam));
+        vec::Buffers<TypeParam> bufs_fft(n, size);
+        fft.fft_marked(bufs_fft, bufs, &marks);
+
+        std::vector<bool> pruning(2 * n, false);
+        pruning[n + 5] = true;
+        fft.init_pruning(pruning);
+        vec::Buffers<TypeParam> bufs_pruned(n, size);
+        fft.fft_pruned(bufs_pruned, bufs, pruning);
+
+        vec::Vector<TypeParam> v(gf, data_len);
+        vec::Vector<TypeParam> v_fft(gf, n);
+        for (size_t u = 0; u < size; ++u) {
+            for (unsigned i = 0; i < data_len; ++i) {
+                v.set(i, bufs.get(i)[u]);
+            }
+            fft.fft(v_fft, v);
+            for (unsigned i = 0; i < n; ++i) {
+                ASSERT_EQ(bufs_fft.get(i)[u], v_fft.get(i));
+                ASSERT_EQ(
+                    marks.is_marked(marks.get(i), u), v_fft.get(i) == max);
+            }
+            ASSERT_EQ(bufs_pruned.get(5)[u], v_fft.get(5));
+        }
+    }
+}
+
+TYPED_TEST(FftTest, TestFft2kNarrow) // NOLINT
+{
+    auto gf(gf::create<gf::Prime<TypeParam>>(this->q));
+    const unsigned n = 64;
+    const size_t size = 40;
+    const TypeParam max = this->q - 1;
+
+    for (unsigned data_len = 2; data_len <= n; data_len *= 2) {
+        fft::Radix2<TypeParam> fft(gf, n, data_len, size);
+
+        // inputs equal to `max` are frequent in even buffers, to compute
+        // registers with and without marked symbols
+        vec::Buffers<TypeParam> bufs(data_len, size);
+        vec::Buffers<uint16_t> bufs_narrow(data_len, size);
+        quadiron::OorMarks input_marks(0, data_len, size, sizeof(uint16_t));
+        for (unsigned i = 0; i < data_len; ++i) {
+            for (size_t u = 0; u < size; u++) {
+                const bool oor = i % 2 == 0 && gf.rand() % 4 == 0;
+                const TypeParam val = oor ? max : gf.rand();
+                bufs.get(i)[u] = val;
+                bufs_narrow.get(i)[u] = static_cast<uint16_t>(val);
+                input_marks.set_marked(input_marks.get(i), u, val == max);
+            }
+        }
+        vec::Buffers<TypeParam> bufs_fft1(n, size);
+        fft.fft(bufs_fft1, bufs);
+
+        const auto check = [&](fft::Radix2<TypeParam>& f,
+                               const std::vector<bool>& wanted,
+                               const std::vector<bool>& pruning) {
+            vec::Buffers<uint16_t> bufs_fft2(n, size);
+            quadiron::OorMarks marks(0, n, size, sizeof(uint16_t));
+            f.fft_narrow(bufs_fft2, bufs_narrow, pruning, marks, &input_marks);
+            for (unsigned i = 0; i < n; ++i) {
+                if (!wanted[i]) {
+                    continue;
+                }
+                for (size_t u = 0; u < size; u++) {
+                    const TypeParam val = marks.is_marked(marks.get(i), u)
+                                              ? max
+                                              : bufs_fft2.get(i)[u];
+                    ASSERT_EQ(bufs_fft1.get(i)[u], val);
+                }
+            }
+        };
+
+        // truncated transforms
+        for (unsigned out_len : {n, n / 2 + 3, 1u}) {
+            fft::Radix2<TypeParam> fft_trunc(gf, n, data_len, size, out_len);
+            std::vector<bool> wanted(n, false);
+            std::fill_n(wanted.begin(), out_len, true);
+            check(fft_trunc, wanted, std::vector<bool>());
+        }
+
+        // pruned transforms
+        for (unsigned modulo : {2u, 8u}) {
+            std::vector<bool> wanted(n);
+            for (unsigned i = 0; i < n; ++i) {
+                wanted[i] = gf.rand() % modulo == 0;
+            }
+            std::vector<bool> pruning(2 * n, false);
+            std::copy(wanted.begin(), wanted.end(), pruning.begin() + n);
+            fft.init_pruning(pruning);
+            check(fft, wanted, pruning);
+        }
+    }
+}
+
 TYPED_TEST(FftTest, TestFftGt) // NOLINT
 {
     auto gf(gf::create<gf::BinExtension<TypeParam>>(16));
@@ -435,6 +797,19 @@ TYPED_TEST(FftTest, TestFftGt) // NOLINT
     }
 }
 
+TYPED_TEST(FftTest, TestFftGtBufs) // NOLINT
+{
+    auto gf(gf::create<gf::BinExtension<TypeParam>>(16));
+    const size_t size = 20;
+
+    for (auto const& code_len : this->code_lengths) {
+        const TypeParam n = gf.get_code_len(code_len);
+
+        fft::GoodThomas<TypeParam> fft(gf, n, 0, nullptr, 0, size);
+        this->test_fft_bufs(gf, &fft, code_len, size);
+    }
+}
+
 TYPED_TEST(FftTest, TestFftCtGfp) // NOLINT
 {
     auto gf(gf::create<gf::Prime<TypeParam>>(this->q));
@@ -473,6 +848,30 @@ TYPED_TEST(FftTest, TestFftCtGf2n) // NOLINT
     }
 }
 
+TYPED_TEST(FftTest, TestFftCtBufs) // NOLINT
+{
+    const size_t size = 20;
+
+    auto gfp(gf::create<gf::Prime<TypeParam>>(this->q));
+    for (unsigned code_len : {16u, 64u}) {
+        const TypeParam n = gfp.get_code_len(code_len);
+
+        fft::CooleyTukey<TypeParam> fft(gfp, n, 0, nullptr, 0, size);
+        for (unsigned n_data : {1u, code_len / 3, code_len}) {
+            this->test_fft_bufs(gfp, &fft, n_data, size);
+        }
+    }
+
+    // lengths of mixed factors, as 2^16 - 1 = 3 * 5 * 17 * 257
+    auto gf2n(gf::create<gf::BinExtension<TypeParam>>(16));
+    for (unsigned code_len : {15u, 51u, 255u}) {
+        const TypeParam n = gf2n.get_code_len(code_len);
+
+        fft::CooleyTukey<TypeParam> fft(gf2n, n, 0, nullptr, 0, size);
+        this->test_fft_bufs(gf2n, &fft, code_len, size);
+    }
+}
+
 TYPED_TEST(FftTest, TestFftAdd) // NOLINT
 {
     for (size_t gf_n = 4; gf_n <= 128 && gf_n <= 8 * sizeof(TypeParam);
@@ -497,6 +896,89 @@ TYPED_TEST(FftTest, TestFftAdd) // NOLINT
     }
 }
 
+TYPED_TEST(FftTest, TestFftAddBufs) // NOLINT
+{
+    const size_t size = 20;
+
+    for (size_t gf_n : {8, 16}) {
+        auto gf(gf::create<gf::BinExtension<TypeParam>>(gf_n));
+
+        for (auto const& code_len : this->code_lengths) {
+            const int n = arith::ceil2<TypeParam>(code_len);
+            const int m = arith::log2<TypeParam>(n);
+            fft::Additive<TypeParam> fft(gf, m, nullptr, size);
+
+            for (int n_data : {1, n / 2, n}) {
+                this->test_fft_bufs(gf, &fft, n_data, size);
+            }
+        }
+    }
+}
+
+TYPED_TEST(FftTest, TestFftRader) // NOLINT
+{
+    // p - 1 = 2^10 * 3 * 17 * 29
+    auto gf(gf::create<gf::Prime<TypeParam>>(1514497));
+    const size_t size = 20;
+
+    for (int n : {17, 29}) {
+        const TypeParam w = gf.get_nth_root(n);
+        fft::Rader<TypeParam> rader(gf, n, w, size);
+        fft::Naive<TypeParam> naive(gf, n, w);
+
+        this->test_fft_1vs1(gf, &rader, &naive, n);
+        // the prime is not a Fermat one, whatever the size of the symbols
+        this->test_fft_bufs(gf, &rader, n, size);
+    }
+
+    // outer DFTs of lengths 17 and 29 use Rader's algorithm
+    const TypeParam n = 17 * 29;
+    fft::CooleyTukey<TypeParam> fft_ct(gf, n);
+    fft::GoodThomas<TypeParam> fft_gt(gf, n);
+    fft::Naive<TypeParam> naive(gf, n, gf.get_nth_root(n));
+    this->test_fft_1vs1(gf, &fft_ct, &naive, n);
+    this->test_fft_1vs1(gf, &fft_gt, &naive, n);
+}
+
+TYPED_TEST(FftTest, TestFftPlanner) // NOLINT
+{
+    auto gf(gf::create<gf::BinExtension<TypeParam>>(16));
+    const size_t size = 20;
+    const std::vector<int> lengths = {15, 51, 255};
+    fft::Planner<TypeParam> planner(fft::PlannerMode::MEASURE);
+
+    for (int n : lengths) {
+        std::unique_ptr<fft::FourierTransform<TypeParam>> fft =
+            planner.plan(gf, n, size);
+        fft::Naive<TypeParam> naive(gf, n, gf.get_nth_root(n));
+
+        this->test_fft_1vs1(gf, fft.get(), &naive, n);
+        this->test_fft_bufs(gf, fft.get(), n, size);
+    }
+
+    // measured choices are reused through wisdom
+    std::stringstream wisdom;
+    planner.export_wisdom(wisdom);
+    fft::Planner<TypeParam> estimate;
+    estimate.import_wisdom(wisdom);
+    for (int n : lengths) {
+        ASSERT_EQ(estimate.choose(gf, n, size), planner.choose(gf, n, size));
+    }
+
+    // without wisdom, powers of 2 use Radix2 and other lengths CooleyTukey
+    auto gfp(gf::create<gf::Prime<TypeParam>>(this->q));
+    ASSERT_EQ(estimate.choose(gfp, 256, size), fft::Algorithm::RADIX2);
+    ASSERT_EQ(estimate.choose(gf, 257, size), fft::Algorithm::COOLEY_TUKEY);
+
+    std::istringstream malformed("4 65536 15 20 unknown\n");
+    ASSERT_THROW(estimate.import_wisdom(malformed), quadiron::InvalidArgument);
+
+    // a measure that cannot export the wisdom to its file is reported
+    planner.forget_wisdom();
+    planner.set_wisdom_path("/nonexistent/quadiron_wisdom");
+    ASSERT_THROW(planner.choose(gf, 15, size), quadiron::InvalidArgument);
+}
+
 TYPED_TEST(FftTest, TestFftNaive2) // NOLINT
 {
     auto gf(gf::create<gf::Prime<TypeParam>>(this->q));
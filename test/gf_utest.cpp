@@ -27,10 +27,13 @@
  * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
  * POSSIBILITY OF SUCH DAMAGE.
  */
+#include <algorithm>
+
 #include <gtest/gtest.h>
 
 #include "gf_bin_ext.h"
 #include "gf_nf4.h"
+#include "gf_prime.h"
 
 namespace gf = quadiron::gf;
 
@@ -216,3 +219,96 @@ TYPED_TEST(GfTestNo128, TestGf256) // NOLINT
     this->test_get_nth_root(gf);
     this->test_find_primitive_root(&gf);
 }
+
+template <typename T>
+class GfTestBufs : public ::testing::Test {
+  public:
+    // check buffer operations against element-wise ones, with a length that
+    // does not fill a whole number of registers
+    void test_buffer_ops(const gf::Field<T>& gf)
+    {
+        const size_t len = 1000 + 3;
+        quadiron::vec::Buffers<T> bufs(3, len);
+        T* src = bufs.get(0);
+        T* dest = bufs.get(1);
+        T* acc = bufs.get(2);
+
+        for (size_t i = 0; i < len; i++) {
+            src[i] = gf.rand();
+            acc[i] = gf.rand();
+        }
+        for (T a : {T(0), T(1), T(2), gf.rand(), gf.card_minus_one()}) {
+            test_mul_coef_add(gf, a, src, acc, dest, len);
+
+            gf.mul_coef_to_buf(a, src, dest, len);
+            for (size_t i = 0; i < len; i++) {
+                ASSERT_EQ(dest[i], gf.mul(a, src[i]));
+            }
+
+            gf.add_two_bufs(acc, dest, len);
+            for (size_t i = 0; i < len; i++) {
+                ASSERT_EQ(dest[i], gf.add(acc[i], gf.mul(a, src[i])));
+            }
+        }
+    }
+
+    // check dest = acc + a * src
+    void test_mul_coef_add(
+        const gf::Field<T>& gf,
+        T a,
+        T* src,
+        T* acc,
+        T* dest,
+        size_t len)
+    {
+        std::copy_n(acc, len, dest);
+        gf.mul_coef_add_to_buf(a, src, dest, len);
+        for (size_t i = 0; i < len; i++) {
+            ASSERT_EQ(dest[i], gf.add(acc[i], gf.mul(a, src[i])));
+        }
+    }
+};
+
+using BufTypes = ::testing::Types<uint16_t, uint32_t>;
+TYPED_TEST_CASE(GfTestBufs, BufTypes);
+
+TYPED_TEST(GfTestBufs, TestGf2nBufferOps) // NOLINT
+{
+    quadiron::prng().seed(time(0));
+
+    // skip the restricted case where elements fill the whole word
+    for (TypeParam n = 8; n <= 16 && n < 8 * sizeof(TypeParam); n *= 2) {
+        auto gf(gf::create<gf::BinExtension<TypeParam>>(n));
+        this->test_buffer_ops(gf);
+    }
+}
+
+TYPED_TEST(GfTestBufs, TestFntMulCoefAdd) // NOLINT
+{
+    quadiron::prng().seed(time(0));
+
+    // the Fermat prime whose elements fill half of the word
+    const TypeParam q = (1U << (4 * sizeof(TypeParam))) + 1;
+    const size_t len = 1000 + 3;
+    auto gf(gf::create<gf::Prime<TypeParam>>(q));
+
+    quadiron::vec::Buffers<TypeParam> bufs(3, len);
+    TypeParam* src = bufs.get(0);
+    TypeParam* dest = bufs.get(1);
+    TypeParam* acc = bufs.get(2);
+    for (size_t i = 0; i < len; i++) {
+        src[i] = gf.rand();
+        acc[i] = gf.rand();
+    }
+    // elements equal to q - 1 are allowed
+    src[0] = gf.card_minus_one();
+    acc[1] = gf.card_minus_one();
+    for (TypeParam a :
+         {TypeParam(0),
+          TypeParam(1),
+          TypeParam(2),
+          gf.rand(),
+          gf.card_minus_one()}) {
+        this->test_mul_coef_add(gf, a, src, acc, dest, len);
+    }
+}
@@ -27,11 +27,44 @@
  * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
  * POSSIBILITY OF SUCH DAMAGE.
  */
+#include <atomic>
+#include <cstdlib>
+#include <new>
 #include <random>
 #include <gtest/gtest.h>
 #include "quadiron.h"
 #include "quadiron_c.h"
 
+namespace {
+
+// allocations are counted only when enabled
+std::atomic<bool> count_allocs(false);
+std::atomic<size_t> nb_allocs(0);
+
+} // namespace
+
+void* operator new(size_t size)
+{
+    if (count_allocs) {
+        nb_allocs++;
+    }
+    void* ptr = std::malloc(size == 0 ? 1 : size);
+    if (ptr == nullptr) {
+        throw std::bad_alloc();
+    }
+    return ptr;
+}
+
+void operator delete(void* ptr) noexcept
+{
+    std::free(ptr);
+}
+
+void operator delete(void* ptr, size_t) noexcept
+{
+    std::free(ptr);
+}
+
 template <typename T>
 class QuadironCTest : public ::testing::Test {
   public:
@@ -280,6 +313,106 @@ class QuadironCTest : public ::testing::Test {
         quadiron_fnt32_delete(inst);
     }
 
+    /** Test that encode/decode/reconstruct do not allocate with a workspace
+     *
+     * A first round warms the workspace up, allocations are then counted
+     * while running the same round again.
+     *
+     * @param n_data number of data
+     * @param n_parities number of parities
+     * @param block_size size of block in bytes
+     * @param systematic 1 if systematic else 0
+     * @param missing_idxs vector of boolean vales indicating missing fragments
+     */
+    void test_workspace_no_alloc(
+        int n_data,
+        int n_parities,
+        size_t block_size,
+        int systematic,
+        std::vector<int> missing_idxs)
+    {
+        struct QuadironFnt32* inst =
+            quadiron_fnt32_new(2, n_data, n_parities, systematic);
+        struct QuadironFnt32Workspace* ws = quadiron_fnt32_workspace_new(inst);
+        size_t metadata_size =
+            quadiron_fnt32_get_metadata_size(inst, block_size);
+        const size_t full_block_size = block_size + metadata_size;
+        const int n_outputs = systematic ? n_parities : n_data + n_parities;
+        std::vector<std::vector<uint8_t>> data(n_data);
+        std::vector<uint8_t*> _data(n_data); // for C API
+        std::vector<std::vector<uint8_t>> ref_data(n_data);
+        std::vector<std::vector<uint8_t>> parity(n_parities);
+        std::vector<uint8_t*> _parity(n_parities); // for C API
+        std::vector<int> wanted_idxs(n_outputs, 1);
+
+        for (int i = 0; i < n_data; i++) {
+            data.at(i).resize(full_block_size);
+            _data[i] = data.at(i).data();
+            randomize_buffer(_data[i] + metadata_size, block_size);
+            ref_data.at(i).assign(
+                _data[i] + metadata_size, _data[i] + full_block_size);
+        }
+        for (int i = 0; i < n_parities; i++) {
+            parity.at(i).resize(full_block_size);
+            _parity[i] = parity.at(i).data();
+        }
+
+        for (int round = 0; round < 2; round++) {
+            nb_allocs = 0;
+            count_allocs = round > 0;
+
+            ASSERT_EQ(
+                quadiron_fnt32_encode_ws(
+                    inst,
+                    ws,
+                    _data.data(),
+                    _parity.data(),
+                    wanted_idxs.data(),
+                    block_size),
+                0);
+            for (int i = 0; i < n_parities; i++) {
+                if (missing_idxs[n_data + i]) {
+                    std::fill_n(_parity[i], full_block_size, 0);
+                }
+            }
+            ASSERT_EQ(
+                quadiron_fnt32_decode_ws(
+                    inst,
+                    ws,
+                    _data.data(),
+                    _parity.data(),
+                    missing_idxs.data(),
+                    block_size),
+                0);
+            for (int i = 0; i < n_parities; i++) {
+                if (missing_idxs[n_data + i]) {
+                    ASSERT_EQ(
+                        quadiron_fnt32_reconstruct_ws(
+                            inst,
+                            ws,
+                            _data.data(),
+                            _parity.data(),
+                            missing_idxs.data(),
+                            n_data + i,
+                            block_size),
+                        0);
+                }
+            }
+
+            count_allocs = false;
+            ASSERT_EQ(nb_allocs, 0u);
+            for (int i = 0; i < n_data; i++) {
+                ASSERT_TRUE(std::equal(
+                    ref_data[i].begin(),
+                    ref_data[i].end(),
+                    _data[i] + metadata_size));
+            }
+        }
+
+        quadiron_fnt32_workspace_delete(ws);
+        quadiron_fnt32_delete(inst);
+    }
+
     void test_all_decodable_scenarios(int k, int m, int systematic)
     {
         for (int i = 0; i <= m; i++) {
@@ -307,3 +440,13 @@ TYPED_TEST(QuadironCTest, TestBasicNSys) // NOLINT
 {
     this->test_all_decodable_scenarios(3, 3, 0);
 }
+
+TYPED_TEST(QuadironCTest, TestWorkspaceNoAllocSys) // NOLINT
+{
+    this->test_workspace_no_alloc(3, 3, 10000, 1, {0, 0, 0, 1, 0, 1});
+}
+
+TYPED_TEST(QuadironCTest, TestWorkspaceNoAllocNSys) // NOLINT
+{
+    this->test_workspace_no_alloc(3, 3, 10000, 0, {0, 0, 0, 1, 0, 1});
+}
@@ -27,10 +27,13 @@
  * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
  * POSSIBILITY OF SUCH DAMAGE.
  */
+#include <random>
+
 #include <gtest/gtest.h>
 
 #include "quadiron.h"
 
+namespace fec = quadiron::fec;
 namespace gf = quadiron::gf;
 namespace vec = quadiron::vec;
 
@@ -105,3 +108,107 @@ TEST(RsTest, TestGf256) // NOLINT
     ASSERT_EQ(gf256.div(13, 10), 40);
     ASSERT_EQ(gf256.div(3, 7), 211);
 }
+
+TEST(RsTest, TestMultiplicationBuffers) // NOLINT
+{
+    const int n_rows = 3;
+    const int n_cols = 4;
+    const size_t size = 37;
+    const auto gf256(gf::create<gf::BinExtension<uint32_t>>(8));
+    vec::Matrix<uint32_t> mat(gf256, n_rows, n_cols);
+    vec::Buffers<uint32_t> input(n_cols, size);
+    vec::Buffers<uint32_t> output(n_rows, size);
+    vec::Vector<uint32_t> column(gf256, n_cols);
+    vec::Vector<uint32_t> expected(gf256, n_rows);
+
+    mat.cauchy();
+    // exercise the zero and one coefficients too
+    mat.set(1, 0, 0);
+    mat.set(1, 2, 1);
+    mat.set(2, 1, 255);
+
+    for (int j = 0; j < n_cols; j++) {
+        for (size_t k = 0; k < size; k++) {
+            input.get(j)[k] = gf256.rand();
+        }
+    }
+
+    mat.mul(&output, &input);
+
+    for (size_t k = 0; k < size; k++) {
+        for (int j = 0; j < n_cols; j++) {
+            column.set(j, input.get(j)[k]);
+        }
+        mat.mul(&expected, &column);
+        for (int i = 0; i < n_rows; i++) {
+            ASSERT_EQ(output.get(i)[k], expected.get(i));
+        }
+    }
+}
+
+TEST(RsTest, TestEncodeDecodeBlocksVertical) // NOLINT
+{
+    const unsigned n_data = 5;
+    const unsigned n_parities = 3;
+    const size_t pkt_size = 64;
+    // not a multiple of the packet size to cover the trailing packet
+    const size_t block_size = 1000;
+    std::mt19937 prng(n_data);
+    std::uniform_int_distribution<int> dis(0, 255);
+
+    for (unsigned word_size : {1, 2}) {
+        for (auto type :
+             {fec::RsMatrixType::VANDERMONDE, fec::RsMatrixType::CAUCHY}) {
+            fec::RsGf2n<uint32_t> fec(
+                word_size, n_data, n_parities, type, pkt_size);
+
+            std::vector<std::vector<uint8_t>> data(
+                n_data, std::vector<uint8_t>(block_size));
+            std::vector<std::vector<uint8_t>> parities(
+                n_parities, std::vector<uint8_t>(block_size));
+            std::vector<uint8_t*> data_bufs(n_data);
+            std::vector<uint8_t*> parities_bufs(n_parities);
+            std::vector<quadiron::Properties> props(n_parities);
+            std::vector<bool> wanted_parities(n_parities, true);
+
+            for (unsigned i = 0; i < n_data; i++) {
+                for (auto& byte : data[i]) {
+                    byte = static_cast<uint8_t>(dis(prng));
+                }
+                data_bufs[i] = data[i].data();
+            }
+            for (unsigned i = 0; i < n_parities; i++) {
+                parities_bufs[i] = parities[i].data();
+            }
+
+            fec.encode_blocks_vertical(
+                data_bufs, parities_bufs, props, wanted_parities, block_size);
+
+            // lose as many data fragments as there are parities
+            std::vector<int> missing_idxs(n_data + n_parities, 0);
+            std::vector<bool> wanted_data(n_data, false);
+            std::vector<std::vector<uint8_t>> repaired(
+                n_data, std::vector<uint8_t>(block_size));
+            for (unsigned i = 0; i < n_parities; i++) {
+                const unsigned idx = 2 * i % n_data;
+                missing_idxs[idx] = 1;
+                wanted_data[idx] = true;
+                data_bufs[idx] = repaired[idx].data();
+            }
+
+            ASSERT_TRUE(fec.decode_blocks_vertical(
+                data_bufs,
+                parities_bufs,
+                props,
+                missing_idxs,
+                wanted_data,
+                block_size));
+
+            for (unsigned i = 0; i < n_data; i++) {
+                if (wanted_data[i]) {
+                    ASSERT_EQ(repaired[i], data[i]);
+                }
+            }
+        }
+    }
+}
@@ -37,16 +37,21 @@ TEST(SimdDefinitionsTest, TestConstants) // NOLINT
 {
     switch (simd::INSTRUCTION_SET) {
     case simd::InstructionSet::NONE:
-        ASSERT_EQ(simd::ALIGNMENT, 8);
         ASSERT_EQ(simd::REG_BITSZ, 64);
         break;
     case simd::InstructionSet::SSE:
-        ASSERT_EQ(simd::ALIGNMENT, 16);
+    case simd::InstructionSet::NEON:
         ASSERT_EQ(simd::REG_BITSZ, 128);
         break;
     case simd::InstructionSet::AVX:
-        ASSERT_EQ(simd::ALIGNMENT, 32);
         ASSERT_EQ(simd::REG_BITSZ, 256);
         break;
     }
+
+#ifdef QUADIRON_SIMD_DISPATCH
+    // Buffers suit every instruction set kernels can be dispatched to.
+    ASSERT_EQ(simd::ALIGNMENT, 32);
+#else
+    ASSERT_EQ(simd::ALIGNMENT, simd::REG_BITSZ / 8);
+#endif
 }
@@ -44,6 +44,7 @@ TEST(SimdTest, TestCountOf) // NOLINT
         expected = {1, 1, 1, 1};
         break;
     case simd::InstructionSet::SSE:
+    case simd::InstructionSet::NEON:
         expected = {16, 8, 4, 2};
         break;
     case simd::InstructionSet::AVX:
@@ -55,4 +56,10 @@ TEST(SimdTest, TestCountOf) // NOLINT
     ASSERT_EQ(simd::countof<uint16_t>(), expected[1]);
     ASSERT_EQ(simd::countof<uint32_t>(), expected[2]);
     ASSERT_EQ(simd::countof<uint64_t>(), expected[3]);
+
+    const simd::InstructionSet set = simd::INSTRUCTION_SET;
+    ASSERT_EQ(simd::countof<uint8_t>(set), expected[0]);
+    ASSERT_EQ(simd::countof<uint16_t>(set), expected[1]);
+    ASSERT_EQ(simd::countof<uint32_t>(set), expected[2]);
+    ASSERT_EQ(simd::countof<uint64_t>(set), expected[3]);
 }
@@ -41,6 +41,7 @@
 #include "simd.h"
 #include "simd/simd.h"
 #include "simd_fnt.h"
+#include "vec_buffers.h"
 
 namespace simd = quadiron::simd;
 
@@ -63,7 +64,7 @@ class SimdTestFnt : public ::testing::Test {
 
     simd::VecType rand_vec(T lower = 0, T upper_bound = 0)
     {
-        const size_t n = simd::countof<T>();
+        const size_t n = sizeof(simd::VecType) / sizeof(T);
         T buf[n];
         simd::VecType* vec = reinterpret_cast<simd::VecType*>(buf);
 
@@ -74,12 +75,12 @@ class SimdTestFnt : public ::testing::Test {
             buf[i] = rand(quadiron::prng());
         }
 
-        return vec[0];
+        return simd::load_to_reg(vec);
     }
 
     simd::VecType copy(simd::VecType x)
     {
-        const size_t n = simd::countof<T>();
+        const size_t n = sizeof(simd::VecType) / sizeof(T);
         T buf[n];
         T val[n];
         simd::VecType* vec = reinterpret_cast<simd::VecType*>(buf);
@@ -87,7 +88,7 @@ class SimdTestFnt : public ::testing::Test {
         simd::store_to_mem(reinterpret_cast<simd::VecType*>(val), x);
         std::copy_n(val, n, buf);
 
-        return vec[0];
+        return simd::load_to_reg(vec);
     }
 
     bool is_equal(simd::VecType x, simd::VecType y)
@@ -97,7 +98,7 @@ class SimdTestFnt : public ::testing::Test {
 
     simd::VecType mod_mul(simd::VecType x, simd::VecType y)
     {
-        const size_t n = simd::countof<T>();
+        const size_t n = sizeof(simd::VecType) / sizeof(T);
         T _x[n];
         T _y[n];
         T _z[n];
@@ -109,7 +110,7 @@ class SimdTestFnt : public ::testing::Test {
 
         simd::VecType* vec = reinterpret_cast<simd::VecType*>(_z);
 
-        return vec[0];
+        return simd::load_to_reg(vec);
     }
 
     /* Butterfly Cooley-Tukey operation
@@ -118,7 +119,7 @@ class SimdTestFnt : public ::testing::Test {
      */
     void butterfly_ct(simd::VecType c, simd::VecType& x, simd::VecType& y)
     {
-        const size_t n = simd::countof<T>();
+        const size_t n = sizeof(simd::VecType) / sizeof(T);
         T c_buf[n];
         T x_buf[n];
         T y_buf[n];
@@ -146,7 +147,7 @@ class SimdTestFnt : public ::testing::Test {
      */
     void butterfly_gs(simd::VecType c, simd::VecType& x, simd::VecType& y)
     {
-        const size_t n = simd::countof<T>();
+        const size_t n = sizeof(simd::VecType) / sizeof(T);
         T c_buf[n];
         T x_buf[n];
         T y_buf[n];
@@ -173,7 +174,7 @@ class SimdTestFnt : public ::testing::Test {
      */
     void butterfly_simple_gs(simd::VecType c, simd::VecType& x)
     {
-        const size_t n = simd::countof<T>();
+        const size_t n = sizeof(simd::VecType) / sizeof(T);
         T c_buf[n];
         T x_buf[n];
 
@@ -307,4 +308,138 @@ TYPED_TEST(SimdTestFnt, TestButterflyGs) // NOLINT
     }
 }
 
+TYPED_TEST(SimdTestFnt, TestLaneBounds) // NOLINT
+{
+    // products of extreme symbols must fit in lanes, see `mod_mul`
+    const TypeParam q = this->q;
+    const std::vector<TypeParam> values = {
+        0,
+        1,
+        static_cast<TypeParam>(q / 2),
+        static_cast<TypeParam>(q - 2),
+        static_cast<TypeParam>(q - 1)};
+
+    for (const TypeParam r : values) {
+        if (r == 0) {
+            continue;
+        }
+        const simd::CtGsCase ct_case = simd::get_case<TypeParam>(r, q);
+        simd::VecType c = simd::set_one(r);
+
+        for (const TypeParam a : values) {
+            for (const TypeParam b : values) {
+                simd::VecType x = simd::set_one(a);
+                simd::VecType y = simd::set_one(b);
+
+                if (r < q - 1) {
+                    ASSERT_TRUE(this->is_equal(
+                        this->mod_mul(c, y), simd::mod_mul<TypeParam>(c, y)));
+                }
+
+                simd::VecType x_expected = this->copy(x);
+                simd::VecType y_expected = this->copy(y);
+                this->butterfly_ct(c, x_expected, y_expected);
+                simd::butterfly_ct<TypeParam>(ct_case, c, x, y);
+                ASSERT_TRUE(this->is_equal(x_expected, x));
+                ASSERT_TRUE(this->is_equal(y_expected, y));
+
+                x = simd::set_one(a);
+                y = simd::set_one(b);
+                x_expected = this->copy(x);
+                y_expected = this->copy(y);
+                this->butterfly_gs(c, x_expected, y_expected);
+                simd::butterfly_gs<TypeParam>(ct_case, c, x, y);
+                ASSERT_TRUE(this->is_equal(x_expected, x));
+                ASSERT_TRUE(this->is_equal(y_expected, y));
+            }
+        }
+    }
+}
+
+TYPED_TEST(SimdTestFnt, TestButterflyLayers) // NOLINT
+{
+    const TypeParam q = this->q;
+    const size_t len = 3;
+    const size_t size = len * sizeof(simd::VecType) / sizeof(TypeParam);
+    const unsigned m = 2;
+
+    for (unsigned depth = 2; depth <= 4; ++depth) {
+        const unsigned nb_coefs = (1U << depth) - 1;
+        // two groups of buffers
+        const unsigned n = 2 * (m << depth);
+
+        // coefficients of the first group, of other ones, and arbitrary ones
+        std::vector<std::vector<TypeParam>> coefs_sets(3);
+        for (unsigned t = 0; t < nb_coefs; ++t) {
+            const TypeParam r = static_cast<TypeParam>(
+                2 + this->distribution->operator()(quadiron::prng()) % (q - 3));
+            coefs_sets[0].push_back(((t + 1) & t) == 0 ? 1 : r);
+            coefs_sets[1].push_back(r);
+            coefs_sets[2].push_back(t % 3 == 0 ? q - 1 : r);
+        }
+
+        for (const auto& coefs : coefs_sets) {
+            for (unsigned start = 0; start < m; ++start) {
+                quadiron::vec::Buffers<TypeParam> input(n, size);
+                for (unsigned i = 0; i < n; ++i) {
+                    for (size_t j = 0; j < size; ++j) {
+                        input.get(i)[j] = static_cast<TypeParam>(
+                            this->distribution->operator()(quadiron::prng()));
+                    }
+                }
+                quadiron::vec::Buffers<TypeParam> ct(n, size);
+                quadiron::vec::Buffers<TypeParam> ct_expected(n, size);
+                quadiron::vec::Buffers<TypeParam> gs(n, size);
+                quadiron::vec::Buffers<TypeParam> gs_expected(n, size);
+                ct.copy(input);
+                ct_expected.copy(input);
+                gs.copy(input);
+                gs_expected.copy(input);
+
+                simd::butterfly_ct_layers_step<TypeParam>(
+                    ct, coefs.data(), depth, start, m, len, q, nullptr);
+                simd::butterfly_gs_layers_step<TypeParam>(
+                    gs, coefs.data(), depth, start, m, len, q);
+
+                // one layer at a time
+                const unsigned step = m << depth;
+                for (unsigned h = 1; h < (1U << depth); h <<= 1) {
+                    for (unsigned k = 0; k < h; ++k) {
+                        for (unsigned i = start + k * m; i < start + step;
+                             i += 2 * h * m) {
+                            simd::butterfly_ct_step<TypeParam>(
+                                ct_expected,
+                                coefs[h - 1 + k],
+                                i,
+                                h * m,
+                                step,
+                                len,
+                                q,
+                                nullptr);
+                        }
+                    }
+                }
+                for (unsigned h = (1U << depth) / 2; h > 0; h >>= 1) {
+                    for (unsigned k = 0; k < h; ++k) {
+                        for (unsigned i = start + k * m; i < start + step;
+                             i += 2 * h * m) {
+                            simd::butterfly_gs_step<TypeParam>(
+                                gs_expected,
+                                coefs[h - 1 + k],
+                                i,
+                                h * m,
+                                step,
+                                len,
+                                q);
+                        }
+                    }
+                }
+
+                ASSERT_EQ(ct, ct_expected);
+                ASSERT_EQ(gs, gs_expected);
+            }
+        }
+    }
+}
+
 #endif